@@ -88,119 +88,97 @@ namespace quinte
                 info.Offset[channelIndex] += firstChannelIndex * m;
             }
         }
-    }
-
-
-    template<class TInFormat, class TOutFormat>
-    static bool ConvertImpl(TOutFormat* pOutBuffer, const TInFormat* pInBuffer, uint32_t bufferFrameCount,
-                            const BackendConversionInfo& info)
-    {
-        // why writing crazy generic code when you don't even need it???
-        // idk...
-
-        static_assert(std::is_signed_v<TInFormat> || std::is_same_v<TInFormat, Int24>);
-        static_assert(std::is_signed_v<TOutFormat> || std::is_same_v<TOutFormat, Int24>);
 
-        constexpr size_t kInFormatBits = sizeof(TInFormat) * 8;
-        constexpr size_t kOutFormatBits = sizeof(TOutFormat) * 8;
+        conversionInfo.pConvert = SelectBackendConverter(conversionInfo);
 
-        for (uint32_t frameIndex = 0; frameIndex < bufferFrameCount; ++frameIndex)
+        // Noise shaping is left for the offline export, the filters are tuned for 44.1 kHz.
+        const uint32_t ditherBitDepth = audio::GetDitherBitDepth(conversionInfo.In.Format, conversionInfo.Out.Format);
+        if (ditherBitDepth > 0)
         {
-            for (uint32_t channelIndex = 0; channelIndex < info.ChannelCount; ++channelIndex)
-            {
-                const TInFormat sourceValue = pInBuffer[info.In.Offset[channelIndex]];
-
-                TOutFormat result;
-                if constexpr (std::is_same_v<TInFormat, TOutFormat>)
-                {
-                    result = sourceValue;
-                }
-                else if constexpr (std::is_floating_point_v<TOutFormat>)
-                {
-                    if constexpr (std::is_floating_point_v<TInFormat>)
-                    {
-                        result = static_cast<TOutFormat>(sourceValue);
-                    }
-                    else
-                    {
-                        constexpr TOutFormat kMultiplier = static_cast<TOutFormat>(1.0 / (1 << (kInFormatBits - 1)));
-                        result = static_cast<TOutFormat>(sourceValue) * kMultiplier;
-                    }
-                }
-                else
-                {
-                    if constexpr (std::is_floating_point_v<TInFormat>)
-                    {
-                        constexpr TInFormat kMultiplier = static_cast<TInFormat>(1 << (kOutFormatBits - 1));
-                        result = static_cast<TOutFormat>(sourceValue * kMultiplier);
-                    }
-                    else if constexpr (kInFormatBits < kOutFormatBits)
-                    {
-                        result = static_cast<TOutFormat>(sourceValue);
-                        result <<= (kOutFormatBits - kInFormatBits);
-                    }
-                    else
-                    {
-                        result = static_cast<TOutFormat>(sourceValue >> (kInFormatBits - kOutFormatBits));
-                    }
-                }
+            conversionInfo.pDitherer = memory::make_unique<audio::Ditherer>();
+            conversionInfo.pDitherer->Initialize(conversionInfo.ChannelCount, ditherBitDepth, audio::NoiseShaping::None);
+        }
+    }
 
-                pOutBuffer[info.Out.Offset[channelIndex]] = result;
-            }
 
-            pInBuffer += info.In.Jump;
-            pOutBuffer += info.Out.Jump;
+    void AudioBackendBase::ConvertBuffer(uint8_t* pOutBuffer, const uint8_t* pInBuffer, const BackendConversionInfo& info)
+    {
+        if (pOutBuffer == m_StreamData.DeviceBuffer.get() && m_StreamData.Mode == BackendStreamMode::Duplex
+            && info.Out.Jump > info.In.Jump)
+        {
+            const size_t bytes =
+                static_cast<size_t>(m_StreamData.BufferFrameCount) * info.Out.Jump * audio::GetFormatByteSize(info.Out.Format);
+            memset(pOutBuffer, 0, bytes);
         }
 
-        return true;
+        info.pConvert(pOutBuffer, pInBuffer, m_StreamData.BufferFrameCount, info);
     }
 
 
-    template<class TInFormat, class TFormatIndex, TFormatIndex... TFormatIndices>
-    static bool ConvertInImpl(std::integer_sequence<TFormatIndex, TFormatIndices...>, uint8_t* pOutBuffer,
-                              const TInFormat* pInBuffer, uint32_t bufferFrameCount, const BackendConversionInfo& info)
+    void AudioBackendBase::InitializeVirtualDevice(StringSlice name)
     {
-        return ((info.Out.Format == static_cast<audio::Format>(1 << TFormatIndices)
-                 && ConvertImpl(reinterpret_cast<audio::FormatType<static_cast<audio::Format>(1 << TFormatIndices)>*>(pOutBuffer),
-                                pInBuffer,
-                                bufferFrameCount,
-                                info)),
-                ...);
+        m_Devices.clear();
+
+        // The device list is rebuilt from scratch, so the only device is always at index zero.
+        audio::DeviceDesc& desc = m_Devices.emplace_back();
+        desc.ID = audio::DeviceID{ 0 };
+        desc.Name = name;
+        desc.OutputChannelCount = kVirtualDeviceChannelCount;
+        desc.InputChannelCount = kVirtualDeviceChannelCount;
+        desc.CurrentSampleRate = 48000;
+        desc.PreferredSampleRate = 48000;
+        desc.Formats = audio::Format::Float32;
+        desc.SampleRates = audio::SampleRate::Value_44100 | audio::SampleRate::Value_48000;
     }
 
 
-    template<class TFormatIndex, TFormatIndex... TFormatIndices>
-    static bool ConvertBufferImpl(std::integer_sequence<TFormatIndex, TFormatIndices...> sequence, uint8_t* pOutBuffer,
-                                  const uint8_t* pInBuffer, uint32_t bufferFrameCount, const BackendConversionInfo& info)
+    audio::ResultCode AudioBackendBase::OpenVirtualStream(const BackendStreamOpenInfo& openInfo, uint32_t& bufferFrameCount)
     {
-        return ((info.In.Format == static_cast<audio::Format>(1 << TFormatIndices)
-                 && ConvertInImpl(
-                     sequence,
-                     pOutBuffer,
-                     reinterpret_cast<const audio::FormatType<static_cast<audio::Format>(1 << TFormatIndices)>*>(pInBuffer),
-                     bufferFrameCount,
-                     info)),
-                ...);
-    }
+        const std::unique_lock lock{ m_StreamData.Mutex };
 
+        if (openInfo.DeviceID.Value >= m_Devices.size())
+            return audio::ResultCode::FailDeviceNotFound;
 
-    void AudioBackendBase::ConvertBuffer(uint8_t* pOutBuffer, const uint8_t* pInBuffer, const BackendConversionInfo& info)
-    {
-        if (pOutBuffer == m_StreamData.DeviceBuffer.get() && m_StreamData.Mode == BackendStreamMode::Duplex
-            && info.Out.Jump > info.In.Jump)
+        if (openInfo.Format != audio::Format::Float32)
+            return audio::ResultCode::FailDeviceModeNotSupported;
+
+        if (m_StreamData.Mode == BackendStreamMode::None)
         {
-            const size_t bytes =
-                static_cast<size_t>(m_StreamData.BufferFrameCount) * info.Out.Jump * audio::GetFormatByteSize(info.Out.Format);
-            memset(pOutBuffer, 0, bytes);
+            m_StreamData.Mode = openInfo.Mode;
+        }
+        else
+        {
+            if (m_StreamData.Mode == openInfo.Mode)
+                return audio::ResultCode::FailDeviceModeNotSupported;
+
+            m_StreamData.Mode = BackendStreamMode::Duplex;
         }
 
-        constexpr uint32_t kMaxFormatFlagBit = std::countr_zero(enum_cast(audio::Format::Max));
+        if (bufferFrameCount == 0)
+            bufferFrameCount = kDefaultVirtualBufferFrameCount;
+
+        const uint32_t modeIndex = enum_cast(openInfo.Mode);
+        m_StreamData.DeviceID[modeIndex] = openInfo.DeviceID;
+        m_StreamData.SampleRate = openInfo.SampleRate;
+        m_StreamData.BufferFrameCount = bufferFrameCount;
+        m_StreamData.BufferCount = 1;
+        m_StreamData.User.Format = openInfo.Format;
+        m_StreamData.User.ChannelCount[modeIndex] = openInfo.ChannelCount;
+        m_StreamData.FirstChannelIndex[modeIndex] = openInfo.FirstChannelIndex;
+        m_StreamData.Device.Format[modeIndex] = openInfo.Format;
+        m_StreamData.Device.ChannelCount[modeIndex] = openInfo.ChannelCount;
+        m_StreamData.Device.Interleaved[modeIndex] = false;
+
+        // There's no device buffer, the callback reads and writes the user buffers directly.
+        m_StreamData.ConversionInfo[modeIndex].IsNeeded = false;
+
+        const uint32_t bufferByteSize = m_StreamData.User.ChannelCount[modeIndex] * m_StreamData.BufferFrameCount
+            * audio::GetFormatByteSize(m_StreamData.User.Format);
+
+        m_StreamData.UserBuffer[modeIndex].reset(memory::DefaultNewArray<uint8_t>(bufferByteSize));
+        memset(m_StreamData.UserBuffer[modeIndex].get(), 0, bufferByteSize);
 
-        ConvertBufferImpl(std::make_integer_sequence<uint32_t, kMaxFormatFlagBit + 1>{},
-                          pOutBuffer,
-                          pInBuffer,
-                          m_StreamData.BufferFrameCount,
-                          info);
+        return audio::ResultCode::Success;
     }
 
 
@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <Audio/Backend/FormatConversion.hpp>
 #include <Audio/Engine.hpp>
 #include <Core/FixedVector.hpp>
 #include <Core/Threading.hpp>
@@ -24,20 +25,6 @@ namespace quinte
     };
 
 
-    struct BackendConversionInfo final
-    {
-        uint32_t ChannelCount;
-        bool IsNeeded;
-
-        struct
-        {
-            uint32_t Jump;
-            audio::Format Format;
-            SmallVector<int32_t, 2> Offset;
-        } In, Out;
-    };
-
-
     struct BackendStreamData final
     {
         threading::Mutex Mutex;
@@ -111,9 +98,21 @@ namespace quinte
         void InitializeConversionInfo(BackendStreamMode mode, uint32_t firstChannelIndex);
         void ConvertBuffer(uint8_t* pOutBuffer, const uint8_t* pInBuffer, const BackendConversionInfo& info);
 
+        //! \brief Create a single device that is not backed by any hardware, see OpenVirtualStream().
+        void InitializeVirtualDevice(StringSlice name);
+
+        //! \brief Open a stream on the virtual device: the callback reads and writes the user buffers directly.
+        audio::ResultCode OpenVirtualStream(const BackendStreamOpenInfo& openInfo, uint32_t& bufferFrameCount);
+
         virtual audio::ResultCode OpenStreamImpl(const BackendStreamOpenInfo& openInfo, uint32_t& bufferFrameCount) = 0;
 
     public:
+        //! \brief The number of input and output channels of the virtual device.
+        inline static constexpr uint32_t kVirtualDeviceChannelCount = 2;
+
+        //! \brief The buffer size of the virtual device used when the engine doesn't request a specific one.
+        inline static constexpr uint32_t kDefaultVirtualBufferFrameCount = 1024;
+
         inline audio::ResultCode GetLastResultCode() const
         {
             return m_LastResult.load(std::memory_order_acquire);
@@ -0,0 +1,184 @@
+﻿#include <Audio/Backend/Dummy.hpp>
+#include <chrono>
+
+namespace quinte
+{
+    inline constexpr uint32_t kInput = enum_cast(BackendStreamMode::Input);
+    inline constexpr uint32_t kOutput = enum_cast(BackendStreamMode::Output);
+
+
+    AudioBackendDummy::AudioBackendDummy() = default;
+
+
+    AudioBackendDummy::~AudioBackendDummy()
+    {
+        if (m_StreamData.State.load(std::memory_order_acquire) != audio::StreamState::Closed)
+            CloseStream();
+    }
+
+
+    void AudioBackendDummy::SetInputCallback(audio::DummyInputCallback callback, void* pUserData)
+    {
+        QU_Assert(m_StreamData.State.load(std::memory_order_acquire) != audio::StreamState::Running);
+        m_InputCallback = callback;
+        m_pInputUserData = pUserData;
+    }
+
+
+    audio::ResultCode AudioBackendDummy::OpenStreamImpl(const BackendStreamOpenInfo& openInfo, uint32_t& bufferFrameCount)
+    {
+        return OpenVirtualStream(openInfo, bufferFrameCount);
+    }
+
+
+    void AudioBackendDummy::CloseStream()
+    {
+        const std::unique_lock lock{ m_StreamData.Mutex };
+
+        const audio::StreamState state = m_StreamData.State.load(std::memory_order_acquire);
+        QU_Assert(state != audio::StreamState::Closed);
+
+        if (state == audio::StreamState::Running)
+            StopStream();
+
+        // The thread could have stopped by itself if the callback returned Stop or Abort.
+        threading::CloseThread(m_StreamData.CallbackInfo.Thread);
+
+        ClearStreamData();
+        m_StreamTime = 0.0;
+    }
+
+
+    audio::APIKind AudioBackendDummy::GetKind() const
+    {
+        return audio::APIKind::Dummy;
+    }
+
+
+    audio::ResultCode AudioBackendDummy::UpdateDeviceList()
+    {
+        InitializeVirtualDevice("Dummy");
+        return Ret(audio::ResultCode::Success);
+    }
+
+
+    audio::DeviceID AudioBackendDummy::GetDefautInputDevice() const
+    {
+        if (m_Devices.empty())
+        {
+            Ret(audio::ResultCode::FailUninitialized);
+            return audio::DeviceID{};
+        }
+
+        Ret(audio::ResultCode::Success);
+        return m_Devices[0].ID;
+    }
+
+
+    audio::DeviceID AudioBackendDummy::GetDefaultOutputDevice() const
+    {
+        return GetDefautInputDevice();
+    }
+
+
+    audio::ResultCode AudioBackendDummy::StartStream()
+    {
+        const std::unique_lock lock{ m_StreamData.Mutex };
+
+        const audio::StreamState currentState = m_StreamData.State.load(std::memory_order_acquire);
+        if (currentState == audio::StreamState::Stopping || currentState == audio::StreamState::Closed)
+            return Ret(audio::ResultCode::FailUninitialized);
+
+        // Join the thread that was stopped by the callback.
+        threading::CloseThread(m_StreamData.CallbackInfo.Thread);
+
+        m_StreamData.State.store(audio::StreamState::Running, std::memory_order_release);
+        m_StreamData.CallbackInfo.Thread = threading::CreateThread("Dummy Audio Thread", &RunThread, this);
+
+        return Ret(audio::ResultCode::Success);
+    }
+
+
+    audio::ResultCode AudioBackendDummy::StopStream()
+    {
+        audio::StreamState expectedState = audio::StreamState::Running;
+        if (!m_StreamData.State.compare_exchange_strong(expectedState, audio::StreamState::Stopping))
+            return Ret(audio::ResultCode::FailStreamNotRunning);
+
+        threading::CloseThread(m_StreamData.CallbackInfo.Thread);
+        return Ret(audio::ResultCode::Success);
+    }
+
+
+    audio::ResultCode AudioBackendDummy::AbortStream()
+    {
+        return StopStream();
+    }
+
+
+    void AudioBackendDummy::RunThread(void* pUserData)
+    {
+        static_cast<AudioBackendDummy*>(pUserData)->RunThreadImpl();
+    }
+
+
+    void AudioBackendDummy::RunThreadImpl()
+    {
+        using Clock = std::chrono::steady_clock;
+
+        QU_Defer
+        {
+            m_StreamData.State.store(audio::StreamState::Stopped, std::memory_order_release);
+        };
+
+        threading::PromoteCurrentThreadToRealtime();
+
+        const uint32_t frameCount = m_StreamData.BufferFrameCount;
+        const uint32_t inputChannelCount = m_StreamData.User.ChannelCount[kInput];
+        float* pInputBuffer = reinterpret_cast<float*>(m_StreamData.UserBuffer[kInput].get());
+        uint8_t* pOutputBuffer = m_StreamData.UserBuffer[kOutput].get();
+
+        const BackendStreamCallbackInfo& callbackInfo = m_StreamData.CallbackInfo;
+        const Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(frameCount) / m_StreamData.SampleRate));
+        const Clock::duration spinDuration = std::chrono::microseconds(kSpinMicroseconds);
+        threading::HighResolutionTimer timer;
+
+        Clock::time_point deadline = Clock::now();
+        audio::StreamStatus status = audio::StreamStatus::OK;
+        for (uint64_t cycleIndex = 0; m_StreamData.State.load(std::memory_order_acquire) == audio::StreamState::Running;
+             ++cycleIndex)
+        {
+            if (m_InputCallback && pInputBuffer)
+                m_InputCallback(pInputBuffer, inputChannelCount, frameCount, cycleIndex, m_pInputUserData);
+
+            const audio::CallbackResult result = callbackInfo.Callback(
+                pOutputBuffer, pInputBuffer, frameCount, GetStreamTime(), status, callbackInfo.pUserData);
+            if (result != audio::CallbackResult::OK)
+                return;
+
+            TickStreamTime();
+
+            // If the callback took longer than the period, we don't try to catch up: that would just run
+            // a burst of cycles. The next callback is told about the underflow instead.
+            deadline += period;
+            const Clock::time_point now = Clock::now();
+            status = audio::StreamStatus::OK;
+            if (now > deadline)
+            {
+                deadline = now;
+                status = audio::StreamStatus::OutputUnderflow;
+                continue;
+            }
+
+            if (deadline - now > spinDuration)
+            {
+                const auto waitDuration = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now - spinDuration);
+                timer.Wait(static_cast<uint32_t>(waitDuration.count()));
+            }
+
+            while (Clock::now() < deadline)
+                _mm_pause();
+        }
+    }
+} // namespace quinte
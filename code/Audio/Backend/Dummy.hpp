@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <Audio/Backend/BackendBase.hpp>
+
+namespace quinte
+{
+    namespace audio
+    {
+        //! \brief Fills the input buffer of the dummy backend before each cycle.
+        //!
+        //! \param pInputBuffer - Planar float samples, the channels are frameCount samples apart.
+        //! \param cycleIndex   - The index of the cycle since the stream was started.
+        typedef void (*DummyInputCallback)(float* pInputBuffer, uint32_t channelCount, uint32_t frameCount,
+                                           uint64_t cycleIndex, void* pUserData);
+    } // namespace audio
+
+
+    //! \brief A backend that runs the stream callback on a timer without any hardware.
+    //!
+    //! The callback is called every BufferFrameCount / SampleRate seconds. The thread waits on a high resolution
+    //! timer until shortly before the deadline and spins for the rest, since even that timer can wake up late.
+    //! The input is silent unless an input callback is set.
+    class AudioBackendDummy final : public AudioBackendBase
+    {
+        audio::DummyInputCallback m_InputCallback = nullptr;
+        void* m_pInputUserData = nullptr;
+
+        static void RunThread(void* pUserData);
+        void RunThreadImpl();
+
+    protected:
+        audio::ResultCode OpenStreamImpl(const BackendStreamOpenInfo& openInfo, uint32_t& bufferFrameCount) override;
+
+    public:
+        //! \brief The thread stops waiting and starts spinning this long before the next cycle.
+        inline static constexpr uint32_t kSpinMicroseconds = 500;
+
+        AudioBackendDummy();
+        ~AudioBackendDummy();
+
+        //! \brief Set the function that generates the input, must be called while the stream is not running.
+        void SetInputCallback(audio::DummyInputCallback callback, void* pUserData);
+
+        void CloseStream() override;
+
+        audio::APIKind GetKind() const override;
+        audio::ResultCode UpdateDeviceList() override;
+        audio::DeviceID GetDefautInputDevice() const override;
+        audio::DeviceID GetDefaultOutputDevice() const override;
+        audio::ResultCode StartStream() override;
+        audio::ResultCode StopStream() override;
+        audio::ResultCode AbortStream() override;
+    };
+} // namespace quinte
@@ -0,0 +1,341 @@
+﻿#include <Audio/Backend/FormatConversion.hpp>
+#include <Audio/Kernels/Kernels.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace quinte
+{
+    namespace
+    {
+        constexpr uint32_t kChunkFrameCount = 256;
+        constexpr uint32_t kScratchSampleCount = 4096;
+        constexpr uint32_t kFormatCount = std::countr_zero(enum_cast(audio::Format::Max)) + 1;
+
+        constexpr float kInt24Scale = 8388608.0f;
+        constexpr float kInt32Scale = 2147483648.0f;
+
+
+        enum class ConversionLayout : uint32_t
+        {
+            Planar,             //!< Planar to planar.
+            Interleave,         //!< Planar to interleaved.
+            InterleaveStereo,   //!< Planar to interleaved, two channels packed without gaps.
+            Deinterleave,       //!< Interleaved to planar.
+            DeinterleaveStereo, //!< Interleaved to planar, two channels packed without gaps.
+            Count,
+        };
+
+
+        template<audio::Format TFormat>
+        void Decode(float* pDestination, const audio::FormatType<TFormat>* pSource, uint32_t sampleCount)
+        {
+            const audio::KernelTable& kernels = audio::GetKernels();
+            if constexpr (TFormat == audio::Format::Int8)
+            {
+                for (uint32_t sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex)
+                    pDestination[sampleIndex] = static_cast<float>(pSource[sampleIndex]) * (1.0f / 128.0f);
+            }
+            else if constexpr (TFormat == audio::Format::Int16)
+            {
+                kernels.Int16ToFloat(pDestination, pSource, sampleCount);
+            }
+            else if constexpr (TFormat == audio::Format::Int24)
+            {
+                int32_t unpacked[kChunkFrameCount];
+                for (uint32_t offset = 0; offset < sampleCount; offset += kChunkFrameCount)
+                {
+                    const uint32_t length = Min(sampleCount - offset, kChunkFrameCount);
+                    for (uint32_t sampleIndex = 0; sampleIndex < length; ++sampleIndex)
+                        unpacked[sampleIndex] = static_cast<int32_t>(pSource[offset + sampleIndex]);
+
+                    kernels.Int32ToFloat(pDestination + offset, unpacked, kInt24Scale, length);
+                }
+            }
+            else if constexpr (TFormat == audio::Format::Int32)
+            {
+                kernels.Int32ToFloat(pDestination, pSource, kInt32Scale, sampleCount);
+            }
+            else if constexpr (TFormat == audio::Format::Float32)
+            {
+                memory::Copy(pDestination, pSource, sampleCount);
+            }
+            else
+            {
+                static_assert(TFormat == audio::Format::Float64);
+                kernels.ConvertToFloat(pDestination, pSource, sampleCount);
+            }
+        }
+
+
+        template<audio::Format TFormat>
+        void Encode(audio::FormatType<TFormat>* pDestination, const float* pSource, uint32_t sampleCount)
+        {
+            const audio::KernelTable& kernels = audio::GetKernels();
+            if constexpr (TFormat == audio::Format::Int8)
+            {
+                for (uint32_t sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex)
+                {
+                    const float value = std::nearbyint(pSource[sampleIndex] * 128.0f);
+                    pDestination[sampleIndex] = static_cast<int8_t>(std::clamp(value, -128.0f, 127.0f));
+                }
+            }
+            else if constexpr (TFormat == audio::Format::Int16)
+            {
+                kernels.FloatToInt16(pDestination, pSource, sampleCount);
+            }
+            else if constexpr (TFormat == audio::Format::Int24)
+            {
+                int32_t unpacked[kChunkFrameCount];
+                for (uint32_t offset = 0; offset < sampleCount; offset += kChunkFrameCount)
+                {
+                    const uint32_t length = Min(sampleCount - offset, kChunkFrameCount);
+                    kernels.FloatToInt32(unpacked, pSource + offset, kInt24Scale, length);
+                    for (uint32_t sampleIndex = 0; sampleIndex < length; ++sampleIndex)
+                        pDestination[offset + sampleIndex] = unpacked[sampleIndex];
+                }
+            }
+            else if constexpr (TFormat == audio::Format::Int32)
+            {
+                kernels.FloatToInt32(pDestination, pSource, kInt32Scale, sampleCount);
+            }
+            else if constexpr (TFormat == audio::Format::Float32)
+            {
+                memory::Copy(pDestination, pSource, sampleCount);
+            }
+            else
+            {
+                static_assert(TFormat == audio::Format::Float64);
+                kernels.ConvertToDouble(pDestination, pSource, sampleCount);
+            }
+        }
+
+
+        template<audio::Format TFormat>
+        void CopyChannels(uint8_t* pOutBuffer, const uint8_t* pInBuffer, uint32_t frameCount, const BackendConversionInfo& info)
+        {
+            using Type = audio::FormatType<TFormat>;
+            const Type* pIn = reinterpret_cast<const Type*>(pInBuffer);
+            Type* pOut = reinterpret_cast<Type*>(pOutBuffer);
+
+            for (uint32_t channelIndex = 0; channelIndex < info.ChannelCount; ++channelIndex)
+            {
+                const Type* pSource = pIn + info.In.Offset[channelIndex];
+                Type* pDestination = pOut + info.Out.Offset[channelIndex];
+                if (info.In.Jump == 1 && info.Out.Jump == 1)
+                {
+                    memory::Copy(pDestination, pSource, frameCount);
+                    continue;
+                }
+
+                for (uint32_t frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+                    pDestination[frameIndex * info.Out.Jump] = pSource[frameIndex * info.In.Jump];
+            }
+        }
+
+
+        template<audio::Format TInFormat, audio::Format TOutFormat, ConversionLayout TLayout>
+        void Convert(uint8_t* pOutBuffer, const uint8_t* pInBuffer, uint32_t frameCount, const BackendConversionInfo& info)
+        {
+            constexpr bool kFloatIn = TInFormat == audio::Format::Float32;
+            constexpr bool kFloatOut = TOutFormat == audio::Format::Float32;
+
+            const auto* pIn = reinterpret_cast<const audio::FormatType<TInFormat>*>(pInBuffer);
+            auto* pOut = reinterpret_cast<audio::FormatType<TOutFormat>*>(pOutBuffer);
+            const audio::KernelTable& kernels = audio::GetKernels();
+
+            alignas(memory::kCacheLineSize) float frames[kScratchSampleCount];
+            alignas(memory::kCacheLineSize) float channels[2][kChunkFrameCount];
+
+            const uint32_t chunkFrameCount = Min(kChunkFrameCount, kScratchSampleCount / Max(info.In.Jump, info.Out.Jump));
+            for (uint32_t frameIndex = 0; frameIndex < frameCount; frameIndex += chunkFrameCount)
+            {
+                const uint32_t length = Min(frameCount - frameIndex, chunkFrameCount);
+
+                // Get the planar float data of a channel, converting and dithering it to the scratch buffer if needed.
+                const auto decodeChannel = [&](uint32_t channelIndex, float* pScratch) -> const float* {
+                    const auto* pSource = pIn + info.In.Offset[channelIndex] + frameIndex;
+                    const float* pChannel = pScratch;
+                    if constexpr (kFloatIn)
+                        pChannel = pSource;
+                    else
+                        Decode<TInFormat>(pScratch, pSource, length);
+
+                    if (!info.pDitherer)
+                        return pChannel;
+
+                    info.pDitherer->Process(channelIndex, pScratch, pChannel, length);
+                    return pScratch;
+                };
+
+                if constexpr (TLayout == ConversionLayout::Planar)
+                {
+                    for (uint32_t channelIndex = 0; channelIndex < info.ChannelCount; ++channelIndex)
+                    {
+                        auto* pDestination = pOut + info.Out.Offset[channelIndex] + frameIndex;
+                        if constexpr (kFloatOut)
+                            Decode<TInFormat>(pDestination, pIn + info.In.Offset[channelIndex] + frameIndex, length);
+                        else
+                            Encode<TOutFormat>(pDestination, decodeChannel(channelIndex, channels[0]), length);
+                    }
+                }
+                else if constexpr (TLayout == ConversionLayout::Interleave || TLayout == ConversionLayout::InterleaveStereo)
+                {
+                    const uint32_t jump = info.Out.Jump;
+                    auto* pDestination = pOut + static_cast<uint64_t>(frameIndex) * jump;
+
+                    float* pFrames = frames;
+                    if constexpr (kFloatOut)
+                        pFrames = pDestination;
+                    else if (jump > info.ChannelCount)
+                        memory::Zero(frames, length * jump);
+
+                    if constexpr (TLayout == ConversionLayout::InterleaveStereo)
+                    {
+                        kernels.Interleave2(pFrames, decodeChannel(0, channels[0]), decodeChannel(1, channels[1]), length);
+                    }
+                    else
+                    {
+                        for (uint32_t channelIndex = 0; channelIndex < info.ChannelCount; ++channelIndex)
+                        {
+                            const float* pChannel = decodeChannel(channelIndex, channels[0]);
+                            float* pFrameChannel = pFrames + info.Out.Offset[channelIndex];
+                            for (uint32_t sampleIndex = 0; sampleIndex < length; ++sampleIndex)
+                                pFrameChannel[sampleIndex * jump] = pChannel[sampleIndex];
+                        }
+                    }
+
+                    if constexpr (!kFloatOut)
+                        Encode<TOutFormat>(pDestination, frames, length * jump);
+                }
+                else
+                {
+                    const uint32_t jump = info.In.Jump;
+                    const auto* pSource = pIn + static_cast<uint64_t>(frameIndex) * jump;
+
+                    const float* pFrames = frames;
+                    if constexpr (kFloatIn)
+                        pFrames = pSource;
+                    else
+                        Decode<TInFormat>(frames, pSource, length * jump);
+
+                    // The float output is written directly, the other formats go through the channel scratch buffers.
+                    const auto getChannelTarget = [&](uint32_t channelIndex, float* pScratch) -> float* {
+                        if constexpr (kFloatOut)
+                            return pOut + info.Out.Offset[channelIndex] + frameIndex;
+                        else
+                            return pScratch;
+                    };
+
+                    const auto encodeChannel = [&](uint32_t channelIndex, float* pChannel) {
+                        if constexpr (!kFloatOut)
+                        {
+                            if (info.pDitherer)
+                                info.pDitherer->Process(channelIndex, pChannel, pChannel, length);
+
+                            Encode<TOutFormat>(pOut + info.Out.Offset[channelIndex] + frameIndex, pChannel, length);
+                        }
+                    };
+
+                    if constexpr (TLayout == ConversionLayout::DeinterleaveStereo)
+                    {
+                        float* pFirst = getChannelTarget(0, channels[0]);
+                        float* pSecond = getChannelTarget(1, channels[1]);
+                        kernels.Deinterleave2(pFirst, pSecond, pFrames, length);
+                        encodeChannel(0, pFirst);
+                        encodeChannel(1, pSecond);
+                    }
+                    else
+                    {
+                        for (uint32_t channelIndex = 0; channelIndex < info.ChannelCount; ++channelIndex)
+                        {
+                            float* pChannel = getChannelTarget(channelIndex, channels[0]);
+                            const float* pFrameChannel = pFrames + info.In.Offset[channelIndex];
+                            for (uint32_t sampleIndex = 0; sampleIndex < length; ++sampleIndex)
+                                pChannel[sampleIndex] = pFrameChannel[sampleIndex * jump];
+
+                            encodeChannel(channelIndex, pChannel);
+                        }
+                    }
+                }
+            }
+        }
+
+
+        using LayoutConverterTable = std::array<BackendConvertFunction, enum_cast(ConversionLayout::Count)>;
+
+
+        template<uint32_t TInFormatIndex, uint32_t TOutFormatIndex>
+        constexpr LayoutConverterTable MakeLayoutConverterTable()
+        {
+            constexpr auto kInFormat = static_cast<audio::Format>(1 << TInFormatIndex);
+            constexpr auto kOutFormat = static_cast<audio::Format>(1 << TOutFormatIndex);
+            if constexpr (kInFormat == kOutFormat && kInFormat != audio::Format::Float32)
+            {
+                // Converting to float and back would lose the low bits of the 32-bit formats.
+                LayoutConverterTable result;
+                result.fill(&CopyChannels<kInFormat>);
+                return result;
+            }
+
+            return {
+                &Convert<kInFormat, kOutFormat, ConversionLayout::Planar>,
+                &Convert<kInFormat, kOutFormat, ConversionLayout::Interleave>,
+                &Convert<kInFormat, kOutFormat, ConversionLayout::InterleaveStereo>,
+                &Convert<kInFormat, kOutFormat, ConversionLayout::Deinterleave>,
+                &Convert<kInFormat, kOutFormat, ConversionLayout::DeinterleaveStereo>,
+            };
+        }
+
+
+        template<uint32_t TInFormatIndex, uint32_t... TOutFormatIndices>
+        constexpr std::array<LayoutConverterTable, kFormatCount> MakeOutConverterTable(
+            std::integer_sequence<uint32_t, TOutFormatIndices...>)
+        {
+            return { MakeLayoutConverterTable<TInFormatIndex, TOutFormatIndices>()... };
+        }
+
+
+        template<uint32_t... TInFormatIndices>
+        constexpr auto MakeConverterTable(std::integer_sequence<uint32_t, TInFormatIndices...> sequence)
+        {
+            return std::array<std::array<LayoutConverterTable, kFormatCount>, kFormatCount>{ MakeOutConverterTable<
+                TInFormatIndices>(sequence)... };
+        }
+
+
+        constexpr auto kConverters = MakeConverterTable(std::make_integer_sequence<uint32_t, kFormatCount>{});
+
+
+        bool IsStereoPacked(uint32_t channelCount, uint32_t jump, const SmallVector<int32_t, 2>& offsets)
+        {
+            return channelCount == 2 && jump == 2 && offsets[0] == 0 && offsets[1] == 1;
+        }
+    } // namespace
+
+
+    BackendConvertFunction SelectBackendConverter(const BackendConversionInfo& info)
+    {
+        QU_Assert(info.In.Jump == 1 || info.Out.Jump == 1);
+        QU_Assert(Max(info.In.Jump, info.Out.Jump) <= kScratchSampleCount);
+        QU_Assert(info.In.Offset.size() >= info.ChannelCount && info.Out.Offset.size() >= info.ChannelCount);
+
+        ConversionLayout layout = ConversionLayout::Planar;
+        if (info.Out.Jump > 1)
+        {
+            layout = IsStereoPacked(info.ChannelCount, info.Out.Jump, info.Out.Offset) ? ConversionLayout::InterleaveStereo
+                                                                                         : ConversionLayout::Interleave;
+        }
+        else if (info.In.Jump > 1)
+        {
+            layout = IsStereoPacked(info.ChannelCount, info.In.Jump, info.In.Offset) ? ConversionLayout::DeinterleaveStereo
+                                                                                       : ConversionLayout::Deinterleave;
+        }
+
+        const uint32_t inFormatIndex = std::countr_zero(enum_cast(info.In.Format));
+        const uint32_t outFormatIndex = std::countr_zero(enum_cast(info.Out.Format));
+        QU_Assert(inFormatIndex < kFormatCount && outFormatIndex < kFormatCount);
+
+        return kConverters[inFormatIndex][outFormatIndex][enum_cast(layout)];
+    }
+} // namespace quinte
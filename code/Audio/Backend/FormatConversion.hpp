@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <Audio/Base.hpp>
+#include <Audio/Dither.hpp>
+#include <Core/FixedVector.hpp>
+
+namespace quinte
+{
+    struct BackendConversionInfo;
+
+
+    //! \brief A function that converts a buffer between the user and the device formats and layouts.
+    using BackendConvertFunction = void (*)(uint8_t* pOutBuffer, const uint8_t* pInBuffer, uint32_t frameCount,
+                                            const BackendConversionInfo& info);
+
+
+    struct BackendConversionInfo final
+    {
+        uint32_t ChannelCount;
+        bool IsNeeded;
+
+        struct
+        {
+            uint32_t Jump;
+            audio::Format Format;
+            SmallVector<int32_t, 2> Offset;
+        } In, Out;
+
+        //! \brief The converter specialized for the formats and the layout, see SelectBackendConverter().
+        BackendConvertFunction pConvert;
+
+        //! \brief Dithers the samples before the narrowing conversions, null if the output isn't narrower.
+        memory::unique_ptr<audio::Ditherer> pDitherer;
+    };
+
+
+    //! \brief Select the converter for the formats and the layout described by the conversion info.
+    //!
+    //! The converters are instantiated for every pair of formats and every layout, so the choice is made
+    //! once when the stream is opened. The samples are converted through 32-bit float: exact for the formats
+    //! up to 24 bits, the narrowing conversions are rounded to nearest and clamped at full scale. The buffers
+    //! of the same format are copied without a conversion. If the info has a ditherer, it is applied to the
+    //! channels before they are converted to the output format.
+    //!
+    //! At least one side must be planar, i.e. have Jump == 1.
+    BackendConvertFunction SelectBackendConverter(const BackendConversionInfo& info);
+} // namespace quinte
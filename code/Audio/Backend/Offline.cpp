@@ -0,0 +1,118 @@
+﻿#include <Audio/Backend/Offline.hpp>
+
+namespace quinte
+{
+    inline constexpr uint32_t kInput = enum_cast(BackendStreamMode::Input);
+    inline constexpr uint32_t kOutput = enum_cast(BackendStreamMode::Output);
+
+
+    AudioBackendOffline::AudioBackendOffline() = default;
+
+
+    AudioBackendOffline::~AudioBackendOffline()
+    {
+        if (m_StreamData.State.load(std::memory_order_acquire) != audio::StreamState::Closed)
+            CloseStream();
+    }
+
+
+    audio::ResultCode AudioBackendOffline::OpenStreamImpl(const BackendStreamOpenInfo& openInfo, uint32_t& bufferFrameCount)
+    {
+        return OpenVirtualStream(openInfo, bufferFrameCount);
+    }
+
+
+    void AudioBackendOffline::CloseStream()
+    {
+        const std::unique_lock lock{ m_StreamData.Mutex };
+
+        QU_Assert(m_StreamData.State.load(std::memory_order_acquire) != audio::StreamState::Closed);
+        ClearStreamData();
+        m_StreamTime = 0.0;
+    }
+
+
+    audio::APIKind AudioBackendOffline::GetKind() const
+    {
+        return audio::APIKind::Offline;
+    }
+
+
+    audio::ResultCode AudioBackendOffline::UpdateDeviceList()
+    {
+        InitializeVirtualDevice("Offline");
+        return Ret(audio::ResultCode::Success);
+    }
+
+
+    audio::DeviceID AudioBackendOffline::GetDefautInputDevice() const
+    {
+        if (m_Devices.empty())
+        {
+            Ret(audio::ResultCode::FailUninitialized);
+            return audio::DeviceID{};
+        }
+
+        Ret(audio::ResultCode::Success);
+        return m_Devices[0].ID;
+    }
+
+
+    audio::DeviceID AudioBackendOffline::GetDefaultOutputDevice() const
+    {
+        return GetDefautInputDevice();
+    }
+
+
+    audio::ResultCode AudioBackendOffline::StartStream()
+    {
+        const std::unique_lock lock{ m_StreamData.Mutex };
+
+        const audio::StreamState currentState = m_StreamData.State.load(std::memory_order_acquire);
+        if (currentState == audio::StreamState::Stopping || currentState == audio::StreamState::Closed)
+            return Ret(audio::ResultCode::FailUninitialized);
+
+        m_StreamData.State.store(audio::StreamState::Running, std::memory_order_release);
+        return Ret(audio::ResultCode::Success);
+    }
+
+
+    audio::ResultCode AudioBackendOffline::StopStream()
+    {
+        audio::StreamState expectedState = audio::StreamState::Running;
+        if (!m_StreamData.State.compare_exchange_strong(expectedState, audio::StreamState::Stopped))
+            return Ret(audio::ResultCode::FailStreamNotRunning);
+
+        return Ret(audio::ResultCode::Success);
+    }
+
+
+    audio::ResultCode AudioBackendOffline::AbortStream()
+    {
+        return StopStream();
+    }
+
+
+    audio::CallbackResult AudioBackendOffline::ProcessCycle(uint32_t frameCount)
+    {
+        QU_AssertDebug(m_StreamData.State.load(std::memory_order_relaxed) == audio::StreamState::Running);
+        QU_AssertDebug(frameCount <= m_StreamData.BufferFrameCount);
+
+        const BackendStreamCallbackInfo& callbackInfo = m_StreamData.CallbackInfo;
+        const audio::CallbackResult result = callbackInfo.Callback(m_StreamData.UserBuffer[kOutput].get(),
+                                                                   m_StreamData.UserBuffer[kInput].get(),
+                                                                   frameCount,
+                                                                   GetStreamTime(),
+                                                                   audio::StreamStatus::OK,
+                                                                   callbackInfo.pUserData);
+
+        m_StreamTime += static_cast<double>(frameCount) / m_StreamData.SampleRate;
+        return result;
+    }
+
+
+    const float* AudioBackendOffline::GetOutputBuffer() const
+    {
+        return reinterpret_cast<const float*>(m_StreamData.UserBuffer[kOutput].get());
+    }
+} // namespace quinte
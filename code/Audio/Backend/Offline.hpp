@@ -0,0 +1,37 @@
+﻿#pragma once
+#include <Audio/Backend/BackendBase.hpp>
+
+namespace quinte
+{
+    //! \brief A backend that is not connected to any hardware, used for faster-than-realtime rendering.
+    //!
+    //! The stream has no thread: the cycles are pulled by calling ProcessCycle() (see AudioEngine::RenderOffline()),
+    //! so the graph runs as fast as the CPU allows. The input channels are always silent.
+    class AudioBackendOffline final : public AudioBackendBase
+    {
+    protected:
+        audio::ResultCode OpenStreamImpl(const BackendStreamOpenInfo& openInfo, uint32_t& bufferFrameCount) override;
+
+    public:
+        AudioBackendOffline();
+        ~AudioBackendOffline();
+
+        void CloseStream() override;
+
+        audio::APIKind GetKind() const override;
+        audio::ResultCode UpdateDeviceList() override;
+        audio::DeviceID GetDefautInputDevice() const override;
+        audio::DeviceID GetDefaultOutputDevice() const override;
+        audio::ResultCode StartStream() override;
+        audio::ResultCode StopStream() override;
+        audio::ResultCode AbortStream() override;
+
+        //! \brief Run the stream callback once.
+        //!
+        //! \param frameCount - The number of frames to process, must not exceed the stream buffer size.
+        audio::CallbackResult ProcessCycle(uint32_t frameCount);
+
+        //! \brief Get the output of the last cycle: planar, the channels are frameCount samples apart.
+        [[nodiscard]] const float* GetOutputBuffer() const;
+    };
+} // namespace quinte
@@ -500,11 +500,14 @@ namespace quinte
 
             constexpr uint32_t modeIndex = kInput;
 
-            pCaptureResampler.reset(memory::New<Resampler>(&temp,
-                                                           m_StreamData.Device.Format[modeIndex],
-                                                           m_StreamData.Device.ChannelCount[modeIndex],
-                                                           captureFormat->nSamplesPerSec,
-                                                           m_StreamData.SampleRate));
+            pCaptureResampler.reset(
+                memory::New<Resampler>(&temp,
+                                       m_StreamData.Device.Format[modeIndex],
+                                       m_StreamData.Device.ChannelCount[modeIndex],
+                                       captureFormat->nSamplesPerSec,
+                                       m_StreamData.SampleRate,
+                                       CeilDivide(m_StreamData.BufferFrameCount * captureFormat->nSamplesPerSec,
+                                                  m_StreamData.SampleRate)));
 
             if (!captureClient)
             {
@@ -565,8 +568,9 @@ namespace quinte
             pRenderResampler.reset(memory::New<Resampler>(&temp,
                                                           m_StreamData.Device.Format[modeIndex],
                                                           m_StreamData.Device.ChannelCount[modeIndex],
+                                                          m_StreamData.SampleRate,
                                                           renderFormat->nSamplesPerSec,
-                                                          m_StreamData.SampleRate));
+                                                          m_StreamData.BufferFrameCount));
 
             if (!renderClient)
             {
@@ -650,7 +654,7 @@ namespace quinte
             {
                 if (captureAudioClient)
                 {
-                    uint32_t pullSampleCount =
+                    const uint32_t maxPullSampleCount =
                         CeilDivide(m_StreamData.BufferFrameCount * captureFormatSampleRate, m_StreamData.SampleRate);
                     convBufferSize = 0;
 
@@ -658,21 +662,26 @@ namespace quinte
                     const uint32_t inputFormatSize = audio::GetFormatByteSize(m_StreamData.Device.Format[kInput]);
                     while (convBufferSize < m_StreamData.BufferFrameCount)
                     {
-                        callbackPulled = captureBuffer.Pull(convBuffer, pullSampleCount * inputChannelCount, inputFormatSize);
-                        if (!callbackPulled)
-                            break;
+                        // Only pull the input that is needed, otherwise the leftover would pile up in the resampler
+                        // every time the buffer size is not a multiple of the rate ratio.
+                        const uint32_t remainingSampleCount = m_StreamData.BufferFrameCount - convBufferSize;
+                        const uint32_t pullSampleCount =
+                            Min(pCaptureResampler->GetRequiredInputCount(remainingSampleCount), maxPullSampleCount);
+                        if (pullSampleCount > 0)
+                        {
+                            callbackPulled =
+                                captureBuffer.Pull(convBuffer, pullSampleCount * inputChannelCount, inputFormatSize);
+                            if (!callbackPulled)
+                                break;
+                        }
 
                         const uint32_t deviceBufferOffset = convBufferSize * inputChannelCount * inputFormatSize;
 
-                        const uint32_t convSampleCount =
-                            pCaptureResampler->Convert(&m_StreamData.DeviceBuffer[deviceBufferOffset],
-                                                       convBuffer,
-                                                       pullSampleCount,
-                                                       convBufferSize == 0 ? std::numeric_limits<uint32_t>::max()
-                                                                           : m_StreamData.BufferFrameCount - convBufferSize);
+                        const uint32_t convSampleCount = pCaptureResampler->Convert(
+                            &m_StreamData.DeviceBuffer[deviceBufferOffset], convBuffer, pullSampleCount, remainingSampleCount);
 
                         convBufferSize += convSampleCount;
-                        pullSampleCount = 1;
+                        callbackPulled = true;
                     }
 
                     if (callbackPulled)
@@ -819,12 +828,23 @@ namespace quinte
 
 
     AudioBackendWASAPI::Resampler::Resampler(audio::Format format, uint32_t channelCount, uint32_t inSampleRate,
-                                             uint32_t outSampleRate)
+                                             uint32_t outSampleRate, uint32_t maxInSampleCount)
         : Format(format)
         , ChannelCount(channelCount)
         , InSampleRate(inSampleRate)
         , OutSampleRate(outSampleRate)
     {
+        if (inSampleRate == outSampleRate)
+            return;
+
+        if (format == audio::Format::Float32)
+        {
+            const Rc<audio::ResamplerFilter> pFilter =
+                Rc<audio::ResamplerFilter>::DefaultNew(inSampleRate, outSampleRate, audio::ResamplerQuality::Draft);
+            FloatResampler.Initialize(pFilter.Get(), channelCount, maxInSampleCount);
+            return;
+        }
+
         CheckHR(MFStartup(MF_VERSION, MFSTARTUP_NOSOCKET));
         CheckHR(
             CoCreateInstance(CLSID_CResamplerMediaObject, nullptr, CLSCTX_INPROC_SERVER, IID_IUnknown, (void**)&pTransformUnk));
@@ -869,12 +889,27 @@ namespace quinte
 
     AudioBackendWASAPI::Resampler::~Resampler()
     {
+        if (!pTransform)
+            return;
+
         CheckHR(pTransform->ProcessMessage(MFT_MESSAGE_NOTIFY_END_OF_STREAM, 0));
         CheckHR(pTransform->ProcessMessage(MFT_MESSAGE_NOTIFY_END_STREAMING, 0));
         MFShutdown();
     }
 
 
+    uint32_t AudioBackendWASAPI::Resampler::GetRequiredInputCount(uint32_t outSampleCount) const
+    {
+        if (InSampleRate == OutSampleRate)
+            return outSampleCount;
+
+        if (Format == audio::Format::Float32)
+            return FloatResampler.GetRequiredInputCount(outSampleCount);
+
+        return CeilDivide(outSampleCount * InSampleRate, OutSampleRate);
+    }
+
+
     uint32_t AudioBackendWASAPI::Resampler::Convert(uint8_t* pOutBuffer, const uint8_t* pInBuffer, uint32_t inSampleCount,
                                                     uint32_t maxOutSampleCount)
     {
@@ -887,6 +922,14 @@ namespace quinte
             return inSampleCount;
         }
 
+        if (Format == audio::Format::Float32)
+        {
+            return FloatResampler.ProcessInterleaved(reinterpret_cast<const float*>(pInBuffer),
+                                                     inSampleCount,
+                                                     reinterpret_cast<float*>(pOutBuffer),
+                                                     maxOutSampleCount);
+        }
+
         const uint32_t outputBufferSize = maxOutSampleCount == std::numeric_limits<uint32_t>::max()
             ? CeilDivide(inputBufferSize * OutSampleRate, InSampleRate)
             : bytesPerSample * ChannelCount * maxOutSampleCount;
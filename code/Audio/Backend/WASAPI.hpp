@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <Audio/Backend/BackendBase.hpp>
+#include <Audio/Resampler.hpp>
 #include <Core/String.hpp>
 #include <Core/Platform/Windows/Utils.hpp>
 #include <array>
@@ -32,6 +33,9 @@ namespace quinte
             uint32_t InSampleRate;
             uint32_t OutSampleRate;
 
+            //! \brief Converts the float formats, Media Foundation is only used for the integer ones.
+            audio::Resampler FloatResampler;
+
             Rc<IUnknown> pTransformUnk;
             Rc<IMFTransform> pTransform;
 
@@ -41,9 +45,15 @@ namespace quinte
 
             Rc<IWMResamplerProps> pResamplerProps;
 
-            Resampler(audio::Format format, uint32_t channelCount, uint32_t inSampleRate, uint32_t outSampleRate);
+            Resampler(audio::Format format, uint32_t channelCount, uint32_t inSampleRate, uint32_t outSampleRate,
+                      uint32_t maxInSampleCount);
             ~Resampler();
 
+            //! \brief Get the number of input samples to pass to Convert() to produce outSampleCount samples.
+            //!
+            //! The float resampler keeps the input that wasn't used, so the result accounts for it and can be zero.
+            uint32_t GetRequiredInputCount(uint32_t outSampleCount) const;
+
             uint32_t Convert(uint8_t* pOutBuffer, const uint8_t* pInBuffer, uint32_t inSampleCount,
                              uint32_t maxOutSampleCount = std::numeric_limits<uint32_t>::max());
         };
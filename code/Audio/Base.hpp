@@ -221,6 +221,8 @@ namespace quinte::audio
         FailDeviceNotFound = -4,
         FailDeviceModeNotSupported = -5,
         FailStreamNotRunning = -6,
+        FailGraphCycle = -7,
+        FailFileAccess = -8,
     };
 
 
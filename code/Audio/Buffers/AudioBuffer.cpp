@@ -161,9 +161,6 @@ namespace quinte
             return;
         }
 
-        for (uint64_t sampleIndex = 0; sampleIndex < length; ++sampleIndex)
-        {
-            m_pData[sampleIndex + offset] *= gain;
-        }
+        audio::GetKernels().ApplyGain(m_pData + offset, gain, length);
     }
 } // namespace quinte
@@ -1,31 +1,23 @@
 ﻿#pragma once
 #include <Audio/Buffers/BufferView.hpp>
+#include <Audio/Kernels/Kernels.hpp>
 
 namespace quinte::detail
 {
+    //
+    // We can't mix a buffer with itself, the kernels assume that the source and the destination don't overlap.
+    // Use asserts to ensure proper usage.
+    //
+
     inline void MixBuffersImpl(float* QU_RESTRICT pDestination, const float* QU_RESTRICT pSource, uint64_t sampleCount)
     {
-        //
-        // I decided not to write custom SIMD optimized algorithms for operations with buffers since Clang can
-        // do this for me, especially in simple cases like this one. And it also adapts to the ISA.
-        //
-        // Using __restrict here greatly reduces the amount of code generated: https://godbolt.org/z/xhjM13Yo8
-        // So we should keep in mind that we can't mix a buffer with itself and use asserts to ensure proper usage.
-        //
-
-        for (uint64_t sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex)
-        {
-            pDestination[sampleIndex] += pSource[sampleIndex];
-        }
+        audio::GetKernels().Mix(pDestination, pSource, sampleCount);
     }
 
 
     inline void MixBuffersImpl(float* QU_RESTRICT pDestination, const float* QU_RESTRICT pSource, float gain,
                                uint64_t sampleCount)
     {
-        for (uint64_t sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex)
-        {
-            pDestination[sampleIndex] += pSource[sampleIndex] * gain;
-        }
+        audio::GetKernels().MixWithGain(pDestination, pSource, gain, sampleCount);
     }
 } // namespace quinte::detail
@@ -150,6 +150,132 @@ namespace quinte
     }
 
 
+    void AudioBufferView::MixWithGainRamp(const BaseBufferView* pSourceBuffer, float gainStart, float gainStep,
+                                          uint64_t srcOffset, uint64_t destOffset, uint64_t length)
+    {
+        QU_Assert(this != pSourceBuffer);
+        QU_Assert(destOffset + length <= m_Capacity);
+        QU_Assert(srcOffset + length <= pSourceBuffer->GetCapacity());
+
+        m_Written = true;
+        if (pSourceBuffer->IsSilent())
+            return;
+
+        const float* pSource = static_cast<const AudioBufferView*>(pSourceBuffer)->m_pData;
+        audio::GetKernels().MixWithGainRamp(m_pData + destOffset, pSource + srcOffset, gainStart, gainStep, length);
+        m_Silent = false;
+    }
+
+
+    audio::BlockLevels AudioBufferView::MixWithGainRampAndMeasure(const BaseBufferView* pSourceBuffer, float gainStart,
+                                                                  float gainStep, uint64_t srcOffset, uint64_t destOffset,
+                                                                  uint64_t length)
+    {
+        QU_Assert(this != pSourceBuffer);
+        QU_Assert(destOffset + length <= m_Capacity);
+        QU_Assert(srcOffset + length <= pSourceBuffer->GetCapacity());
+
+        m_Written = true;
+
+        const audio::KernelTable& kernels = audio::GetKernels();
+        if (pSourceBuffer->IsSilent())
+        {
+            if (m_Silent)
+                return {};
+
+            return { kernels.Peak(m_pData + destOffset, length), kernels.SumOfSquares(m_pData + destOffset, length) };
+        }
+
+        const float* pSource = static_cast<const AudioBufferView*>(pSourceBuffer)->m_pData;
+        const audio::BlockLevels levels =
+            kernels.MixWithGainRampAndMeasure(m_pData + destOffset, pSource + srcOffset, gainStart, gainStep, length);
+        m_Silent = false;
+        return levels;
+    }
+
+
+    void AudioBufferView::MixMany(std::span<const AudioBufferView* const> sources, std::span<const float> gains, uint64_t offset,
+                                  uint64_t length, double* pAccumulator)
+    {
+        QU_Assert(gains.empty() || gains.size() == sources.size());
+        QU_Assert(offset + length <= m_Capacity);
+
+        const audio::KernelTable& kernels = audio::GetKernels();
+
+        if (pAccumulator)
+        {
+            bool accumulatorInitialized = false;
+            for (size_t sourceIndex = 0; sourceIndex < sources.size(); ++sourceIndex)
+            {
+                const AudioBufferView* pSourceBuffer = sources[sourceIndex];
+                QU_Assert(this != pSourceBuffer);
+                QU_Assert(offset + length <= pSourceBuffer->GetCapacity());
+
+                const float gain = gains.empty() ? 1.0f : gains[sourceIndex];
+                if (pSourceBuffer->IsSilent() || gain == 0.0f)
+                    continue;
+
+                if (!accumulatorInitialized)
+                {
+                    if (m_Silent)
+                        memory::Zero(pAccumulator, length);
+                    else
+                        kernels.ConvertToDouble(pAccumulator, m_pData + offset, length);
+
+                    accumulatorInitialized = true;
+                }
+
+                kernels.MixToDouble(pAccumulator, pSourceBuffer->m_pData + offset, gain, length);
+            }
+
+            if (accumulatorInitialized)
+            {
+                kernels.ConvertToFloat(m_pData + offset, pAccumulator, length);
+                m_Silent = false;
+            }
+
+            m_Written = true;
+            return;
+        }
+
+        const float* batchSources[kMixManyBatchSize];
+        float batchGains[kMixManyBatchSize];
+        uint32_t batchSize = 0;
+        bool mixed = false;
+
+        for (size_t sourceIndex = 0; sourceIndex < sources.size(); ++sourceIndex)
+        {
+            const AudioBufferView* pSourceBuffer = sources[sourceIndex];
+            QU_Assert(this != pSourceBuffer);
+            QU_Assert(offset + length <= pSourceBuffer->GetCapacity());
+
+            const float gain = gains.empty() ? 1.0f : gains[sourceIndex];
+            if (pSourceBuffer->IsSilent() || gain == 0.0f)
+                continue;
+
+            batchSources[batchSize] = pSourceBuffer->m_pData + offset;
+            batchGains[batchSize] = gain;
+            if (++batchSize == kMixManyBatchSize)
+            {
+                kernels.MixMany(m_pData + offset, batchSources, batchGains, batchSize, length);
+                batchSize = 0;
+                mixed = true;
+            }
+        }
+
+        if (batchSize > 0)
+        {
+            kernels.MixMany(m_pData + offset, batchSources, batchGains, batchSize, length);
+            mixed = true;
+        }
+
+        if (mixed)
+            m_Silent = false;
+
+        m_Written = true;
+    }
+
+
     void AudioBufferView::ApplyGain(float gain, uint64_t offset, uint64_t length)
     {
         if (gain == 0.0f)
@@ -160,9 +286,6 @@ namespace quinte
             return;
         }
 
-        for (uint64_t sampleIndex = 0; sampleIndex < length; ++sampleIndex)
-        {
-            m_pData[sampleIndex + offset] *= gain;
-        }
+        audio::GetKernels().ApplyGain(m_pData + offset, gain, length);
     }
 } // namespace quinte
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <Audio/Buffers/BufferView.hpp>
+#include <Audio/Kernels/Kernels.hpp>
 
 namespace quinte
 {
@@ -11,6 +12,9 @@ namespace quinte
         float* m_pData = nullptr;
 
     public:
+        //! \brief The maximum number of sources MixMany() passes to the mixing kernel at once.
+        inline static constexpr uint32_t kMixManyBatchSize = 32;
+
         inline AudioBufferView()
             : BaseBufferView(audio::DataType::Audio)
         {
@@ -32,6 +36,27 @@ namespace quinte
                          uint64_t length);
         void MixWithGain(const float* pSource, float gain, uint64_t destOffset, uint64_t length);
 
+        //! \brief Mix the source buffer applying a gain that changes linearly over the range.
+        //!
+        //! The gain of the sample at (srcOffset + i) is (gainStart + gainStep * i).
+        void MixWithGainRamp(const BaseBufferView* pSourceBuffer, float gainStart, float gainStep, uint64_t srcOffset,
+                             uint64_t destOffset, uint64_t length);
+
+        //! \brief Same as MixWithGainRamp(), but also measures the levels of the destination range in the same pass.
+        audio::BlockLevels MixWithGainRampAndMeasure(const BaseBufferView* pSourceBuffer, float gainStart, float gainStep,
+                                                     uint64_t srcOffset, uint64_t destOffset, uint64_t length);
+
+        //! \brief Mix several buffers at once, the destination is read and written only once per batch of sources.
+        //!
+        //! \param sources - The buffers to mix, the silent ones are skipped.
+        //! \param gains   - The gains to apply to the sources, empty for unity gain.
+        //! \param offset  - The offset of the range to mix, the same for the sources and the destination.
+        //! \param length  - The length of the range to mix.
+        //! \param pAccumulator - If not null, the sum is accumulated in double precision in this buffer of at least
+        //!                       length samples and rounded to float once at the end.
+        void MixMany(std::span<const AudioBufferView* const> sources, std::span<const float> gains, uint64_t offset,
+                     uint64_t length, double* pAccumulator = nullptr);
+
         void ApplyGain(float gain, uint64_t offset, uint64_t length);
 
         [[nodiscard]] inline float* Data()
@@ -0,0 +1,100 @@
+﻿#include <Audio/Buffers/DelayLine.hpp>
+#include <Audio/Ports/PortManager.hpp>
+
+namespace quinte
+{
+    DelayLine::DelayLine(uint64_t delaySampleCount)
+        : m_DelaySampleCount(delaySampleCount)
+    {
+        PortManager* pPortManager = Interface<PortManager>::Get();
+        m_Output = pPortManager->AllocateAudioBuffer();
+        m_Output.Clear();
+        m_BlockSize = m_Output.GetCapacity();
+
+        // A segment is never longer than a block, so we need to keep the delayed samples plus one block.
+        const uint64_t blockCount = (delaySampleCount + m_BlockSize - 1) / m_BlockSize + 1;
+        m_Blocks.reserve(blockCount);
+        for (uint64_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+        {
+            AudioBufferView& block = m_Blocks.emplace_back(pPortManager->AllocateAudioBuffer());
+            memory::Zero(block.Data(), m_BlockSize);
+        }
+
+        m_RingSize = blockCount * m_BlockSize;
+    }
+
+
+    DelayLine::~DelayLine()
+    {
+        PortManager* pPortManager = Interface<PortManager>::Get();
+        for (AudioBufferView& block : m_Blocks)
+            pPortManager->DeallocateAudioBuffer(block);
+
+        pPortManager->DeallocateAudioBuffer(m_Output);
+    }
+
+
+    void DelayLine::WriteRing(const float* pSource, uint64_t length)
+    {
+        while (length > 0)
+        {
+            const uint64_t blockIndex = m_WritePosition / m_BlockSize;
+            const uint64_t blockOffset = m_WritePosition % m_BlockSize;
+            const uint64_t chunkLength = Min(length, m_BlockSize - blockOffset);
+
+            float* pDestination = m_Blocks[blockIndex].Data() + blockOffset;
+            if (pSource)
+            {
+                memory::Copy(pDestination, pSource, chunkLength);
+                pSource += chunkLength;
+            }
+            else
+            {
+                memory::Zero(pDestination, chunkLength);
+            }
+
+            m_WritePosition = (m_WritePosition + chunkLength) % m_RingSize;
+            length -= chunkLength;
+        }
+    }
+
+
+    void DelayLine::ReadRing(uint64_t position, uint64_t destOffset, uint64_t length)
+    {
+        while (length > 0)
+        {
+            const uint64_t blockIndex = position / m_BlockSize;
+            const uint64_t blockOffset = position % m_BlockSize;
+            const uint64_t chunkLength = Min(length, m_BlockSize - blockOffset);
+
+            m_Output.Read(m_Blocks[blockIndex].Data() + blockOffset, destOffset, chunkLength);
+            destOffset += chunkLength;
+            position = (position + chunkLength) % m_RingSize;
+            length -= chunkLength;
+        }
+    }
+
+
+    void DelayLine::Process(const AudioBufferView* pSource, uint64_t offset, uint64_t length)
+    {
+        QU_AssertDebug(length <= m_BlockSize);
+
+        const bool sourceSilent = pSource->IsSilent();
+        if (sourceSilent && m_PendingSampleCount == 0)
+        {
+            // The whole ring contains silence, we don't even have to advance the write position.
+            m_Output.Clear(offset, length);
+            return;
+        }
+
+        const uint64_t readPosition = (m_WritePosition + m_RingSize - m_DelaySampleCount) % m_RingSize;
+        WriteRing(sourceSilent ? nullptr : pSource->Data() + offset, length);
+
+        ReadRing(readPosition, offset, length);
+
+        if (!sourceSilent)
+            m_PendingSampleCount = m_DelaySampleCount + length;
+        else
+            m_PendingSampleCount -= Min(m_PendingSampleCount, length);
+    }
+} // namespace quinte
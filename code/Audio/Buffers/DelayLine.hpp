@@ -0,0 +1,52 @@
+﻿#pragma once
+#include <Audio/Buffers/AudioBufferView.hpp>
+#include <Core/FixedVector.hpp>
+
+namespace quinte
+{
+    //! \brief A fixed delay for a single audio channel.
+    //!
+    //! The storage is a ring of blocks allocated from the PortManager's audio buffer pool,
+    //! so creating a delay line doesn't need a dedicated allocation and processing never allocates.
+    //! Must be created and destroyed on the UI thread, the same as the ports.
+    class DelayLine final : public NoCopyMove
+    {
+        SmallVector<AudioBufferView, 4> m_Blocks;
+        AudioBufferView m_Output;
+        uint64_t m_BlockSize = 0;
+        uint64_t m_RingSize = 0;
+        uint64_t m_DelaySampleCount = 0;
+        uint64_t m_WritePosition = 0;
+
+        // The number of samples until the last non-silent input sample leaves the delay line.
+        uint64_t m_PendingSampleCount = 0;
+
+        void WriteRing(const float* pSource, uint64_t length);
+        void ReadRing(uint64_t position, uint64_t destOffset, uint64_t length);
+
+    public:
+        explicit DelayLine(uint64_t delaySampleCount);
+        ~DelayLine();
+
+        [[nodiscard]] inline uint64_t GetDelaySampleCount() const
+        {
+            return m_DelaySampleCount;
+        }
+
+        //! \brief Check if the delay line still contains non-silent samples.
+        [[nodiscard]] inline bool HasPendingSamples() const
+        {
+            return m_PendingSampleCount > 0;
+        }
+
+        //! \brief The buffer that contains the delayed signal after Process() was called.
+        [[nodiscard]] inline const AudioBufferView* GetOutput() const
+        {
+            return &m_Output;
+        }
+
+        //! \brief Push the range [offset, offset + length) of the source buffer to the delay line
+        //!        and write the delayed samples to the same range of the output buffer.
+        void Process(const AudioBufferView* pSource, uint64_t offset, uint64_t length);
+    };
+} // namespace quinte
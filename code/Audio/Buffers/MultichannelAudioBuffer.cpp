@@ -0,0 +1,149 @@
+﻿#include <Audio/Buffers/AudioBufferView.hpp>
+#include <Audio/Buffers/MultichannelAudioBuffer.hpp>
+#include <Audio/Kernels/Kernels.hpp>
+
+namespace quinte
+{
+    MultichannelAudioBuffer::MultichannelAudioBuffer(uint32_t channelCount, uint64_t capacity)
+    {
+        Resize(channelCount, capacity);
+    }
+
+
+    MultichannelAudioBuffer::~MultichannelAudioBuffer()
+    {
+        memory::SafeFree(m_pData);
+    }
+
+
+    void MultichannelAudioBuffer::Resize(uint32_t channelCount, uint64_t capacity)
+    {
+        QU_Assert(channelCount <= kMaxChannelCount);
+        memory::SafeFree(m_pData);
+
+        m_ChannelCount = channelCount;
+        m_Capacity = capacity;
+        m_Stride = AlignUp(capacity, kDataAlignment / sizeof(float));
+        m_SilentMask = GetAllChannelsMask();
+
+        const uint64_t totalSampleCount = m_Stride * channelCount;
+        if (totalSampleCount > 0)
+        {
+            m_pData = memory::DefaultAlloc<float>(totalSampleCount * sizeof(float), kDataAlignment);
+            memory::Zero(m_pData, totalSampleCount);
+        }
+    }
+
+
+    void MultichannelAudioBuffer::Clear(uint64_t offset, uint64_t length)
+    {
+        for (uint32_t channelIndex = 0; channelIndex < m_ChannelCount; ++channelIndex)
+            ClearChannel(channelIndex, offset, length);
+    }
+
+
+    void MultichannelAudioBuffer::Clear()
+    {
+        Clear(0, m_Capacity);
+    }
+
+
+    void MultichannelAudioBuffer::ClearChannel(uint32_t channelIndex, uint64_t offset, uint64_t length)
+    {
+        QU_Assert(offset + length <= m_Capacity);
+        if (IsChannelSilent(channelIndex))
+            return;
+
+        memory::Zero(m_pData + channelIndex * m_Stride + offset, length);
+        if (length == m_Capacity)
+            m_SilentMask |= uint64_t{ 1 } << channelIndex;
+    }
+
+
+    void MultichannelAudioBuffer::ReadChannel(uint32_t channelIndex, AudioBufferView* pDestination, uint64_t srcOffset,
+                                              uint64_t destOffset, uint64_t length) const
+    {
+        QU_Assert(srcOffset + length <= m_Capacity);
+
+        if (IsChannelSilent(channelIndex))
+            pDestination->Clear(destOffset, length);
+        else
+            pDestination->Read(GetChannelData(channelIndex) + srcOffset, destOffset, length);
+    }
+
+
+    void MultichannelAudioBuffer::WriteChannel(uint32_t channelIndex, const AudioBufferView* pSource, uint64_t srcOffset,
+                                               uint64_t destOffset, uint64_t length)
+    {
+        QU_Assert(destOffset + length <= m_Capacity);
+        QU_Assert(srcOffset + length <= pSource->GetCapacity());
+
+        if (pSource->IsSilent())
+        {
+            ClearChannel(channelIndex, destOffset, length);
+            return;
+        }
+
+        memory::Copy(GetChannelData(channelIndex) + destOffset, pSource->Data() + srcOffset, length);
+    }
+
+
+    void MultichannelAudioBuffer::Mix(const MultichannelAudioBuffer* pSourceBuffer, uint64_t srcOffset, uint64_t destOffset,
+                                      uint64_t length)
+    {
+        QU_Assert(this != pSourceBuffer);
+        QU_Assert(pSourceBuffer->GetChannelCount() == m_ChannelCount);
+        QU_Assert(destOffset + length <= m_Capacity);
+        QU_Assert(srcOffset + length <= pSourceBuffer->GetCapacity());
+
+        const audio::KernelTable& kernels = audio::GetKernels();
+        for (uint32_t channelIndex = 0; channelIndex < m_ChannelCount; ++channelIndex)
+        {
+            if (pSourceBuffer->IsChannelSilent(channelIndex))
+                continue;
+
+            const float* pSource = pSourceBuffer->GetChannelData(channelIndex) + srcOffset;
+            kernels.Mix(GetChannelData(channelIndex) + destOffset, pSource, length);
+        }
+    }
+
+
+    void MultichannelAudioBuffer::MixWithGain(const MultichannelAudioBuffer* pSourceBuffer, std::span<const float> channelGains,
+                                              uint64_t srcOffset, uint64_t destOffset, uint64_t length)
+    {
+        QU_Assert(this != pSourceBuffer);
+        QU_Assert(pSourceBuffer->GetChannelCount() == m_ChannelCount);
+        QU_Assert(channelGains.size() == m_ChannelCount);
+        QU_Assert(destOffset + length <= m_Capacity);
+        QU_Assert(srcOffset + length <= pSourceBuffer->GetCapacity());
+
+        const audio::KernelTable& kernels = audio::GetKernels();
+        for (uint32_t channelIndex = 0; channelIndex < m_ChannelCount; ++channelIndex)
+        {
+            if (pSourceBuffer->IsChannelSilent(channelIndex) || channelGains[channelIndex] == 0.0f)
+                continue;
+
+            const float* pSource = pSourceBuffer->GetChannelData(channelIndex) + srcOffset;
+            kernels.MixWithGain(GetChannelData(channelIndex) + destOffset, pSource, channelGains[channelIndex], length);
+        }
+    }
+
+
+    void MultichannelAudioBuffer::ApplyGain(float gain, uint64_t offset, uint64_t length)
+    {
+        QU_Assert(offset + length <= m_Capacity);
+
+        if (gain == 0.0f)
+        {
+            Clear(offset, length);
+            return;
+        }
+
+        const audio::KernelTable& kernels = audio::GetKernels();
+        for (uint32_t channelIndex = 0; channelIndex < m_ChannelCount; ++channelIndex)
+        {
+            if (!IsChannelSilent(channelIndex))
+                kernels.ApplyGain(m_pData + channelIndex * m_Stride + offset, gain, length);
+        }
+    }
+} // namespace quinte
@@ -0,0 +1,112 @@
+﻿#pragma once
+#include <Audio/Buffers/BufferView.hpp>
+
+namespace quinte
+{
+    class AudioBufferView;
+
+
+    //! \brief A planar audio buffer that stores all the channels in a single allocation.
+    //!
+    //! Every channel starts at a cache line boundary: the channels are GetStride() samples apart,
+    //! so processing one channel never touches the cache lines of another one.
+    //! The silent flags are tracked per channel in a bit mask, a silent channel is always zeroed.
+    class MultichannelAudioBuffer final : public memory::RefCountedObjectBase
+    {
+        float* m_pData = nullptr;
+        uint64_t m_Capacity = 0;
+        uint64_t m_Stride = 0;
+        uint64_t m_SilentMask = 0;
+        uint32_t m_ChannelCount = 0;
+
+        [[nodiscard]] inline uint64_t GetAllChannelsMask() const
+        {
+            return m_ChannelCount == kMaxChannelCount ? ~uint64_t{ 0 } : (uint64_t{ 1 } << m_ChannelCount) - 1;
+        }
+
+    public:
+        inline static constexpr size_t kDataAlignment = BaseBufferView::kDataAlignment;
+        inline static constexpr uint32_t kMaxChannelCount = 64;
+
+        MultichannelAudioBuffer(uint32_t channelCount, uint64_t capacity);
+        ~MultichannelAudioBuffer() override;
+
+        //! \brief Reallocate the storage, the contents are cleared.
+        void Resize(uint32_t channelCount, uint64_t capacity);
+
+        [[nodiscard]] inline uint32_t GetChannelCount() const
+        {
+            return m_ChannelCount;
+        }
+
+        //! \brief Get the number of samples in a channel.
+        [[nodiscard]] inline uint64_t GetCapacity() const
+        {
+            return m_Capacity;
+        }
+
+        //! \brief Get the distance between the first samples of the adjacent channels, in samples.
+        [[nodiscard]] inline uint64_t GetStride() const
+        {
+            return m_Stride;
+        }
+
+        [[nodiscard]] inline uint64_t GetSilentMask() const
+        {
+            return m_SilentMask;
+        }
+
+        [[nodiscard]] inline bool IsChannelSilent(uint32_t channelIndex) const
+        {
+            QU_AssertDebug(channelIndex < m_ChannelCount);
+            return (m_SilentMask >> channelIndex) & 1;
+        }
+
+        //! \brief Check if all the channels are silent.
+        [[nodiscard]] inline bool IsSilent() const
+        {
+            return m_SilentMask == GetAllChannelsMask();
+        }
+
+        //! \brief Get the samples of a channel for writing, the channel is no longer considered silent.
+        [[nodiscard]] inline float* GetChannelData(uint32_t channelIndex)
+        {
+            QU_AssertDebug(channelIndex < m_ChannelCount);
+            m_SilentMask &= ~(uint64_t{ 1 } << channelIndex);
+            return std::assume_aligned<kDataAlignment>(m_pData + channelIndex * m_Stride);
+        }
+
+        [[nodiscard]] inline const float* GetChannelData(uint32_t channelIndex) const
+        {
+            QU_AssertDebug(channelIndex < m_ChannelCount);
+            return std::assume_aligned<kDataAlignment>(m_pData + channelIndex * m_Stride);
+        }
+
+        //! \brief Clear all the channels in the range [offset, offset + length).
+        void Clear(uint64_t offset, uint64_t length);
+
+        //! \brief Clear the entire buffer.
+        void Clear();
+
+        //! \brief Clear a single channel in the range [offset, offset + length).
+        void ClearChannel(uint32_t channelIndex, uint64_t offset, uint64_t length);
+
+        //! \brief Copy the channel samples to a mono buffer.
+        void ReadChannel(uint32_t channelIndex, AudioBufferView* pDestination, uint64_t srcOffset, uint64_t destOffset,
+                         uint64_t length) const;
+
+        //! \brief Overwrite the channel samples with the contents of a mono buffer.
+        void WriteChannel(uint32_t channelIndex, const AudioBufferView* pSource, uint64_t srcOffset, uint64_t destOffset,
+                          uint64_t length);
+
+        //! \brief Mix (add) all the channels of another buffer with the same channel count.
+        void Mix(const MultichannelAudioBuffer* pSourceBuffer, uint64_t srcOffset, uint64_t destOffset, uint64_t length);
+
+        //! \brief Mix all the channels of another buffer applying a separate gain to each of them.
+        void MixWithGain(const MultichannelAudioBuffer* pSourceBuffer, std::span<const float> channelGains, uint64_t srcOffset,
+                         uint64_t destOffset, uint64_t length);
+
+        //! \brief Apply the gain to all the channels in the range [offset, offset + length).
+        void ApplyGain(float gain, uint64_t offset, uint64_t length);
+    };
+} // namespace quinte
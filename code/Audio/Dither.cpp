@@ -0,0 +1,153 @@
+﻿#include <Audio/Dither.hpp>
+#include <cmath>
+
+namespace quinte::audio
+{
+    namespace
+    {
+        struct NoiseShapingFilter final
+        {
+            uint32_t Order;
+            float Coefficients[5];
+        };
+
+
+        // The error of the sample n - k - 1 is multiplied by Coefficients[k] and subtracted from the sample n.
+        // The noise transfer function is 1 - sum(Coefficients[k] * z^-(k + 1)).
+        constexpr NoiseShapingFilter kNoiseShapingFilters[] = {
+            { 0, {} },
+            { 1, { 1.0f } },
+            { 5, { 2.033f, -2.165f, 1.959f, -1.590f, 0.6149f } },
+        };
+
+
+        // MurmurHash3 finalizer, spreads the seed so that the generators of all the lanes and channels are unrelated.
+        inline uint32_t HashGeneratorSeed(uint32_t value)
+        {
+            value ^= value >> 16;
+            value *= 0x85ebca6b;
+            value ^= value >> 13;
+            value *= 0xc2b2ae35;
+            value ^= value >> 16;
+            return value;
+        }
+
+
+        inline uint32_t GetFormatBitDepth(Format format)
+        {
+            switch (format)
+            {
+            case Format::Int8:
+                return 8;
+            case Format::Int16:
+                return 16;
+            case Format::Int24:
+                return 24;
+            case Format::Int32:
+            case Format::Float32:
+                return 32;
+            case Format::Float64:
+                return 64;
+            default:
+                return 0;
+            }
+        }
+    } // namespace
+
+
+    void Ditherer::Initialize(uint32_t channelCount, uint32_t bitDepth, NoiseShaping noiseShaping, uint32_t seed)
+    {
+        QU_Assert(channelCount > 0);
+        QU_Assert(bitDepth > 1 && bitDepth <= 24);
+
+        m_Channels.resize(channelCount);
+        m_NoiseShaping = noiseShaping;
+        m_BitDepth = bitDepth;
+        m_Seed = seed;
+        Reset();
+    }
+
+
+    void Ditherer::Reset()
+    {
+        uint32_t generatorIndex = 0;
+        for (ChannelState& channel : m_Channels)
+        {
+            // Xorshift generators must never be in the zero state.
+            for (uint32_t& generator : channel.Generators)
+                generator = Max(HashGeneratorSeed(m_Seed * kNoiseLaneCount * GetChannelCount() + generatorIndex++), 1u);
+
+            channel.NoisePosition = kNoiseBufferSize;
+            memory::Zero(channel.Errors, kMaxFilterOrder);
+        }
+    }
+
+
+    void Ditherer::Process(uint32_t channelIndex, float* pDestination, const float* pSource, uint32_t sampleCount)
+    {
+        QU_AssertDebug(channelIndex < m_Channels.size());
+
+        const KernelTable& kernels = GetKernels();
+        const NoiseShapingFilter& filter = kNoiseShapingFilters[enum_cast(m_NoiseShaping)];
+        const float scale = static_cast<float>(1 << (m_BitDepth - 1));
+        const float inverseScale = 1.0f / scale;
+
+        ChannelState& channel = m_Channels[channelIndex];
+        uint32_t offset = 0;
+        while (offset < sampleCount)
+        {
+            if (channel.NoisePosition == kNoiseBufferSize)
+            {
+                kernels.TriangularNoise(channel.Noise, channel.Generators, kNoiseBufferSize);
+                channel.NoisePosition = 0;
+            }
+
+            const uint32_t length = Min(sampleCount - offset, kNoiseBufferSize - channel.NoisePosition);
+            const float* pNoise = channel.Noise + channel.NoisePosition;
+            const float* pChunkSource = pSource + offset;
+            float* pChunkDestination = pDestination + offset;
+
+            if (filter.Order == 0)
+            {
+                // Without the feedback the rounding is left to the integer conversion, so this loop can be vectorized.
+                for (uint32_t sampleIndex = 0; sampleIndex < length; ++sampleIndex)
+                    pChunkDestination[sampleIndex] = pChunkSource[sampleIndex] + pNoise[sampleIndex] * inverseScale;
+            }
+            else
+            {
+                float errors[kMaxFilterOrder];
+                memory::Copy(errors, channel.Errors, kMaxFilterOrder);
+
+                for (uint32_t sampleIndex = 0; sampleIndex < length; ++sampleIndex)
+                {
+                    float value = pChunkSource[sampleIndex] * scale;
+                    for (uint32_t tapIndex = 0; tapIndex < filter.Order; ++tapIndex)
+                        value -= filter.Coefficients[tapIndex] * errors[tapIndex];
+
+                    // The error is taken before clamping, so the feedback stays bounded when the signal clips.
+                    const float quantized = std::nearbyint(value + pNoise[sampleIndex]);
+                    for (uint32_t tapIndex = kMaxFilterOrder - 1; tapIndex > 0; --tapIndex)
+                        errors[tapIndex] = errors[tapIndex - 1];
+
+                    errors[0] = quantized - value;
+                    pChunkDestination[sampleIndex] = quantized * inverseScale;
+                }
+
+                memory::Copy(channel.Errors, errors, kMaxFilterOrder);
+            }
+
+            channel.NoisePosition += length;
+            offset += length;
+        }
+    }
+
+
+    uint32_t GetDitherBitDepth(Format sourceFormat, Format targetFormat)
+    {
+        const uint32_t targetBitDepth = GetFormatBitDepth(targetFormat);
+        if (targetBitDepth > 24)
+            return 0;
+
+        return GetFormatBitDepth(sourceFormat) > targetBitDepth ? targetBitDepth : 0;
+    }
+} // namespace quinte::audio
@@ -0,0 +1,83 @@
+﻿#pragma once
+#include <Audio/Base.hpp>
+#include <Audio/Kernels/Kernels.hpp>
+
+namespace quinte::audio
+{
+    //! \brief The filter applied to the quantization error of the dithered signal.
+    enum class NoiseShaping : uint32_t
+    {
+        None,       //!< Flat TPDF dither, the noise is white.
+        FirstOrder, //!< The noise rises by 6 dB per octave, less audible but louder in total.
+        Lipshitz,   //!< The 5-tap E-weighted filter by Lipshitz et al., moves the noise to where the ear is least sensitive.
+    };
+
+
+    //! \brief Adds triangular (TPDF) dither to a signal that is going to be quantized to integers.
+    //!
+    //! The dither is 2 LSB peak-to-peak, which removes the distortion and the noise modulation of the quantization.
+    //! With noise shaping, the quantization error of the previous samples is filtered and fed back, so the
+    //! result is quantized here, and every output sample is a multiple of the LSB.
+    //!
+    //! The output is still in float with full scale at 1.0: it must be rounded and clamped by the integer
+    //! conversion, e.g. KernelTable::FloatToInt16. The noise is generated by the TriangularNoise kernel,
+    //! every channel has its own generators and error history.
+    class Ditherer final : public NoCopyMove
+    {
+        inline static constexpr uint32_t kNoiseBufferSize = 256;
+        inline static constexpr uint32_t kMaxFilterOrder = 5;
+
+        static_assert(kNoiseBufferSize % kNoiseLaneCount == 0);
+
+        struct ChannelState final
+        {
+            uint32_t Generators[kNoiseLaneCount];
+            float Noise[kNoiseBufferSize];
+            uint32_t NoisePosition;
+            float Errors[kMaxFilterOrder];
+        };
+
+        std::pmr::vector<ChannelState> m_Channels;
+        NoiseShaping m_NoiseShaping = NoiseShaping::None;
+        uint32_t m_BitDepth = 0;
+        uint32_t m_Seed = 0;
+
+    public:
+        //! \brief Set up the ditherer and reset the state.
+        //!
+        //! \param channelCount - The number of channels to dither.
+        //! \param bitDepth     - The bit depth of the quantized output, up to 24 bits.
+        //! \param noiseShaping - The noise shaping filter.
+        //! \param seed         - The seed of the generators, the output is deterministic for a given seed.
+        void Initialize(uint32_t channelCount, uint32_t bitDepth, NoiseShaping noiseShaping, uint32_t seed = 1);
+
+        //! \brief Restart the generators and clear the error history.
+        void Reset();
+
+        //! \brief Dither a block of samples of a single channel.
+        //!
+        //! The source and the destination can be the same buffer.
+        void Process(uint32_t channelIndex, float* pDestination, const float* pSource, uint32_t sampleCount);
+
+        [[nodiscard]] inline uint32_t GetChannelCount() const
+        {
+            return static_cast<uint32_t>(m_Channels.size());
+        }
+
+        [[nodiscard]] inline uint32_t GetBitDepth() const
+        {
+            return m_BitDepth;
+        }
+
+        [[nodiscard]] inline NoiseShaping GetNoiseShaping() const
+        {
+            return m_NoiseShaping;
+        }
+    };
+
+
+    //! \brief Get the bit depth of the integer format that should be dithered when converting from another format.
+    //!
+    //! \return Zero if no dither is needed, e.g. the target is a float or the source is not wider than the target.
+    uint32_t GetDitherBitDepth(Format sourceFormat, Format targetFormat);
+} // namespace quinte::audio
@@ -1,11 +1,74 @@
-﻿#include <Audio/Backend/WASAPI.hpp>
+﻿#include <Audio/Backend/Dummy.hpp>
+#include <Audio/Backend/Offline.hpp>
+#include <Audio/Backend/WASAPI.hpp>
 #include <Audio/Engine.hpp>
+#include <Audio/Kernels/Denormals.hpp>
+#include <Audio/Kernels/Kernels.hpp>
 #include <Audio/Ports/PortManager.hpp>
+#include <Audio/Prerenderer.hpp>
+#include <Audio/Resampler.hpp>
+#include <Audio/Session.hpp>
+#include <Audio/Sinks/AudioSink.hpp>
+#include <Audio/StemExporter.hpp>
 #include <Audio/Transport.hpp>
+#include <Core/Memory/TempAllocator.hpp>
 #include <Graph/ExecutionGraph.hpp>
+#include <Graph/GraphWorkerPool.hpp>
 
 namespace quinte
 {
+    namespace
+    {
+        inline void DeleteGraph(ExecutionGraph* pGraph)
+        {
+            if (pGraph)
+                memory::DefaultDelete(pGraph);
+        }
+    } // namespace
+
+
+    namespace audio
+    {
+        TimePos64 SplitCycle(TimePos64 playhead, uint32_t frameCount, TimeRange64 loopRange, bool rolling,
+                             CycleSegmentList& segments)
+        {
+            QU_AssertDebug(segments.size() == 0);
+
+            const uint64_t loopStart = loopRange.GetFirstSampleIndex();
+            const uint64_t loopEnd = loopRange.GetLastSampleIndex();
+            const bool looping = rolling && loopRange.Length > 0;
+
+            uint32_t offset = 0;
+            while (offset < frameCount)
+            {
+                const uint64_t position = playhead.GetSampleIndex();
+                const bool lastSegment = segments.size() + 1 == kMaxSegmentsPerCycle;
+                const bool crossesLoopEnd = looping && position < loopEnd && position + (frameCount - offset) >= loopEnd;
+
+                // Once we reach the limit, the rest of the cycle is processed as a single segment.
+                uint32_t length = frameCount - offset;
+                if (crossesLoopEnd && !lastSegment)
+                    length = static_cast<uint32_t>(loopEnd - position);
+
+                segments.push_back(EngineProcessInfo{
+                    .StartTime = playhead - TimePos64{ offset },
+                    .LocalRange = { offset, length },
+                });
+
+                offset += length;
+
+                // The last segment can run over the loop end many times if the loop is only a few samples long.
+                if (crossesLoopEnd)
+                    playhead = TimePos64{ loopStart + (position + length - loopEnd) % loopRange.GetLengthInSamples() };
+                else if (rolling)
+                    playhead = playhead + TimePos64{ length };
+            }
+
+            return playhead;
+        }
+    } // namespace audio
+
+
     audio::CallbackResult AudioEngine::AudioCallbackImpl(void* pOutputBuffer, void* pInputBuffer, uint32_t frameCount,
                                                          double streamTime, audio::StreamStatus status, void* pUserData)
     {
@@ -13,6 +76,100 @@ namespace quinte
     }
 
 
+    void AudioEngine::AcquirePendingGraph()
+    {
+        if (m_pPendingGraph.load(std::memory_order_relaxed) == nullptr)
+            return;
+
+        // We can't retire the active graph until the UI thread has collected the previous one,
+        // in this case the new graph will be picked up later.
+        if (m_pRetiredGraph.load(std::memory_order_acquire) != nullptr)
+            return;
+
+        // The UI thread deletes the retired graph, so no worker must reference it anymore. GraphWorkerPool::Execute()
+        // waits for the workers to leave before returning, so this only fails if the pool is misused.
+        if (m_WorkerPool && !m_WorkerPool->IsIdle()) [[unlikely]]
+        {
+            QU_AssertDebugMsg(false, "Graph workers are still running between the cycles");
+            return;
+        }
+
+        ExecutionGraph* pNewGraph = m_pPendingGraph.exchange(nullptr, std::memory_order_acq_rel);
+        if (pNewGraph == nullptr)
+            return;
+
+        m_pRetiredGraph.store(m_pActiveGraph, std::memory_order_release);
+        m_pActiveGraph = pNewGraph;
+    }
+
+
+    void AudioEngine::DestroyGraphs()
+    {
+        DeleteGraph(m_pActiveGraph);
+        DeleteGraph(m_pPendingGraph.exchange(nullptr));
+        DeleteGraph(m_pRetiredGraph.exchange(nullptr));
+        m_pActiveGraph = nullptr;
+    }
+
+
+    audio::TimePos64 AudioEngine::RunSegments(audio::TimePos64 playhead, uint32_t frameCount)
+    {
+        const Transport* pTransport = Interface<Transport>::Get();
+        const bool rolling = pTransport->IsActuallyRolling();
+        const bool looping = rolling && pTransport->m_LoopEnabled;
+
+        audio::CycleSegmentList segments;
+        const audio::TimeRange64 loopRange = looping ? pTransport->m_LoopRange : audio::TimeRange64{};
+        playhead = audio::SplitCycle(playhead, frameCount, loopRange, rolling, segments);
+        for (const audio::EngineProcessInfo& processInfo : segments)
+            m_pActiveGraph->Run(processInfo, m_WorkerPool.get());
+
+        return playhead;
+    }
+
+
+    void AudioEngine::UpdateStats(float cycleTime, uint32_t frameCount)
+    {
+        const float cycleBudget = 1e6f * static_cast<float>(frameCount) / static_cast<float>(m_SampleRate);
+        m_CycleBudgetSum += cycleBudget;
+        m_PeakDSPLoad = Max(m_PeakDSPLoad, cycleTime / cycleBudget);
+
+        if (!m_CycleTiming.Add(cycleTime))
+            return;
+
+        audio::EngineStats stats;
+        stats.DSPLoad = m_CycleTiming.GetSum() / m_CycleBudgetSum;
+        stats.PeakDSPLoad = m_PeakDSPLoad;
+        stats.CycleTime = m_CycleTiming.GetStats();
+        stats.DenormalCount = m_DenormalCount;
+        m_Stats.Store(stats);
+
+        m_CycleTiming.Reset();
+        m_CycleBudgetSum = 0.0f;
+        m_PeakDSPLoad = 0.0f;
+        m_DenormalCount = 0;
+    }
+
+
+    void AudioEngine::UpdateLoudness(uint32_t frameCount)
+    {
+        if (m_LoudnessResetRequested.exchange(false, std::memory_order_acq_rel))
+        {
+            m_LoudnessMeter.Reset();
+            m_LoudnessStats.Store({});
+        }
+
+        const StereoPorts& masterPorts = Interface<Session>::Get()->GetMasterOutputPorts();
+        const float* channels[] = {
+            masterPorts.Left->GetBufferView()->Data(),
+            masterPorts.Right->GetBufferView()->Data(),
+        };
+
+        if (m_LoudnessMeter.Process(channels, frameCount))
+            m_LoudnessStats.Store(m_LoudnessMeter.GetStats());
+    }
+
+
     audio::CallbackResult AudioEngine::AudioCallback(void* pOutputBuffer, void* pInputBuffer, uint32_t frameCount,
                                                      double streamTime, audio::StreamStatus status)
     {
@@ -25,6 +182,17 @@ namespace quinte
             return audio::CallbackResult::OK;
         }
 
+        // The callback thread can be owned by the driver, so we restore its floating-point mode when we return.
+        const audio::ScopedDisableDenormals disableDenormals;
+
+        const audio::TelemetryClock::time_point cycleStartTime = audio::TelemetryClock::now();
+        QU_Defer
+        {
+            UpdateStats(audio::GetElapsedMicroseconds(cycleStartTime, audio::TelemetryClock::now()), frameCount);
+        };
+
+        AcquirePendingGraph();
+
         Transport* pTransport = Interface<Transport>::Get();
         PortManager* pPortManager = Interface<PortManager>::Get();
         pTransport->m_Playhead = pTransport->m_PlayheadRequest;
@@ -45,18 +213,23 @@ namespace quinte
             }
         }
 
-        QU_Defer
-        {
-            if (pTransport->IsActuallyRolling())
-                pTransport->AddToPlayhead(frameCount);
-        };
+        pTransport->AcquireLoop();
 
         const StereoPorts& monitorPorts = pPortManager->GetMonitorPorts();
         monitorPorts.Left->GetBufferView()->Clear();
         monitorPorts.Right->GetBufferView()->Clear();
 
-        const audio::EngineProcessInfo processInfo{ .StartTime = pTransport->m_Playhead, .LocalRange = { 0, frameCount } };
-        m_Graph->Run(processInfo);
+        const audio::TimePos64 cycleStartPos = pTransport->m_Playhead;
+        const audio::TimePos64 cycleEndPos = RunSegments(cycleStartPos, frameCount);
+        if (pTransport->IsActuallyRolling())
+        {
+            pTransport->AdvancePlayhead(cycleStartPos, cycleEndPos);
+            UpdateLoudness(frameCount);
+        }
+
+#if QU_DEBUG
+        m_DenormalCount += m_pActiveGraph->CountDenormals(frameCount);
+#endif
 
         const std::span<const Rc<AudioPort>> hardwarePorts = pPortManager->GetHardwarePorts();
         for (uint32_t channelIndex = 0; channelIndex < hardwarePorts.size(); ++channelIndex)
@@ -75,8 +248,57 @@ namespace quinte
     }
 
 
-    AudioEngine::AudioEngine() = default;
-    AudioEngine::~AudioEngine() = default;
+    void AudioEngine::SetupPrerenderBuffers(bool enable)
+    {
+        if (enable)
+        {
+            // The buffer size could have changed since the last start, the stream is not processed yet,
+            // so the buffers can be safely replaced.
+            m_Prerenderer = memory::make_unique<Prerenderer>();
+            CreatePrerenderBuffers(true);
+            return;
+        }
+
+        for (const TrackInfo& trackInfo : Interface<Session>::Get()->GetTrackList())
+            trackInfo.pTrack->DestroyPrerenderBuffer();
+    }
+
+
+    void AudioEngine::CreatePrerenderBuffers(bool recreate)
+    {
+        const size_t blockSize = m_Impl->GetAudioBufferSize();
+        for (const TrackInfo& trackInfo : Interface<Session>::Get()->GetTrackList())
+        {
+            if (recreate || trackInfo.pTrack->GetPrerenderBuffer() == nullptr)
+                trackInfo.pTrack->CreatePrerenderBuffer(blockSize, m_Prerenderer->GetSignal());
+        }
+    }
+
+
+    void AudioEngine::UpdatePrerenderTracks()
+    {
+        if (!m_Prerenderer)
+            return;
+
+        memory::TempAllocatorScope temp;
+        std::pmr::vector<Rc<Track>> tracks{ &temp };
+        for (const TrackInfo& trackInfo : Interface<Session>::Get()->GetTrackList())
+            tracks.push_back(trackInfo.pTrack);
+
+        m_Prerenderer->SetTracks(tracks);
+    }
+
+
+    AudioEngine::AudioEngine()
+    {
+        audio::SelectKernels(audio::DetectKernelISA());
+    }
+
+
+    AudioEngine::~AudioEngine()
+    {
+        DestroyGraphs();
+    }
 
 
     audio::ResultCode AudioEngine::InitializeAPI(audio::APIKind apiKind)
@@ -86,6 +308,12 @@ namespace quinte
         case audio::APIKind::WASAPI:
             m_Impl = memory::make_unique<AudioBackendWASAPI>();
             return m_Impl->UpdateDeviceList();
+        case audio::APIKind::Offline:
+            m_Impl = memory::make_unique<AudioBackendOffline>();
+            return m_Impl->UpdateDeviceList();
+        case audio::APIKind::Dummy:
+            m_Impl = memory::make_unique<AudioBackendDummy>();
+            return m_Impl->UpdateDeviceList();
         default:
             return audio::ResultCode::FailUnsupportedAPI;
         }
@@ -118,14 +346,42 @@ namespace quinte
         if (audio::Failed(openResult))
             return openResult;
 
+        // The buffer size is known now, switch to the kernels unrolled for it before the callback starts.
+        audio::SelectKernels(audio::GetKernels().ISA, static_cast<uint32_t>(m_Impl->GetAudioBufferSize()));
+
         const audio::ResultCode startResult = m_Impl->StartStream();
         if (audio::Failed(startResult))
             return startResult;
 
+        m_SampleRate = m_Impl->GetSampleRate();
+        m_CycleTiming.Reset();
+        m_CycleBudgetSum = 0.0f;
+        m_PeakDSPLoad = 0.0f;
+        m_DenormalCount = 0;
+        m_Stats.Store({});
+
+        m_LoudnessMeter.Initialize(m_SampleRate);
+        m_LoudnessResetRequested.store(false);
+        m_LoudnessStats.Store({});
+
         EventBus<AudioEngineEvents>::SendEvent(&AudioEngineEvents::OnAudioStreamStarted);
 
-        m_Graph = memory::make_unique<ExecutionGraph>();
-        m_Graph->Build();
+        // The audio callback thread is a worker too, so we leave one processor for it.
+        const uint32_t processorCount = threading::GetProcessorCount();
+        m_WorkerPool = memory::make_unique<GraphWorkerPool>(processorCount > 1 ? processorCount - 1 : 0);
+
+        // The offline renderer reads the clips faster than a background thread could pre-render them.
+        SetupPrerenderBuffers(m_Impl->GetKind() != audio::APIKind::Offline);
+
+        m_pActiveGraph = memory::DefaultNew<ExecutionGraph>();
+        const audio::ResultCode buildResult = m_pActiveGraph->Build(m_WorkerPool->GetWorkerCount());
+        if (audio::Failed(buildResult))
+        {
+            Stop();
+            return buildResult;
+        }
+
+        UpdatePrerenderTracks();
 
         m_Running.store(true);
 
@@ -140,7 +396,159 @@ namespace quinte
 
         m_Running.store(false);
         m_Impl->CloseStream();
-        m_Graph.reset();
+        m_Prerenderer.reset();
+        DestroyGraphs();
+        m_WorkerPool.reset();
         EventBus<AudioEngineEvents>::SendEvent(&AudioEngineEvents::OnAudioStreamStopped);
     }
+
+
+    void AudioEngine::SetResamplerQuality(audio::ResamplerQuality quality)
+    {
+        // The clip sources are shared with the playlist snapshots, so the change applies to them as well.
+        for (const TrackInfo& trackInfo : Interface<Session>::Get()->GetTrackList())
+        {
+            for (const AudioClip& clip : trackInfo.pTrack->GetPlaylist())
+                clip.GetSource()->SetQuality(quality);
+        }
+    }
+
+
+    audio::ResultCode AudioEngine::BeginOfflineRender(audio::TimeRange64 range, bool& loopEnabled)
+    {
+        if (!m_Running.load())
+            return audio::ResultCode::FailStreamNotRunning;
+
+        if (m_Impl->GetKind() != audio::APIKind::Offline)
+            return audio::ResultCode::FailUnsupportedAPI;
+
+        // There's no audio thread in offline mode, the cycles are run on the calling thread,
+        // so we can pick up the latest graph right away.
+        CollectRetiredGraphs();
+        AcquirePendingGraph();
+
+        // The render is not limited by the real-time budget, so the clips are converted with the best filter.
+        SetResamplerQuality(audio::ResamplerQuality::Best);
+
+        Transport* pTransport = Interface<Transport>::Get();
+        loopEnabled = pTransport->IsLoopEnabled();
+        pTransport->SetLoopEnabled(false);
+        pTransport->SetPlayhead(range.GetFirstSampleIndex());
+        pTransport->RequestRoll();
+
+        ResetLoudness();
+        return audio::ResultCode::Success;
+    }
+
+
+    void AudioEngine::EndOfflineRender(bool loopEnabled)
+    {
+        // There's no audio thread that would apply a pause request, so we stop the transport directly.
+        Transport* pTransport = Interface<Transport>::Get();
+        pTransport->m_PlayState.store(audio::PlayState::Paused);
+        pTransport->SetLoopEnabled(loopEnabled);
+
+        SetResamplerQuality(audio::ResamplerQuality::Draft);
+    }
+
+
+    audio::ResultCode AudioEngine::RenderOffline(audio::TimeRange64 range, AudioSink* pSink)
+    {
+        if (range.GetLengthInSamples() == 0)
+            return pSink->Finalize();
+
+        bool loopEnabled;
+        const audio::ResultCode beginResult = BeginOfflineRender(range, loopEnabled);
+        if (audio::Failed(beginResult))
+            return beginResult;
+
+        AudioBackendOffline* pBackend = static_cast<AudioBackendOffline*>(m_Impl.get());
+        const uint32_t bufferSize = static_cast<uint32_t>(m_Impl->GetAudioBufferSize());
+        audio::ResultCode result = audio::ResultCode::Success;
+
+        // The same as for the stems: the master output is delayed by the latency of the graph,
+        // so we render past the end of the range and skip the beginning.
+        audio::LatencyCompensator compensator{ range.GetLengthInSamples(), m_pActiveGraph->GetOutputLatency() };
+
+        // The cycles are run back to back on this thread, the worker pool spreads the graph across all the cores.
+        while (compensator.GetPendingFrameCount() > 0)
+        {
+            const uint32_t frameCount = static_cast<uint32_t>(Min<uint64_t>(compensator.GetPendingFrameCount(), bufferSize));
+            pBackend->ProcessCycle(frameCount);
+
+            const audio::TimeRange32 outputRange = compensator.Advance(frameCount);
+            if (outputRange.Length == 0)
+                continue;
+
+            const float* pOutput = pBackend->GetOutputBuffer() + outputRange.GetFirstSampleIndex();
+            const float* channels[] = { pOutput, pOutput + frameCount };
+            result = pSink->Write(channels, outputRange.Length);
+            if (audio::Failed(result))
+                break;
+        }
+
+        EndOfflineRender(loopEnabled);
+
+        const audio::ResultCode finalizeResult = pSink->Finalize();
+        return audio::Failed(result) ? result : finalizeResult;
+    }
+
+
+    audio::ResultCode AudioEngine::RenderStems(audio::TimeRange64 range, std::span<const audio::StemDesc> stems)
+    {
+        bool loopEnabled;
+        const audio::ResultCode beginResult = BeginOfflineRender(range, loopEnabled);
+        if (audio::Failed(beginResult))
+            return beginResult;
+
+        AudioBackendOffline* pBackend = static_cast<AudioBackendOffline*>(m_Impl.get());
+        const uint32_t bufferSize = static_cast<uint32_t>(m_Impl->GetAudioBufferSize());
+
+        // A single pass over the graph produces all the stems: the track outputs are copied after each cycle,
+        // the sinks are written on separate threads.
+        StemExporter exporter{ stems, bufferSize, range.GetLengthInSamples(), m_pActiveGraph };
+
+        uint64_t remainingFrameCount = exporter.GetTotalFrameCount();
+        while (remainingFrameCount > 0)
+        {
+            const uint32_t frameCount = static_cast<uint32_t>(Min<uint64_t>(remainingFrameCount, bufferSize));
+            pBackend->ProcessCycle(frameCount);
+            exporter.ProcessCycle(frameCount);
+            remainingFrameCount -= frameCount;
+        }
+
+        EndOfflineRender(loopEnabled);
+        return exporter.Finish();
+    }
+
+
+    audio::ResultCode AudioEngine::RebuildGraph()
+    {
+        if (!m_Running.load())
+            return audio::ResultCode::FailStreamNotRunning;
+
+        CollectRetiredGraphs();
+        if (m_Prerenderer)
+            CreatePrerenderBuffers(false);
+
+        ExecutionGraph* pGraph = memory::DefaultNew<ExecutionGraph>();
+        const audio::ResultCode buildResult = pGraph->Build(m_WorkerPool->GetWorkerCount());
+        if (audio::Failed(buildResult))
+        {
+            // The audio thread keeps running the previous graph.
+            memory::DefaultDelete(pGraph);
+            return buildResult;
+        }
+
+        // If the audio thread hasn't picked up the previous graph yet, it will never see it, so we can delete it here.
+        DeleteGraph(m_pPendingGraph.exchange(pGraph, std::memory_order_acq_rel));
+        UpdatePrerenderTracks();
+        return audio::ResultCode::Success;
+    }
+
+
+    void AudioEngine::CollectRetiredGraphs()
+    {
+        DeleteGraph(m_pRetiredGraph.exchange(nullptr, std::memory_order_acq_rel));
+    }
 } // namespace quinte
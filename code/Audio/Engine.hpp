@@ -1,9 +1,13 @@
 ﻿#pragma once
 #include <Audio/AudioEngineEvents.hpp>
 #include <Audio/Base.hpp>
+#include <Audio/Loudness.hpp>
 #include <Audio/Ports/AudioPort.hpp>
+#include <Audio/Telemetry.hpp>
 #include <Core/EventBus.hpp>
+#include <Core/FixedVector.hpp>
 #include <Core/Interface.hpp>
+#include <Core/SeqLock.hpp>
 
 namespace quinte
 {
@@ -14,6 +18,7 @@ namespace quinte
             Dummy = 0,
             WASAPI = 1 << 0,
             ASIO = 1 << 1,
+            Offline = 1 << 2,
         };
 
         QU_ENUM_BIT_OPERATORS(APIKind);
@@ -114,11 +119,82 @@ namespace quinte
         };
 
 
+        //! \brief Describes a segment of the audio cycle processed by the graph.
+        //!
+        //! StartTime is the timeline position of the first sample of the cycle, so that
+        //! LocalRange + StartTime is the timeline range of the segment. When a segment starts after a jump
+        //! (e.g. a loop wrap), StartTime is computed with unsigned wrap-around and can be "negative".
         struct EngineProcessInfo final
         {
             audio::TimePos64 StartTime;
             audio::TimeRange32 LocalRange;
         };
+
+
+        //! \brief The maximum number of segments an audio cycle can be split into.
+        //!
+        //! Bounds the worst-case cost of a cycle, e.g. when a very short loop is enabled.
+        inline constexpr uint32_t kMaxSegmentsPerCycle = 16;
+
+        using CycleSegmentList = FixedVector<EngineProcessInfo, kMaxSegmentsPerCycle>;
+
+
+        //! \brief Split an audio cycle into the segments processed by the graph.
+        //!
+        //! The cycle is split at the loop end, so that the wrap is sample-accurate. Once the limit is reached, the rest
+        //! of the cycle is processed as a single segment, and the playhead is wrapped modulo the loop length,
+        //! so that it never leaves the loop.
+        //!
+        //! \param playhead   - The timeline position of the first sample of the cycle.
+        //! \param frameCount - The number of samples in the cycle.
+        //! \param loopRange  - The loop range, empty if the playback is not looping.
+        //! \param rolling    - True if the playhead moves during the cycle.
+        //! \param segments   - Receives the segments, must be empty.
+        //!
+        //! \return The playhead at the end of the cycle.
+        TimePos64 SplitCycle(TimePos64 playhead, uint32_t frameCount, TimeRange64 loopRange, bool rolling,
+                             CycleSegmentList& segments);
+
+
+        //! \brief Aligns the output of an offline render to the timeline.
+        //!
+        //! The output of the graph lags behind the playhead by its latency, so the render is extended by the latency
+        //! and the first latency samples are dropped.
+        class LatencyCompensator final
+        {
+            uint64_t m_SkipFrameCount = 0;
+            uint64_t m_RemainingFrameCount = 0;
+
+        public:
+            inline LatencyCompensator() = default;
+
+            //! \param frameCount - The number of samples in the rendered range.
+            //! \param latency    - The output latency of the rendered node in samples.
+            inline LatencyCompensator(uint64_t frameCount, uint64_t latency)
+                : m_SkipFrameCount(latency)
+                , m_RemainingFrameCount(frameCount)
+            {
+            }
+
+            //! \brief Get the number of samples that still have to be rendered, including the skipped ones.
+            [[nodiscard]] inline uint64_t GetPendingFrameCount() const
+            {
+                return m_SkipFrameCount + m_RemainingFrameCount;
+            }
+
+            //! \brief Get the part of the cycle output that belongs to the rendered range, called after each cycle.
+            //!
+            //! \return The range of the output buffer to write, can be empty.
+            [[nodiscard]] inline TimeRange32 Advance(uint32_t frameCount)
+            {
+                const uint64_t skippedFrameCount = Min<uint64_t>(m_SkipFrameCount, frameCount);
+                m_SkipFrameCount -= skippedFrameCount;
+
+                const uint64_t length = Min(frameCount - skippedFrameCount, m_RemainingFrameCount);
+                m_RemainingFrameCount -= length;
+                return { skippedFrameCount, length };
+            }
+        };
     } // namespace audio
 
 
@@ -152,7 +228,17 @@ namespace quinte
     };
 
 
+    namespace audio
+    {
+        enum class ResamplerQuality : uint32_t;
+        struct StemDesc;
+    } // namespace audio
+
+
+    class AudioSink;
     class ExecutionGraph;
+    class GraphWorkerPool;
+    class Prerenderer;
 
     class AudioEngine final : public Interface<AudioEngine>::Registrar
     {
@@ -163,9 +249,44 @@ namespace quinte
         memory::unique_ptr<IAudioAPI> m_Impl;
         size_t m_AudioBufferSize = 0;
 
-        memory::unique_ptr<ExecutionGraph> m_Graph;
+        // The graph is double-buffered: the UI thread builds a new graph and publishes it to m_pPendingGraph,
+        // the audio thread picks it up at the beginning of the next cycle and moves the old one to m_pRetiredGraph.
+        // The retired graph is then destroyed on the UI thread, so the audio thread never frees memory.
+        // A graph is only retired while the worker pool is idle, so no worker can still be processing it.
+        ExecutionGraph* m_pActiveGraph = nullptr;
+        std::atomic<ExecutionGraph*> m_pPendingGraph = nullptr;
+        std::atomic<ExecutionGraph*> m_pRetiredGraph = nullptr;
+
+        memory::unique_ptr<GraphWorkerPool> m_WorkerPool;
+        memory::unique_ptr<Prerenderer> m_Prerenderer;
         std::atomic<bool> m_Running = false;
 
+        uint32_t m_SampleRate = 0;
+        audio::TimingAccumulator m_CycleTiming;
+        float m_CycleBudgetSum = 0.0f;
+        float m_PeakDSPLoad = 0.0f;
+        uint32_t m_DenormalCount = 0;
+        SeqLock<audio::EngineStats> m_Stats;
+
+        audio::LoudnessMeter m_LoudnessMeter;
+        SeqLock<audio::LoudnessStats> m_LoudnessStats;
+        std::atomic<bool> m_LoudnessResetRequested = false;
+
+        void UpdateStats(float cycleTime, uint32_t frameCount);
+        void UpdateLoudness(uint32_t frameCount);
+
+        void SetupPrerenderBuffers(bool enable);
+        void CreatePrerenderBuffers(bool recreate);
+        void UpdatePrerenderTracks();
+
+        void SetResamplerQuality(audio::ResamplerQuality quality);
+        audio::ResultCode BeginOfflineRender(audio::TimeRange64 range, bool& loopEnabled);
+        void EndOfflineRender(bool loopEnabled);
+
+        void AcquirePendingGraph();
+        audio::TimePos64 RunSegments(audio::TimePos64 playhead, uint32_t frameCount);
+        void DestroyGraphs();
+
         static audio::CallbackResult AudioCallbackImpl(void* pOutputBuffer, void* pInputBuffer, uint32_t frameCount,
                                                        double streamTime, audio::StreamStatus status, void* pUserData);
 
@@ -186,9 +307,62 @@ namespace quinte
             return m_AudioBufferSize;
         }
 
+        //! \brief Get the processing statistics, can be called from any thread.
+        inline audio::EngineStats GetStats() const
+        {
+            return m_Stats.Load();
+        }
+
+        //! \brief Get the loudness of the master output, can be called from any thread.
+        //!
+        //! The master output is only measured while the transport is rolling, including the offline renders.
+        inline audio::LoudnessStats GetLoudness() const
+        {
+            return m_LoudnessStats.Load();
+        }
+
+        //! \brief Restart the loudness measurement from the next audio cycle, can be called from any thread.
+        //!
+        //! Called automatically at the beginning of an offline render, so that the loudness of the rendered range
+        //! can be read after it's finished.
+        inline void ResetLoudness()
+        {
+            m_LoudnessResetRequested.store(true, std::memory_order_release);
+        }
+
         audio::ResultCode InitializeAPI(audio::APIKind apiKind);
         audio::ResultCode Start(const audio::EngineStartInfo& startInfo);
         void Stop();
+
+        //! \brief Render the range of the timeline as fast as possible and write the master output to the sink.
+        //!
+        //! The engine must be started with audio::APIKind::Offline. The loop is ignored during rendering.
+        //! The output is aligned to the timeline regardless of the latency of the graph.
+        //! The clips recorded at a different sample rate are converted with audio::ResamplerQuality::Best.
+        //! Must be called from the UI thread, returns when the whole range is rendered.
+        //!
+        //! \return audio::ResultCode::FailUnsupportedAPI if the engine uses a realtime backend.
+        audio::ResultCode RenderOffline(audio::TimeRange64 range, AudioSink* pSink);
+
+        //! \brief Render the range of the timeline once and write the output of each track to its own sink.
+        //!
+        //! The same restrictions as for RenderOffline() apply. The stems are aligned to the timeline
+        //! regardless of the track latencies.
+        audio::ResultCode RenderStems(audio::TimeRange64 range, std::span<const audio::StemDesc> stems);
+
+        //! \brief Build a new execution graph from the current session and publish it to the audio thread.
+        //!
+        //! Must be called from the UI thread every time the topology changes. The stream keeps running,
+        //! the new graph is used starting from the next audio cycle.
+        //!
+        //! \return audio::ResultCode::FailGraphCycle if the port connections contain a feedback loop,
+        //!         the previous graph is kept in this case.
+        audio::ResultCode RebuildGraph();
+
+        //! \brief Destroy the graphs that are no longer used by the audio thread.
+        //!
+        //! Must be called from the UI thread regularly.
+        void CollectRetiredGraphs();
     };
 } // namespace quinte
 
@@ -215,6 +389,8 @@ namespace std
                 return format_to(ctx.out(), "ASIO");
             case APIKind::WASAPI:
                 return format_to(ctx.out(), "WASAPI");
+            case APIKind::Offline:
+                return format_to(ctx.out(), "Offline");
             default:
                 QU_Assert(0);
                 return format_to(ctx.out(), "Unknown");
@@ -0,0 +1,62 @@
+﻿#pragma once
+#include <Core/Core.hpp>
+#include <bit>
+#include <xmmintrin.h>
+
+namespace quinte::audio
+{
+    //! \brief The MXCSR flush-to-zero bit: denormal results of SSE operations are replaced with zeros.
+    inline constexpr uint32_t kFlushToZeroMask = 0x8000;
+
+    //! \brief The MXCSR denormals-are-zero bit: denormal inputs of SSE operations are treated as zeros.
+    inline constexpr uint32_t kDenormalsAreZeroMask = 0x0040;
+
+
+    //! \brief Enable flush-to-zero and denormals-are-zero on the calling thread.
+    //!
+    //! Arithmetic on denormals is 10-100 times slower on x86, and decaying tails and filters produce them all the time.
+    //! The mode is per-thread, so it must be set on every thread that runs DSP.
+    inline void DisableDenormals()
+    {
+        _mm_setcsr(_mm_getcsr() | kFlushToZeroMask | kDenormalsAreZeroMask);
+    }
+
+
+    //! \brief Disables denormals on the calling thread and restores the previous mode on destruction.
+    //!
+    //! Used in the audio callbacks, since their threads can be owned by the driver.
+    class ScopedDisableDenormals final : public NoCopyMove
+    {
+        uint32_t m_PreviousCSR;
+
+    public:
+        inline ScopedDisableDenormals()
+            : m_PreviousCSR(_mm_getcsr())
+        {
+            _mm_setcsr(m_PreviousCSR | kFlushToZeroMask | kDenormalsAreZeroMask);
+        }
+
+        inline ~ScopedDisableDenormals()
+        {
+            _mm_setcsr(m_PreviousCSR);
+        }
+    };
+
+
+    //! \brief Count the denormal samples in a buffer.
+    //!
+    //! Used by the debug-mode detector, so it doesn't need to be fast. The bit pattern is checked directly,
+    //! since the comparisons would treat the denormals as zeros when denormals-are-zero is enabled.
+    inline uint32_t CountDenormals(const float* pData, uint64_t sampleCount)
+    {
+        uint32_t result = 0;
+        for (uint64_t sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex)
+        {
+            const uint32_t bits = std::bit_cast<uint32_t>(pData[sampleIndex]);
+            if ((bits & 0x7f800000) == 0 && (bits & 0x007fffff) != 0)
+                ++result;
+        }
+
+        return result;
+    }
+} // namespace quinte::audio
@@ -0,0 +1,127 @@
+﻿#include <Audio/Kernels/Kernels.hpp>
+
+#if QU_COMPILER_MSVC
+#    include <intrin.h>
+#else
+#    include <cpuid.h>
+#endif
+
+namespace quinte::audio
+{
+    namespace
+    {
+        struct CPUIDResult final
+        {
+            uint32_t EAX, EBX, ECX, EDX;
+        };
+
+
+        CPUIDResult QueryCPUID(uint32_t leaf, uint32_t subLeaf)
+        {
+            CPUIDResult result;
+#if QU_COMPILER_MSVC
+            int registers[4];
+            __cpuidex(registers, static_cast<int>(leaf), static_cast<int>(subLeaf));
+            result.EAX = static_cast<uint32_t>(registers[0]);
+            result.EBX = static_cast<uint32_t>(registers[1]);
+            result.ECX = static_cast<uint32_t>(registers[2]);
+            result.EDX = static_cast<uint32_t>(registers[3]);
+#else
+            __cpuid_count(leaf, subLeaf, result.EAX, result.EBX, result.ECX, result.EDX);
+#endif
+            return result;
+        }
+
+
+        //! \brief Read XCR0 to check which register states the OS saves on context switches.
+        uint64_t QueryEnabledXSaveFeatures()
+        {
+#if QU_COMPILER_MSVC
+            return _xgetbv(0);
+#else
+            // Not using the intrinsic since it requires the function to be compiled with XSAVE enabled.
+            uint32_t eax, edx;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+        }
+
+
+        inline bool HasBit(uint32_t value, uint32_t bit)
+        {
+            return (value >> bit) & 1;
+        }
+    } // namespace
+
+
+    namespace detail
+    {
+        const KernelTable* g_pKernelTable = &kKernelTablesScalar.Tables[0];
+    }
+
+
+    KernelISA DetectKernelISA()
+    {
+        const uint32_t maxLeaf = QueryCPUID(0, 0).EAX;
+        const CPUIDResult features = QueryCPUID(1, 0);
+        if (!HasBit(features.EDX, 26))
+            return KernelISA::Scalar;
+
+        const bool osxsave = HasBit(features.ECX, 27);
+        if (!osxsave || maxLeaf < 7)
+            return KernelISA::SSE2;
+
+        // XMM and YMM state for AVX, plus the opmask and ZMM state for AVX-512.
+        constexpr uint64_t kAVXStateMask = 0x06;
+        constexpr uint64_t kAVX512StateMask = 0xe6;
+        const uint64_t enabledFeatures = QueryEnabledXSaveFeatures();
+
+        const CPUIDResult extendedFeatures = QueryCPUID(7, 0);
+        const bool avx = HasBit(features.ECX, 28) && (enabledFeatures & kAVXStateMask) == kAVXStateMask;
+        const bool avx2 = avx && HasBit(features.ECX, 12) && HasBit(extendedFeatures.EBX, 5);
+        const bool avx512 = avx2 && HasBit(extendedFeatures.EBX, 16) && (enabledFeatures & kAVX512StateMask) == kAVX512StateMask;
+
+        if (avx512)
+            return KernelISA::AVX512;
+        if (avx2)
+            return KernelISA::AVX2;
+
+        return KernelISA::SSE2;
+    }
+
+
+    const KernelTable& GetKernelTable(KernelISA isa, uint32_t blockLength)
+    {
+        const detail::KernelTableSet* pTables;
+        switch (isa)
+        {
+        case KernelISA::SSE2:
+            pTables = &detail::kKernelTablesSSE2;
+            break;
+        case KernelISA::AVX2:
+            pTables = &detail::kKernelTablesAVX2;
+            break;
+        case KernelISA::AVX512:
+            pTables = &detail::kKernelTablesAVX512;
+            break;
+        case KernelISA::Scalar:
+        default:
+            pTables = &detail::kKernelTablesScalar;
+            break;
+        }
+
+        for (uint32_t lengthIndex = 0; lengthIndex < kKernelBlockLengthCount; ++lengthIndex)
+        {
+            if (kKernelBlockLengths[lengthIndex] == blockLength)
+                return pTables->Tables[lengthIndex + 1];
+        }
+
+        return pTables->Tables[0];
+    }
+
+
+    void SelectKernels(KernelISA isa, uint32_t blockLength)
+    {
+        detail::g_pKernelTable = &GetKernelTable(isa, blockLength);
+    }
+} // namespace quinte::audio
@@ -0,0 +1,162 @@
+﻿#pragma once
+#include <Core/Base.hpp>
+
+namespace quinte::audio
+{
+    //! \brief Instruction set that a KernelTable was compiled for.
+    enum class KernelISA : uint32_t
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512,
+    };
+
+
+    //! \brief The block lengths that have kernels specialized for them, see SelectKernels().
+    inline constexpr uint32_t kKernelBlockLengths[] = { 64, 128, 256, 512 };
+    inline constexpr uint32_t kKernelBlockLengthCount = sizeof(kKernelBlockLengths) / sizeof(kKernelBlockLengths[0]);
+
+    //! \brief The number of independent generators used by KernelTable::TriangularNoise.
+    inline constexpr uint32_t kNoiseLaneCount = 16;
+
+
+    //! \brief The levels of a block of samples computed by the metering kernels.
+    struct BlockLevels final
+    {
+        float Peak = 0.0f;
+        float SumOfSquares = 0.0f;
+    };
+
+
+    //! \brief A set of buffer processing functions compiled for a specific instruction set.
+    //!
+    //! The pointers don't have to be aligned. The destination buffers must not overlap the sources.
+    //! The kernels of a table with a non-zero BlockLength are fully unrolled for that sample count,
+    //! but they still accept any other sample count.
+    struct KernelTable final
+    {
+        KernelISA ISA;
+        uint32_t BlockLength;
+
+        //! \brief pDestination[i] += pSource[i]
+        void (*Mix)(float* pDestination, const float* pSource, uint64_t sampleCount);
+
+        //! \brief pDestination[i] += pSource[i] * gain
+        void (*MixWithGain)(float* pDestination, const float* pSource, float gain, uint64_t sampleCount);
+
+        //! \brief pDestination[i] += pSource[i] * (gainStart + gainStep * i)
+        void (*MixWithGainRamp)(float* pDestination, const float* pSource, float gainStart, float gainStep, uint64_t sampleCount);
+
+        //! \brief pDestination[i] += pSource[i] * (gainStart + gainStep * i)
+        //!
+        //! Computes the peak and the sum of squares of the resulting pDestination[i] in the same pass.
+        BlockLevels (*MixWithGainRampAndMeasure)(float* pDestination, const float* pSource, float gainStart, float gainStep,
+                                                 uint64_t sampleCount);
+
+        //! \brief pDestination[i] = pSource[i] * gain
+        void (*CopyWithGain)(float* pDestination, const float* pSource, float gain, uint64_t sampleCount);
+
+        //! \brief pBuffer[i] *= gain
+        void (*ApplyGain)(float* pBuffer, float gain, uint64_t sampleCount);
+
+        //! \brief pBuffer[i] *= gainStart + gainStep * i
+        void (*ApplyGainRamp)(float* pBuffer, float gainStart, float gainStep, uint64_t sampleCount);
+
+        //! \brief Maximum of |pSource[i]|, zero for an empty range.
+        float (*Peak)(const float* pSource, uint64_t sampleCount);
+
+        //! \brief Sum of pSource[i]^2.
+        float (*SumOfSquares)(const float* pSource, uint64_t sampleCount);
+
+        //! \brief Sum of pFirst[i] * pSecond[i]
+        float (*DotProduct)(const float* pFirst, const float* pSecond, uint64_t sampleCount);
+
+        //! \brief pDestination[i] += Sum of ppSources[j][i] * pGains[j]
+        //!
+        //! The destination is read and written once, the sources are accumulated in registers.
+        void (*MixMany)(float* pDestination, const float* const* ppSources, const float* pGains, uint32_t sourceCount,
+                        uint64_t sampleCount);
+
+        //! \brief pDestination[i] = double(pSource[i])
+        void (*ConvertToDouble)(double* pDestination, const float* pSource, uint64_t sampleCount);
+
+        //! \brief pDestination[i] += double(pSource[i]) * gain
+        void (*MixToDouble)(double* pDestination, const float* pSource, float gain, uint64_t sampleCount);
+
+        //! \brief pDestination[i] = float(pSource[i])
+        void (*ConvertToFloat)(float* pDestination, const double* pSource, uint64_t sampleCount);
+
+        //! \brief pDestination[2 * i] = pFirst[i], pDestination[2 * i + 1] = pSecond[i]
+        void (*Interleave2)(float* pDestination, const float* pFirst, const float* pSecond, uint64_t frameCount);
+
+        //! \brief pFirst[i] = pSource[2 * i], pSecond[i] = pSource[2 * i + 1]
+        void (*Deinterleave2)(float* pFirst, float* pSecond, const float* pSource, uint64_t frameCount);
+
+        //! \brief pDestination[i] = round(clamp(pSource[i] * 32768, -32768, 32767))
+        //!
+        //! Rounds to the nearest integer, ties to even.
+        void (*FloatToInt16)(int16_t* pDestination, const float* pSource, uint64_t sampleCount);
+
+        //! \brief pDestination[i] = pSource[i] / 32768
+        void (*Int16ToFloat)(float* pDestination, const int16_t* pSource, uint64_t sampleCount);
+
+        //! \brief pDestination[i] = round(clamp(pSource[i] * scale, -scale, scale - 1))
+        //!
+        //! The scale is a power of two up to 2^31, e.g. 2^23 for 24-bit samples stored in 32-bit integers.
+        void (*FloatToInt32)(int32_t* pDestination, const float* pSource, float scale, uint64_t sampleCount);
+
+        //! \brief pDestination[i] = pSource[i] / scale
+        void (*Int32ToFloat)(float* pDestination, const int32_t* pSource, float scale, uint64_t sampleCount);
+
+        //! \brief Fill the buffer with triangular (TPDF) noise in the range (-1, 1).
+        //!
+        //! pDestination[i] is produced by the xorshift32 generator with the state pState[i % kNoiseLaneCount],
+        //! so the result doesn't depend on the instruction set. The states must be non-zero.
+        //! The sample count must be a multiple of kNoiseLaneCount.
+        void (*TriangularNoise)(float* pDestination, uint32_t* pState, uint64_t sampleCount);
+    };
+
+
+    namespace detail
+    {
+        //! \brief The kernels for any sample count followed by the ones specialized for kKernelBlockLengths.
+        struct KernelTableSet final
+        {
+            KernelTable Tables[kKernelBlockLengthCount + 1];
+        };
+
+
+        extern const KernelTableSet kKernelTablesScalar;
+        extern const KernelTableSet kKernelTablesSSE2;
+        extern const KernelTableSet kKernelTablesAVX2;
+        extern const KernelTableSet kKernelTablesAVX512;
+
+        extern const KernelTable* g_pKernelTable;
+    } // namespace detail
+
+
+    //! \brief Query the CPU and the OS for the best supported instruction set.
+    KernelISA DetectKernelISA();
+
+
+    //! \brief Get the kernels compiled for the specified instruction set.
+    //!
+    //! The caller is responsible for checking that the CPU supports it, see DetectKernelISA().
+    //!
+    //! \param blockLength - The expected sample count, the generic kernels are returned if there's no specialization.
+    const KernelTable& GetKernelTable(KernelISA isa, uint32_t blockLength = 0);
+
+
+    //! \brief Set the kernels returned by GetKernels().
+    //!
+    //! Must be called when the audio processing is stopped, e.g. once at startup and every time a stream is opened.
+    void SelectKernels(KernelISA isa, uint32_t blockLength = 0);
+
+
+    //! \brief Get the kernels selected for the current CPU.
+    inline const KernelTable& GetKernels()
+    {
+        return *detail::g_pKernelTable;
+    }
+} // namespace quinte::audio
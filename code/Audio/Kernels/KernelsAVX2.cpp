@@ -0,0 +1,173 @@
+﻿#include <Audio/Kernels/KernelsImpl.hpp>
+#include <immintrin.h>
+
+// Compiled with AVX2 and FMA enabled, see code/CMakeLists.txt.
+
+namespace quinte::audio::detail
+{
+    namespace
+    {
+        struct VecAVX2 final
+        {
+            using Type = __m256;
+            inline static constexpr uint64_t kWidth = 8;
+
+            //! \brief Holds kDoubleWidth samples widened to double precision.
+            using DoubleType = __m256d;
+            inline static constexpr uint64_t kDoubleWidth = 4;
+
+            inline static Type Load(const float* pSource)
+            {
+                return _mm256_loadu_ps(pSource);
+            }
+
+            inline static void Store(float* pDestination, Type value)
+            {
+                _mm256_storeu_ps(pDestination, value);
+            }
+
+            inline static Type Set(float value)
+            {
+                return _mm256_set1_ps(value);
+            }
+
+            inline static Type Lanes()
+            {
+                return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+            }
+
+            inline static Type Add(Type lhs, Type rhs)
+            {
+                return _mm256_add_ps(lhs, rhs);
+            }
+
+            inline static Type Mul(Type lhs, Type rhs)
+            {
+                return _mm256_mul_ps(lhs, rhs);
+            }
+
+            inline static Type MulAdd(Type a, Type b, Type c)
+            {
+                return _mm256_fmadd_ps(a, b, c);
+            }
+
+            inline static Type Max(Type lhs, Type rhs)
+            {
+                return _mm256_max_ps(lhs, rhs);
+            }
+
+            inline static Type Min(Type lhs, Type rhs)
+            {
+                return _mm256_min_ps(lhs, rhs);
+            }
+
+            inline static Type Abs(Type value)
+            {
+                return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value);
+            }
+
+            inline static float ReduceAdd(Type value)
+            {
+                const __m128 quad = _mm_add_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+                const __m128 pairs = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+                return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+            }
+
+            inline static float ReduceMax(Type value)
+            {
+                const __m128 quad = _mm_max_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+                const __m128 pairs = _mm_max_ps(quad, _mm_movehl_ps(quad, quad));
+                return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+            }
+
+            inline static DoubleType LoadWiden(const float* pSource)
+            {
+                return _mm256_cvtps_pd(_mm_loadu_ps(pSource));
+            }
+
+            inline static void StoreNarrow(float* pDestination, DoubleType value)
+            {
+                _mm_storeu_ps(pDestination, _mm256_cvtpd_ps(value));
+            }
+
+            inline static DoubleType LoadDouble(const double* pSource)
+            {
+                return _mm256_loadu_pd(pSource);
+            }
+
+            inline static void StoreDouble(double* pDestination, DoubleType value)
+            {
+                _mm256_storeu_pd(pDestination, value);
+            }
+
+            inline static DoubleType SetDouble(double value)
+            {
+                return _mm256_set1_pd(value);
+            }
+
+            inline static DoubleType MulAddDouble(DoubleType a, DoubleType b, DoubleType c)
+            {
+                return _mm256_fmadd_pd(a, b, c);
+            }
+
+            inline static Type LoadInt32(const int32_t* pSource)
+            {
+                return _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource)));
+            }
+
+            //! \brief Round to the nearest integers using the current rounding mode, which is nearest-even by default.
+            inline static void StoreInt32(int32_t* pDestination, Type value)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestination), _mm256_cvtps_epi32(value));
+            }
+
+            inline static Type LoadInt16(const int16_t* pSource)
+            {
+                const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource));
+                return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(values));
+            }
+
+            inline static void StoreInt16(int16_t* pDestination, Type value)
+            {
+                const __m256i values = _mm256_cvtps_epi32(value);
+                const __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination), packed);
+            }
+
+            inline static void StoreInterleaved2(float* pDestination, Type first, Type second)
+            {
+                // The unpacks work within the 128-bit halves, so the halves are swapped into place afterwards.
+                const __m256 low = _mm256_unpacklo_ps(first, second);
+                const __m256 high = _mm256_unpackhi_ps(first, second);
+                _mm256_storeu_ps(pDestination, _mm256_permute2f128_ps(low, high, 0x20));
+                _mm256_storeu_ps(pDestination + 8, _mm256_permute2f128_ps(low, high, 0x31));
+            }
+
+            inline static void LoadDeinterleaved2(const float* pSource, Type& first, Type& second)
+            {
+                const __m256 source0 = _mm256_loadu_ps(pSource);
+                const __m256 source1 = _mm256_loadu_ps(pSource + 8);
+                const __m256 low = _mm256_permute2f128_ps(source0, source1, 0x20);
+                const __m256 high = _mm256_permute2f128_ps(source0, source1, 0x31);
+                first = _mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+                second = _mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+            }
+
+            inline static Type NextTriangularNoise(uint32_t* pState)
+            {
+                __m256i state = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pState));
+                state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 13));
+                state = _mm256_xor_si256(state, _mm256_srli_epi32(state, 17));
+                state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 5));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(pState), state);
+
+                const __m256i low = _mm256_and_si256(state, _mm256_set1_epi32(0xffff));
+                const __m256i difference = _mm256_sub_epi32(_mm256_srli_epi32(state, 16), low);
+                return _mm256_mul_ps(_mm256_cvtepi32_ps(difference), _mm256_set1_ps(1.0f / 65536.0f));
+            }
+        };
+    } // namespace
+
+
+    const KernelTableSet kKernelTablesAVX2 = MakeKernelTableSet<VecAVX2>(KernelISA::AVX2);
+} // namespace quinte::audio::detail
@@ -0,0 +1,175 @@
+﻿#include <Audio/Kernels/KernelsImpl.hpp>
+
+// GCC 12 warns about the _mm512_undefined_* placeholders used inside its own intrinsic headers.
+#if defined __GNUC__ && !defined __clang__
+#    pragma GCC diagnostic ignored "-Wuninitialized"
+#    pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <immintrin.h>
+
+// Compiled with AVX-512F enabled, see code/CMakeLists.txt.
+
+namespace quinte::audio::detail
+{
+    namespace
+    {
+        struct VecAVX512 final
+        {
+            using Type = __m512;
+            inline static constexpr uint64_t kWidth = 16;
+
+            //! \brief Holds kDoubleWidth samples widened to double precision.
+            using DoubleType = __m512d;
+            inline static constexpr uint64_t kDoubleWidth = 8;
+
+            inline static Type Load(const float* pSource)
+            {
+                return _mm512_loadu_ps(pSource);
+            }
+
+            inline static void Store(float* pDestination, Type value)
+            {
+                _mm512_storeu_ps(pDestination, value);
+            }
+
+            inline static Type Set(float value)
+            {
+                return _mm512_set1_ps(value);
+            }
+
+            inline static Type Lanes()
+            {
+                return _mm512_set_ps(15.0f, 14.0f, 13.0f, 12.0f, 11.0f, 10.0f, 9.0f, 8.0f, //
+                                     7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+            }
+
+            inline static Type Add(Type lhs, Type rhs)
+            {
+                return _mm512_add_ps(lhs, rhs);
+            }
+
+            inline static Type Mul(Type lhs, Type rhs)
+            {
+                return _mm512_mul_ps(lhs, rhs);
+            }
+
+            inline static Type MulAdd(Type a, Type b, Type c)
+            {
+                return _mm512_fmadd_ps(a, b, c);
+            }
+
+            inline static Type Max(Type lhs, Type rhs)
+            {
+                return _mm512_max_ps(lhs, rhs);
+            }
+
+            inline static Type Min(Type lhs, Type rhs)
+            {
+                return _mm512_min_ps(lhs, rhs);
+            }
+
+            inline static Type Abs(Type value)
+            {
+                return _mm512_abs_ps(value);
+            }
+
+            inline static float ReduceAdd(Type value)
+            {
+                return _mm512_reduce_add_ps(value);
+            }
+
+            inline static float ReduceMax(Type value)
+            {
+                return _mm512_reduce_max_ps(value);
+            }
+
+            inline static DoubleType LoadWiden(const float* pSource)
+            {
+                return _mm512_cvtps_pd(_mm256_loadu_ps(pSource));
+            }
+
+            inline static void StoreNarrow(float* pDestination, DoubleType value)
+            {
+                _mm256_storeu_ps(pDestination, _mm512_cvtpd_ps(value));
+            }
+
+            inline static DoubleType LoadDouble(const double* pSource)
+            {
+                return _mm512_loadu_pd(pSource);
+            }
+
+            inline static void StoreDouble(double* pDestination, DoubleType value)
+            {
+                _mm512_storeu_pd(pDestination, value);
+            }
+
+            inline static DoubleType SetDouble(double value)
+            {
+                return _mm512_set1_pd(value);
+            }
+
+            inline static DoubleType MulAddDouble(DoubleType a, DoubleType b, DoubleType c)
+            {
+                return _mm512_fmadd_pd(a, b, c);
+            }
+
+            inline static Type LoadInt32(const int32_t* pSource)
+            {
+                return _mm512_cvtepi32_ps(_mm512_loadu_si512(pSource));
+            }
+
+            //! \brief Round to the nearest integers using the current rounding mode, which is nearest-even by default.
+            inline static void StoreInt32(int32_t* pDestination, Type value)
+            {
+                _mm512_storeu_si512(pDestination, _mm512_cvtps_epi32(value));
+            }
+
+            inline static Type LoadInt16(const int16_t* pSource)
+            {
+                const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource));
+                return _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(values));
+            }
+
+            inline static void StoreInt16(int16_t* pDestination, Type value)
+            {
+                const __m256i packed = _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(value));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestination), packed);
+            }
+
+            inline static void StoreInterleaved2(float* pDestination, Type first, Type second)
+            {
+                const __m512i lowIndices = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+                const __m512i highIndices = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+                _mm512_storeu_ps(pDestination, _mm512_permutex2var_ps(first, lowIndices, second));
+                _mm512_storeu_ps(pDestination + 16, _mm512_permutex2var_ps(first, highIndices, second));
+            }
+
+            inline static void LoadDeinterleaved2(const float* pSource, Type& first, Type& second)
+            {
+                const __m512i evenIndices = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+                const __m512i oddIndices = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+                const __m512 low = _mm512_loadu_ps(pSource);
+                const __m512 high = _mm512_loadu_ps(pSource + 16);
+                first = _mm512_permutex2var_ps(low, evenIndices, high);
+                second = _mm512_permutex2var_ps(low, oddIndices, high);
+            }
+
+            inline static Type NextTriangularNoise(uint32_t* pState)
+            {
+                __m512i state = _mm512_loadu_si512(pState);
+                state = _mm512_xor_si512(state, _mm512_slli_epi32(state, 13));
+                state = _mm512_xor_si512(state, _mm512_srli_epi32(state, 17));
+                state = _mm512_xor_si512(state, _mm512_slli_epi32(state, 5));
+                _mm512_storeu_si512(pState, state);
+
+                const __m512i low = _mm512_and_si512(state, _mm512_set1_epi32(0xffff));
+                const __m512i difference = _mm512_sub_epi32(_mm512_srli_epi32(state, 16), low);
+                return _mm512_mul_ps(_mm512_cvtepi32_ps(difference), _mm512_set1_ps(1.0f / 65536.0f));
+            }
+        };
+    } // namespace
+
+
+    const KernelTableSet kKernelTablesAVX512 = MakeKernelTableSet<VecAVX512>(KernelISA::AVX512);
+} // namespace quinte::audio::detail
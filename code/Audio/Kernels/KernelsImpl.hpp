@@ -0,0 +1,746 @@
+﻿#pragma once
+#include <Audio/Kernels/Kernels.hpp>
+#include <utility>
+
+//
+// This header is included only by the per-ISA translation units, each of them compiled with its own target flags.
+// The vector traits are defined in an anonymous namespace, so every instantiation below gets internal linkage.
+// Kernels must not call any non-intrinsic inline functions: the linker could pick a copy compiled for a wider ISA.
+//
+// Every kernel is instantiated twice: with a compile-time sample count equal to the block length of the table,
+// so that the loops have constant trip counts and no tail, and with a runtime sample count for everything else.
+//
+
+namespace quinte::audio::detail
+{
+    template<class TVec, uint64_t TBlockLength>
+    struct KernelsImpl final
+    {
+        using Vec = typename TVec::Type;
+        using DoubleVec = typename TVec::DoubleType;
+        inline static constexpr uint64_t kWidth = TVec::kWidth;
+        inline static constexpr uint64_t kDoubleWidth = TVec::kDoubleWidth;
+
+        // The fixed block lengths are multiples of the vector width, so the tail loops are only needed for the others.
+        static_assert(TBlockLength % kWidth == 0 && TBlockLength % kDoubleWidth == 0);
+
+        template<uint64_t TSampleCount>
+        inline static uint64_t GetSampleCount(uint64_t sampleCount)
+        {
+            return TSampleCount == 0 ? sampleCount : TSampleCount;
+        }
+
+        inline static Vec RampGain(float gainStart, float gainStep, uint64_t sampleIndex)
+        {
+            const Vec start = TVec::Set(gainStart + gainStep * static_cast<float>(sampleIndex));
+            return TVec::MulAdd(TVec::Set(gainStep), TVec::Lanes(), start);
+        }
+
+        template<uint64_t TSampleCount>
+        static void MixImpl(float* QU_RESTRICT pDestination, const float* QU_RESTRICT pSource, uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+            {
+                const Vec result = TVec::Add(TVec::Load(pDestination + sampleIndex), TVec::Load(pSource + sampleIndex));
+                TVec::Store(pDestination + sampleIndex, result);
+            }
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                    pDestination[sampleIndex] += pSource[sampleIndex];
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void MixWithGainImpl(float* QU_RESTRICT pDestination, const float* QU_RESTRICT pSource, float gain,
+                                    uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            const Vec gainVec = TVec::Set(gain);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+            {
+                const Vec source = TVec::Load(pSource + sampleIndex);
+                TVec::Store(pDestination + sampleIndex, TVec::MulAdd(source, gainVec, TVec::Load(pDestination + sampleIndex)));
+            }
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                    pDestination[sampleIndex] += pSource[sampleIndex] * gain;
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void MixWithGainRampImpl(float* QU_RESTRICT pDestination, const float* QU_RESTRICT pSource, float gainStart,
+                                        float gainStep, uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+            {
+                const Vec gainVec = RampGain(gainStart, gainStep, sampleIndex);
+                const Vec source = TVec::Load(pSource + sampleIndex);
+                TVec::Store(pDestination + sampleIndex, TVec::MulAdd(source, gainVec, TVec::Load(pDestination + sampleIndex)));
+            }
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                    pDestination[sampleIndex] += pSource[sampleIndex] * (gainStart + gainStep * static_cast<float>(sampleIndex));
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static BlockLevels MixWithGainRampAndMeasureImpl(float* QU_RESTRICT pDestination, const float* QU_RESTRICT pSource,
+                                                         float gainStart, float gainStep, uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            Vec peakVec = TVec::Set(0.0f);
+            Vec sumVec = TVec::Set(0.0f);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+            {
+                const Vec gainVec = RampGain(gainStart, gainStep, sampleIndex);
+                const Vec source = TVec::Load(pSource + sampleIndex);
+                const Vec result = TVec::MulAdd(source, gainVec, TVec::Load(pDestination + sampleIndex));
+                TVec::Store(pDestination + sampleIndex, result);
+
+                peakVec = TVec::Max(peakVec, TVec::Abs(result));
+                sumVec = TVec::MulAdd(result, result, sumVec);
+            }
+
+            BlockLevels levels{ TVec::ReduceMax(peakVec), TVec::ReduceAdd(sumVec) };
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                {
+                    const float gain = gainStart + gainStep * static_cast<float>(sampleIndex);
+                    const float result = pDestination[sampleIndex] + pSource[sampleIndex] * gain;
+                    pDestination[sampleIndex] = result;
+
+                    const float value = result < 0.0f ? -result : result;
+                    levels.Peak = value > levels.Peak ? value : levels.Peak;
+                    levels.SumOfSquares += result * result;
+                }
+            }
+
+            return levels;
+        }
+
+        template<uint64_t TSampleCount>
+        static void CopyWithGainImpl(float* QU_RESTRICT pDestination, const float* QU_RESTRICT pSource, float gain,
+                                     uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            const Vec gainVec = TVec::Set(gain);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+                TVec::Store(pDestination + sampleIndex, TVec::Mul(TVec::Load(pSource + sampleIndex), gainVec));
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                    pDestination[sampleIndex] = pSource[sampleIndex] * gain;
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void ApplyGainImpl(float* pBuffer, float gain, uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            const Vec gainVec = TVec::Set(gain);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+                TVec::Store(pBuffer + sampleIndex, TVec::Mul(TVec::Load(pBuffer + sampleIndex), gainVec));
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                    pBuffer[sampleIndex] *= gain;
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void ApplyGainRampImpl(float* pBuffer, float gainStart, float gainStep, uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+            {
+                const Vec gainVec = RampGain(gainStart, gainStep, sampleIndex);
+                TVec::Store(pBuffer + sampleIndex, TVec::Mul(TVec::Load(pBuffer + sampleIndex), gainVec));
+            }
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                    pBuffer[sampleIndex] *= gainStart + gainStep * static_cast<float>(sampleIndex);
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static float PeakImpl(const float* pSource, uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            Vec peakVec = TVec::Set(0.0f);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+                peakVec = TVec::Max(peakVec, TVec::Abs(TVec::Load(pSource + sampleIndex)));
+
+            float peak = TVec::ReduceMax(peakVec);
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                {
+                    const float value = pSource[sampleIndex] < 0.0f ? -pSource[sampleIndex] : pSource[sampleIndex];
+                    peak = value > peak ? value : peak;
+                }
+            }
+
+            return peak;
+        }
+
+        template<uint64_t TSampleCount>
+        static float SumOfSquaresImpl(const float* pSource, uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            Vec sumVec = TVec::Set(0.0f);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+            {
+                const Vec value = TVec::Load(pSource + sampleIndex);
+                sumVec = TVec::MulAdd(value, value, sumVec);
+            }
+
+            float sum = TVec::ReduceAdd(sumVec);
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                    sum += pSource[sampleIndex] * pSource[sampleIndex];
+            }
+
+            return sum;
+        }
+
+        template<uint64_t TSampleCount>
+        static float DotProductImpl(const float* pFirst, const float* pSecond, uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            Vec sumVec = TVec::Set(0.0f);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+                sumVec = TVec::MulAdd(TVec::Load(pFirst + sampleIndex), TVec::Load(pSecond + sampleIndex), sumVec);
+
+            float sum = TVec::ReduceAdd(sumVec);
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                    sum += pFirst[sampleIndex] * pSecond[sampleIndex];
+            }
+
+            return sum;
+        }
+
+        template<uint64_t TSampleCount>
+        static void MixManyImpl(float* QU_RESTRICT pDestination, const float* const* ppSources, const float* pGains,
+                                uint32_t sourceCount, uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+            {
+                Vec sum = TVec::Load(pDestination + sampleIndex);
+                for (uint32_t sourceIndex = 0; sourceIndex < sourceCount; ++sourceIndex)
+                    sum = TVec::MulAdd(TVec::Load(ppSources[sourceIndex] + sampleIndex), TVec::Set(pGains[sourceIndex]), sum);
+
+                TVec::Store(pDestination + sampleIndex, sum);
+            }
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                {
+                    float sum = pDestination[sampleIndex];
+                    for (uint32_t sourceIndex = 0; sourceIndex < sourceCount; ++sourceIndex)
+                        sum += ppSources[sourceIndex][sampleIndex] * pGains[sourceIndex];
+
+                    pDestination[sampleIndex] = sum;
+                }
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void ConvertToDoubleImpl(double* QU_RESTRICT pDestination, const float* QU_RESTRICT pSource,
+                                        uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kDoubleWidth <= sampleCount; sampleIndex += kDoubleWidth)
+                TVec::StoreDouble(pDestination + sampleIndex, TVec::LoadWiden(pSource + sampleIndex));
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                    pDestination[sampleIndex] = static_cast<double>(pSource[sampleIndex]);
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void MixToDoubleImpl(double* QU_RESTRICT pDestination, const float* QU_RESTRICT pSource, float gain,
+                                    uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            const DoubleVec gainVec = TVec::SetDouble(static_cast<double>(gain));
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kDoubleWidth <= sampleCount; sampleIndex += kDoubleWidth)
+            {
+                const DoubleVec source = TVec::LoadWiden(pSource + sampleIndex);
+                const DoubleVec result = TVec::MulAddDouble(source, gainVec, TVec::LoadDouble(pDestination + sampleIndex));
+                TVec::StoreDouble(pDestination + sampleIndex, result);
+            }
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                    pDestination[sampleIndex] += static_cast<double>(pSource[sampleIndex]) * static_cast<double>(gain);
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void ConvertToFloatImpl(float* QU_RESTRICT pDestination, const double* QU_RESTRICT pSource,
+                                       uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kDoubleWidth <= sampleCount; sampleIndex += kDoubleWidth)
+                TVec::StoreNarrow(pDestination + sampleIndex, TVec::LoadDouble(pSource + sampleIndex));
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                    pDestination[sampleIndex] = static_cast<float>(pSource[sampleIndex]);
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void Interleave2Impl(float* QU_RESTRICT pDestination, const float* QU_RESTRICT pFirst,
+                                    const float* QU_RESTRICT pSecond, uint64_t dynamicFrameCount)
+        {
+            const uint64_t frameCount = GetSampleCount<TSampleCount>(dynamicFrameCount);
+
+            uint64_t frameIndex = 0;
+            for (; frameIndex + kWidth <= frameCount; frameIndex += kWidth)
+            {
+                const Vec first = TVec::Load(pFirst + frameIndex);
+                const Vec second = TVec::Load(pSecond + frameIndex);
+                TVec::StoreInterleaved2(pDestination + 2 * frameIndex, first, second);
+            }
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; frameIndex < frameCount; ++frameIndex)
+                {
+                    pDestination[2 * frameIndex] = pFirst[frameIndex];
+                    pDestination[2 * frameIndex + 1] = pSecond[frameIndex];
+                }
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void Deinterleave2Impl(float* QU_RESTRICT pFirst, float* QU_RESTRICT pSecond, const float* QU_RESTRICT pSource,
+                                      uint64_t dynamicFrameCount)
+        {
+            const uint64_t frameCount = GetSampleCount<TSampleCount>(dynamicFrameCount);
+
+            uint64_t frameIndex = 0;
+            for (; frameIndex + kWidth <= frameCount; frameIndex += kWidth)
+            {
+                Vec first, second;
+                TVec::LoadDeinterleaved2(pSource + 2 * frameIndex, first, second);
+                TVec::Store(pFirst + frameIndex, first);
+                TVec::Store(pSecond + frameIndex, second);
+            }
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; frameIndex < frameCount; ++frameIndex)
+                {
+                    pFirst[frameIndex] = pSource[2 * frameIndex];
+                    pSecond[frameIndex] = pSource[2 * frameIndex + 1];
+                }
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void FloatToInt16Impl(int16_t* QU_RESTRICT pDestination, const float* QU_RESTRICT pSource,
+                                     uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            const Vec scale = TVec::Set(32768.0f);
+            const Vec minValue = TVec::Set(-32768.0f);
+            const Vec maxValue = TVec::Set(32767.0f);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+            {
+                const Vec value = TVec::Mul(TVec::Load(pSource + sampleIndex), scale);
+                TVec::StoreInt16(pDestination + sampleIndex, TVec::Min(TVec::Max(value, minValue), maxValue));
+            }
+
+            if constexpr (TSampleCount == 0)
+            {
+                // The tail goes through a padded vector, so that it's rounded exactly like the rest.
+                if (sampleIndex < sampleCount)
+                {
+                    const uint64_t tailLength = sampleCount - sampleIndex;
+                    float source[kWidth] = {};
+                    int16_t result[kWidth];
+                    for (uint64_t tailIndex = 0; tailIndex < tailLength; ++tailIndex)
+                        source[tailIndex] = pSource[sampleIndex + tailIndex];
+
+                    const Vec value = TVec::Mul(TVec::Load(source), scale);
+                    TVec::StoreInt16(result, TVec::Min(TVec::Max(value, minValue), maxValue));
+                    for (uint64_t tailIndex = 0; tailIndex < tailLength; ++tailIndex)
+                        pDestination[sampleIndex + tailIndex] = result[tailIndex];
+                }
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void Int16ToFloatImpl(float* QU_RESTRICT pDestination, const int16_t* QU_RESTRICT pSource,
+                                     uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            const Vec scale = TVec::Set(1.0f / 32768.0f);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+                TVec::Store(pDestination + sampleIndex, TVec::Mul(TVec::LoadInt16(pSource + sampleIndex), scale));
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                    pDestination[sampleIndex] = static_cast<float>(pSource[sampleIndex]) * (1.0f / 32768.0f);
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void FloatToInt32Impl(int32_t* QU_RESTRICT pDestination, const float* QU_RESTRICT pSource, float scale,
+                                     uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            // 2^31 - 1 is not representable, 2147483520 is the largest float below 2^31.
+            constexpr float kMaxInt32Float = 2147483520.0f;
+            const Vec scaleVec = TVec::Set(scale);
+            const Vec minValue = TVec::Set(-scale);
+            const Vec maxValue = TVec::Set(scale - 1.0f < kMaxInt32Float ? scale - 1.0f : kMaxInt32Float);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+            {
+                const Vec value = TVec::Mul(TVec::Load(pSource + sampleIndex), scaleVec);
+                TVec::StoreInt32(pDestination + sampleIndex, TVec::Min(TVec::Max(value, minValue), maxValue));
+            }
+
+            if constexpr (TSampleCount == 0)
+            {
+                if (sampleIndex < sampleCount)
+                {
+                    const uint64_t tailLength = sampleCount - sampleIndex;
+                    float source[kWidth] = {};
+                    int32_t result[kWidth];
+                    for (uint64_t tailIndex = 0; tailIndex < tailLength; ++tailIndex)
+                        source[tailIndex] = pSource[sampleIndex + tailIndex];
+
+                    const Vec value = TVec::Mul(TVec::Load(source), scaleVec);
+                    TVec::StoreInt32(result, TVec::Min(TVec::Max(value, minValue), maxValue));
+                    for (uint64_t tailIndex = 0; tailIndex < tailLength; ++tailIndex)
+                        pDestination[sampleIndex + tailIndex] = result[tailIndex];
+                }
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void Int32ToFloatImpl(float* QU_RESTRICT pDestination, const int32_t* QU_RESTRICT pSource, float scale,
+                                     uint64_t dynamicSampleCount)
+        {
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            const float inverseScale = 1.0f / scale;
+            const Vec inverseScaleVec = TVec::Set(inverseScale);
+
+            uint64_t sampleIndex = 0;
+            for (; sampleIndex + kWidth <= sampleCount; sampleIndex += kWidth)
+                TVec::Store(pDestination + sampleIndex, TVec::Mul(TVec::LoadInt32(pSource + sampleIndex), inverseScaleVec));
+
+            if constexpr (TSampleCount == 0)
+            {
+                for (; sampleIndex < sampleCount; ++sampleIndex)
+                    pDestination[sampleIndex] = static_cast<float>(pSource[sampleIndex]) * inverseScale;
+            }
+        }
+
+        template<uint64_t TSampleCount>
+        static void TriangularNoiseImpl(float* QU_RESTRICT pDestination, uint32_t* QU_RESTRICT pState, uint64_t dynamicSampleCount)
+        {
+            static_assert(kNoiseLaneCount % kWidth == 0);
+            const uint64_t sampleCount = GetSampleCount<TSampleCount>(dynamicSampleCount);
+
+            for (uint64_t sampleIndex = 0; sampleIndex < sampleCount; sampleIndex += kNoiseLaneCount)
+            {
+                for (uint64_t laneIndex = 0; laneIndex < kNoiseLaneCount; laneIndex += kWidth)
+                    TVec::Store(pDestination + sampleIndex + laneIndex, TVec::NextTriangularNoise(pState + laneIndex));
+            }
+        }
+
+        static void Mix(float* pDestination, const float* pSource, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                MixImpl<TBlockLength>(pDestination, pSource, TBlockLength);
+            else
+                MixImpl<0>(pDestination, pSource, sampleCount);
+        }
+
+        static void MixWithGain(float* pDestination, const float* pSource, float gain, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                MixWithGainImpl<TBlockLength>(pDestination, pSource, gain, TBlockLength);
+            else
+                MixWithGainImpl<0>(pDestination, pSource, gain, sampleCount);
+        }
+
+        static void MixWithGainRamp(float* pDestination, const float* pSource, float gainStart, float gainStep,
+                                    uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                MixWithGainRampImpl<TBlockLength>(pDestination, pSource, gainStart, gainStep, TBlockLength);
+            else
+                MixWithGainRampImpl<0>(pDestination, pSource, gainStart, gainStep, sampleCount);
+        }
+
+        static BlockLevels MixWithGainRampAndMeasure(float* pDestination, const float* pSource, float gainStart, float gainStep,
+                                                     uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                return MixWithGainRampAndMeasureImpl<TBlockLength>(pDestination, pSource, gainStart, gainStep, TBlockLength);
+
+            return MixWithGainRampAndMeasureImpl<0>(pDestination, pSource, gainStart, gainStep, sampleCount);
+        }
+
+        static void CopyWithGain(float* pDestination, const float* pSource, float gain, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                CopyWithGainImpl<TBlockLength>(pDestination, pSource, gain, TBlockLength);
+            else
+                CopyWithGainImpl<0>(pDestination, pSource, gain, sampleCount);
+        }
+
+        static void ApplyGain(float* pBuffer, float gain, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                ApplyGainImpl<TBlockLength>(pBuffer, gain, TBlockLength);
+            else
+                ApplyGainImpl<0>(pBuffer, gain, sampleCount);
+        }
+
+        static void ApplyGainRamp(float* pBuffer, float gainStart, float gainStep, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                ApplyGainRampImpl<TBlockLength>(pBuffer, gainStart, gainStep, TBlockLength);
+            else
+                ApplyGainRampImpl<0>(pBuffer, gainStart, gainStep, sampleCount);
+        }
+
+        static float Peak(const float* pSource, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                return PeakImpl<TBlockLength>(pSource, TBlockLength);
+
+            return PeakImpl<0>(pSource, sampleCount);
+        }
+
+        static float SumOfSquares(const float* pSource, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                return SumOfSquaresImpl<TBlockLength>(pSource, TBlockLength);
+
+            return SumOfSquaresImpl<0>(pSource, sampleCount);
+        }
+
+        static float DotProduct(const float* pFirst, const float* pSecond, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                return DotProductImpl<TBlockLength>(pFirst, pSecond, TBlockLength);
+
+            return DotProductImpl<0>(pFirst, pSecond, sampleCount);
+        }
+
+        static void MixMany(float* pDestination, const float* const* ppSources, const float* pGains, uint32_t sourceCount,
+                            uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                MixManyImpl<TBlockLength>(pDestination, ppSources, pGains, sourceCount, TBlockLength);
+            else
+                MixManyImpl<0>(pDestination, ppSources, pGains, sourceCount, sampleCount);
+        }
+
+        static void ConvertToDouble(double* pDestination, const float* pSource, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                ConvertToDoubleImpl<TBlockLength>(pDestination, pSource, TBlockLength);
+            else
+                ConvertToDoubleImpl<0>(pDestination, pSource, sampleCount);
+        }
+
+        static void MixToDouble(double* pDestination, const float* pSource, float gain, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                MixToDoubleImpl<TBlockLength>(pDestination, pSource, gain, TBlockLength);
+            else
+                MixToDoubleImpl<0>(pDestination, pSource, gain, sampleCount);
+        }
+
+        static void ConvertToFloat(float* pDestination, const double* pSource, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                ConvertToFloatImpl<TBlockLength>(pDestination, pSource, TBlockLength);
+            else
+                ConvertToFloatImpl<0>(pDestination, pSource, sampleCount);
+        }
+
+        static void Interleave2(float* pDestination, const float* pFirst, const float* pSecond, uint64_t frameCount)
+        {
+            if (frameCount == TBlockLength)
+                Interleave2Impl<TBlockLength>(pDestination, pFirst, pSecond, TBlockLength);
+            else
+                Interleave2Impl<0>(pDestination, pFirst, pSecond, frameCount);
+        }
+
+        static void Deinterleave2(float* pFirst, float* pSecond, const float* pSource, uint64_t frameCount)
+        {
+            if (frameCount == TBlockLength)
+                Deinterleave2Impl<TBlockLength>(pFirst, pSecond, pSource, TBlockLength);
+            else
+                Deinterleave2Impl<0>(pFirst, pSecond, pSource, frameCount);
+        }
+
+        static void FloatToInt16(int16_t* pDestination, const float* pSource, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                FloatToInt16Impl<TBlockLength>(pDestination, pSource, TBlockLength);
+            else
+                FloatToInt16Impl<0>(pDestination, pSource, sampleCount);
+        }
+
+        static void Int16ToFloat(float* pDestination, const int16_t* pSource, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                Int16ToFloatImpl<TBlockLength>(pDestination, pSource, TBlockLength);
+            else
+                Int16ToFloatImpl<0>(pDestination, pSource, sampleCount);
+        }
+
+        static void FloatToInt32(int32_t* pDestination, const float* pSource, float scale, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                FloatToInt32Impl<TBlockLength>(pDestination, pSource, scale, TBlockLength);
+            else
+                FloatToInt32Impl<0>(pDestination, pSource, scale, sampleCount);
+        }
+
+        static void Int32ToFloat(float* pDestination, const int32_t* pSource, float scale, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                Int32ToFloatImpl<TBlockLength>(pDestination, pSource, scale, TBlockLength);
+            else
+                Int32ToFloatImpl<0>(pDestination, pSource, scale, sampleCount);
+        }
+
+        static void TriangularNoise(float* pDestination, uint32_t* pState, uint64_t sampleCount)
+        {
+            if (sampleCount == TBlockLength)
+                TriangularNoiseImpl<TBlockLength>(pDestination, pState, TBlockLength);
+            else
+                TriangularNoiseImpl<0>(pDestination, pState, sampleCount);
+        }
+    };
+
+
+    template<class TVec, uint64_t TBlockLength = 0>
+    constexpr KernelTable MakeKernelTable(KernelISA isa)
+    {
+        using Impl = KernelsImpl<TVec, TBlockLength>;
+
+        KernelTable result{};
+        result.ISA = isa;
+        result.BlockLength = static_cast<uint32_t>(TBlockLength);
+        result.Mix = &Impl::Mix;
+        result.MixWithGain = &Impl::MixWithGain;
+        result.MixWithGainRamp = &Impl::MixWithGainRamp;
+        result.MixWithGainRampAndMeasure = &Impl::MixWithGainRampAndMeasure;
+        result.CopyWithGain = &Impl::CopyWithGain;
+        result.ApplyGain = &Impl::ApplyGain;
+        result.ApplyGainRamp = &Impl::ApplyGainRamp;
+        result.Peak = &Impl::Peak;
+        result.SumOfSquares = &Impl::SumOfSquares;
+        result.DotProduct = &Impl::DotProduct;
+        result.MixMany = &Impl::MixMany;
+        result.ConvertToDouble = &Impl::ConvertToDouble;
+        result.MixToDouble = &Impl::MixToDouble;
+        result.ConvertToFloat = &Impl::ConvertToFloat;
+        result.Interleave2 = &Impl::Interleave2;
+        result.Deinterleave2 = &Impl::Deinterleave2;
+        result.FloatToInt16 = &Impl::FloatToInt16;
+        result.Int16ToFloat = &Impl::Int16ToFloat;
+        result.FloatToInt32 = &Impl::FloatToInt32;
+        result.Int32ToFloat = &Impl::Int32ToFloat;
+        result.TriangularNoise = &Impl::TriangularNoise;
+        return result;
+    }
+
+
+    template<class TVec, uint32_t... TIndices>
+    constexpr KernelTableSet MakeKernelTableSetImpl(KernelISA isa, std::integer_sequence<uint32_t, TIndices...>)
+    {
+        return KernelTableSet{ {
+            MakeKernelTable<TVec>(isa),
+            MakeKernelTable<TVec, kKernelBlockLengths[TIndices]>(isa)...,
+        } };
+    }
+
+
+    template<class TVec>
+    constexpr KernelTableSet MakeKernelTableSet(KernelISA isa)
+    {
+        return MakeKernelTableSetImpl<TVec>(isa, std::make_integer_sequence<uint32_t, kKernelBlockLengthCount>{});
+    }
+} // namespace quinte::audio::detail
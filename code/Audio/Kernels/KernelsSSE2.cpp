@@ -0,0 +1,164 @@
+﻿#include <Audio/Kernels/KernelsImpl.hpp>
+#include <immintrin.h>
+
+namespace quinte::audio::detail
+{
+    namespace
+    {
+        struct VecSSE2 final
+        {
+            using Type = __m128;
+            inline static constexpr uint64_t kWidth = 4;
+
+            //! \brief Holds kDoubleWidth samples widened to double precision.
+            using DoubleType = __m128d;
+            inline static constexpr uint64_t kDoubleWidth = 2;
+
+            inline static Type Load(const float* pSource)
+            {
+                return _mm_loadu_ps(pSource);
+            }
+
+            inline static void Store(float* pDestination, Type value)
+            {
+                _mm_storeu_ps(pDestination, value);
+            }
+
+            inline static Type Set(float value)
+            {
+                return _mm_set1_ps(value);
+            }
+
+            inline static Type Lanes()
+            {
+                return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+            }
+
+            inline static Type Add(Type lhs, Type rhs)
+            {
+                return _mm_add_ps(lhs, rhs);
+            }
+
+            inline static Type Mul(Type lhs, Type rhs)
+            {
+                return _mm_mul_ps(lhs, rhs);
+            }
+
+            inline static Type MulAdd(Type a, Type b, Type c)
+            {
+                return _mm_add_ps(_mm_mul_ps(a, b), c);
+            }
+
+            inline static Type Max(Type lhs, Type rhs)
+            {
+                return _mm_max_ps(lhs, rhs);
+            }
+
+            inline static Type Min(Type lhs, Type rhs)
+            {
+                return _mm_min_ps(lhs, rhs);
+            }
+
+            inline static Type Abs(Type value)
+            {
+                return _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+            }
+
+            inline static float ReduceAdd(Type value)
+            {
+                const __m128 pairs = _mm_add_ps(value, _mm_movehl_ps(value, value));
+                return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+            }
+
+            inline static float ReduceMax(Type value)
+            {
+                const __m128 pairs = _mm_max_ps(value, _mm_movehl_ps(value, value));
+                return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+            }
+
+            inline static DoubleType LoadWiden(const float* pSource)
+            {
+                return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSource))));
+            }
+
+            inline static void StoreNarrow(float* pDestination, DoubleType value)
+            {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(pDestination), _mm_castps_si128(_mm_cvtpd_ps(value)));
+            }
+
+            inline static DoubleType LoadDouble(const double* pSource)
+            {
+                return _mm_loadu_pd(pSource);
+            }
+
+            inline static void StoreDouble(double* pDestination, DoubleType value)
+            {
+                _mm_storeu_pd(pDestination, value);
+            }
+
+            inline static DoubleType SetDouble(double value)
+            {
+                return _mm_set1_pd(value);
+            }
+
+            inline static DoubleType MulAddDouble(DoubleType a, DoubleType b, DoubleType c)
+            {
+                return _mm_add_pd(_mm_mul_pd(a, b), c);
+            }
+
+            inline static Type LoadInt32(const int32_t* pSource)
+            {
+                return _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource)));
+            }
+
+            //! \brief Round to the nearest integers using the current rounding mode, which is nearest-even by default.
+            inline static void StoreInt32(int32_t* pDestination, Type value)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination), _mm_cvtps_epi32(value));
+            }
+
+            inline static Type LoadInt16(const int16_t* pSource)
+            {
+                // Put the samples into the upper halves of the 32-bit lanes and shift them back to sign-extend.
+                const __m128i values = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSource));
+                return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16));
+            }
+
+            inline static void StoreInt16(int16_t* pDestination, Type value)
+            {
+                const __m128i values = _mm_cvtps_epi32(value);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(pDestination), _mm_packs_epi32(values, values));
+            }
+
+            inline static void StoreInterleaved2(float* pDestination, Type first, Type second)
+            {
+                _mm_storeu_ps(pDestination, _mm_unpacklo_ps(first, second));
+                _mm_storeu_ps(pDestination + 4, _mm_unpackhi_ps(first, second));
+            }
+
+            inline static void LoadDeinterleaved2(const float* pSource, Type& first, Type& second)
+            {
+                const __m128 low = _mm_loadu_ps(pSource);
+                const __m128 high = _mm_loadu_ps(pSource + 4);
+                first = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+                second = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+            }
+
+            inline static Type NextTriangularNoise(uint32_t* pState)
+            {
+                __m128i state = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pState));
+                state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+                state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+                state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pState), state);
+
+                const __m128i low = _mm_and_si128(state, _mm_set1_epi32(0xffff));
+                const __m128i difference = _mm_sub_epi32(_mm_srli_epi32(state, 16), low);
+                return _mm_mul_ps(_mm_cvtepi32_ps(difference), _mm_set1_ps(1.0f / 65536.0f));
+            }
+        };
+    } // namespace
+
+
+    const KernelTableSet kKernelTablesSSE2 = MakeKernelTableSet<VecSSE2>(KernelISA::SSE2);
+} // namespace quinte::audio::detail
@@ -0,0 +1,169 @@
+﻿#include <Audio/Kernels/KernelsImpl.hpp>
+
+namespace quinte::audio::detail
+{
+    namespace
+    {
+        //! \brief The reference implementation, one sample per iteration.
+        struct VecScalar final
+        {
+            using Type = float;
+            inline static constexpr uint64_t kWidth = 1;
+
+            //! \brief Holds kDoubleWidth samples widened to double precision.
+            using DoubleType = double;
+            inline static constexpr uint64_t kDoubleWidth = 1;
+
+            inline static Type Load(const float* pSource)
+            {
+                return *pSource;
+            }
+
+            inline static void Store(float* pDestination, Type value)
+            {
+                *pDestination = value;
+            }
+
+            inline static Type Set(float value)
+            {
+                return value;
+            }
+
+            inline static Type Lanes()
+            {
+                return 0.0f;
+            }
+
+            inline static Type Add(Type lhs, Type rhs)
+            {
+                return lhs + rhs;
+            }
+
+            inline static Type Mul(Type lhs, Type rhs)
+            {
+                return lhs * rhs;
+            }
+
+            inline static Type MulAdd(Type a, Type b, Type c)
+            {
+                return a * b + c;
+            }
+
+            inline static Type Max(Type lhs, Type rhs)
+            {
+                return lhs > rhs ? lhs : rhs;
+            }
+
+            inline static Type Min(Type lhs, Type rhs)
+            {
+                return lhs < rhs ? lhs : rhs;
+            }
+
+            inline static Type Abs(Type value)
+            {
+                return value < 0.0f ? -value : value;
+            }
+
+            inline static float ReduceAdd(Type value)
+            {
+                return value;
+            }
+
+            inline static float ReduceMax(Type value)
+            {
+                return value;
+            }
+
+            inline static DoubleType LoadWiden(const float* pSource)
+            {
+                return static_cast<double>(*pSource);
+            }
+
+            inline static void StoreNarrow(float* pDestination, DoubleType value)
+            {
+                *pDestination = static_cast<float>(value);
+            }
+
+            inline static DoubleType LoadDouble(const double* pSource)
+            {
+                return *pSource;
+            }
+
+            inline static void StoreDouble(double* pDestination, DoubleType value)
+            {
+                *pDestination = value;
+            }
+
+            inline static DoubleType SetDouble(double value)
+            {
+                return value;
+            }
+
+            inline static DoubleType MulAddDouble(DoubleType a, DoubleType b, DoubleType c)
+            {
+                return a * b + c;
+            }
+
+            inline static Type LoadInt32(const int32_t* pSource)
+            {
+                return static_cast<float>(*pSource);
+            }
+
+            //! \brief Round to the nearest integer, ties to even like the vector conversions.
+            inline static void StoreInt32(int32_t* pDestination, Type value)
+            {
+                // The cast truncates towards zero, the remainder is exact since the value is in the int32 range.
+                int32_t result = static_cast<int32_t>(value);
+                const float remainder = value - static_cast<float>(result);
+                if (remainder > 0.5f || (remainder == 0.5f && (result & 1)))
+                    ++result;
+                else if (remainder < -0.5f || (remainder == -0.5f && (result & 1)))
+                    --result;
+
+                *pDestination = result;
+            }
+
+            inline static Type LoadInt16(const int16_t* pSource)
+            {
+                return static_cast<float>(*pSource);
+            }
+
+            inline static void StoreInt16(int16_t* pDestination, Type value)
+            {
+                int32_t result;
+                StoreInt32(&result, value);
+                *pDestination = static_cast<int16_t>(result);
+            }
+
+            inline static void StoreInterleaved2(float* pDestination, Type first, Type second)
+            {
+                pDestination[0] = first;
+                pDestination[1] = second;
+            }
+
+            inline static void LoadDeinterleaved2(const float* pSource, Type& first, Type& second)
+            {
+                first = pSource[0];
+                second = pSource[1];
+            }
+
+            //! \brief Step the xorshift32 generator and subtract the low 16 bits of the state from the high 16 bits.
+            //!
+            //! The difference of two uniform variables has the triangular distribution.
+            inline static Type NextTriangularNoise(uint32_t* pState)
+            {
+                uint32_t state = *pState;
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                *pState = state;
+
+                const int32_t difference = static_cast<int32_t>(state >> 16) - static_cast<int32_t>(state & 0xffff);
+                return static_cast<float>(difference) * (1.0f / 65536.0f);
+            }
+        };
+    } // namespace
+
+
+    const KernelTableSet kKernelTablesScalar = MakeKernelTableSet<VecScalar>(KernelISA::Scalar);
+} // namespace quinte::audio::detail
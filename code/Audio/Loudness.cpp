@@ -0,0 +1,221 @@
+﻿#include <Audio/Loudness.hpp>
+#include <cmath>
+#include <numbers>
+
+namespace quinte::audio
+{
+    namespace
+    {
+        inline float ConvertEnergyToLoudness(double energy)
+        {
+            if (energy <= 0.0)
+                return -std::numeric_limits<float>::infinity();
+
+            return static_cast<float>(-0.691 + 10.0 * std::log10(energy));
+        }
+
+
+        inline double ConvertLoudnessToEnergy(double loudness)
+        {
+            return std::pow(10.0, (loudness + 0.691) / 10.0);
+        }
+    } // namespace
+
+
+    void LoudnessMeter::Initialize(uint32_t sampleRate)
+    {
+        QU_Assert(sampleRate > 0);
+
+        // The K-weighting filters of BS.1770 are specified for 48 kHz only, the analog prototypes below
+        // reproduce them at 48 kHz and are used to compute the coefficients for the other sample rates.
+        const double rate = static_cast<double>(sampleRate);
+        {
+            const double f0 = 1681.974450955533;
+            const double gain = 3.999843853973347;
+            const double q = 0.7071752369554196;
+
+            const double k = std::tan(std::numbers::pi * f0 / rate);
+            const double vh = std::pow(10.0, gain / 20.0);
+            const double vb = std::pow(vh, 0.4996667741545416);
+            const double a0 = 1.0 + k / q + k * k;
+
+            m_PreFilter.B0 = (vh + vb * k / q + k * k) / a0;
+            m_PreFilter.B1 = 2.0 * (k * k - vh) / a0;
+            m_PreFilter.B2 = (vh - vb * k / q + k * k) / a0;
+            m_PreFilter.A1 = 2.0 * (k * k - 1.0) / a0;
+            m_PreFilter.A2 = (1.0 - k / q + k * k) / a0;
+        }
+        {
+            const double f0 = 38.13547087602444;
+            const double q = 0.5003270373238773;
+
+            const double k = std::tan(std::numbers::pi * f0 / rate);
+            const double a0 = 1.0 + k / q + k * k;
+
+            m_HighPassFilter.B0 = 1.0;
+            m_HighPassFilter.B1 = -2.0;
+            m_HighPassFilter.B2 = 1.0;
+            m_HighPassFilter.A1 = 2.0 * (k * k - 1.0) / a0;
+            m_HighPassFilter.A2 = (1.0 - k / q + k * k) / a0;
+        }
+
+        m_SubBlockLength = Max<uint64_t>((sampleRate + 5) / 10, 1);
+        Reset();
+    }
+
+
+    void LoudnessMeter::Reset()
+    {
+        for (uint32_t channelIndex = 0; channelIndex < kMaxLoudnessChannelCount; ++channelIndex)
+        {
+            m_PreFilterStates[channelIndex] = {};
+            m_HighPassFilterStates[channelIndex] = {};
+        }
+
+        m_SubBlockSampleCount = 0;
+        m_SubBlockSum = 0.0;
+        m_CompletedSubBlockCount = 0;
+        memory::Zero(m_SubBlockEnergies, kShortTermSubBlockCount);
+        memory::Zero(m_HistogramCounts, kHistogramBinCount);
+        memory::Zero(m_HistogramEnergies, kHistogramBinCount);
+    }
+
+
+    double LoudnessMeter::GetMeanEnergy(uint32_t subBlockCount) const
+    {
+        double sum = 0.0;
+        for (uint32_t index = 0; index < subBlockCount; ++index)
+        {
+            const uint64_t subBlockIndex = m_CompletedSubBlockCount - 1 - index;
+            sum += m_SubBlockEnergies[subBlockIndex % kShortTermSubBlockCount];
+        }
+
+        return sum / static_cast<double>(subBlockCount);
+    }
+
+
+    void LoudnessMeter::FinishSubBlock()
+    {
+        m_SubBlockEnergies[m_CompletedSubBlockCount % kShortTermSubBlockCount] =
+            m_SubBlockSum / static_cast<double>(m_SubBlockLength);
+        ++m_CompletedSubBlockCount;
+        m_SubBlockSampleCount = 0;
+        m_SubBlockSum = 0.0;
+
+        if (m_CompletedSubBlockCount < kMomentarySubBlockCount)
+            return;
+
+        // A new gating block ends every sub-block. The blocks below the absolute gate never contribute
+        // to the integrated loudness, so we don't even count them.
+        const double blockEnergy = GetMeanEnergy(kMomentarySubBlockCount);
+        const float blockLoudness = ConvertEnergyToLoudness(blockEnergy);
+        if (blockLoudness < kHistogramMinLoudness)
+            return;
+
+        const float binPosition = (blockLoudness - kHistogramMinLoudness) * kHistogramBinsPerLU;
+        const uint32_t binIndex = Min(static_cast<uint32_t>(binPosition), kHistogramBinCount - 1);
+        ++m_HistogramCounts[binIndex];
+        m_HistogramEnergies[binIndex] += blockEnergy;
+    }
+
+
+    bool LoudnessMeter::Process(std::span<const float* const> channels, uint64_t sampleCount)
+    {
+        QU_Assert(m_SubBlockLength > 0);
+        QU_Assert(channels.size() <= kMaxLoudnessChannelCount);
+
+        bool subBlockFinished = false;
+        uint64_t offset = 0;
+        while (offset < sampleCount)
+        {
+            const uint64_t length = Min(sampleCount - offset, m_SubBlockLength - m_SubBlockSampleCount);
+
+            double sum = 0.0;
+            for (uint32_t channelIndex = 0; channelIndex < channels.size(); ++channelIndex)
+            {
+                const float* pSource = channels[channelIndex] + offset;
+                FilterState preFilterState = m_PreFilterStates[channelIndex];
+                FilterState highPassFilterState = m_HighPassFilterStates[channelIndex];
+
+                // Both filters are in the transposed direct form II.
+                for (uint64_t sampleIndex = 0; sampleIndex < length; ++sampleIndex)
+                {
+                    const double input = static_cast<double>(pSource[sampleIndex]);
+
+                    const Biquad& pre = m_PreFilter;
+                    const double preOutput = pre.B0 * input + preFilterState.Z1;
+                    preFilterState.Z1 = pre.B1 * input - pre.A1 * preOutput + preFilterState.Z2;
+                    preFilterState.Z2 = pre.B2 * input - pre.A2 * preOutput;
+
+                    const Biquad& hp = m_HighPassFilter;
+                    const double output = hp.B0 * preOutput + highPassFilterState.Z1;
+                    highPassFilterState.Z1 = hp.B1 * preOutput - hp.A1 * output + highPassFilterState.Z2;
+                    highPassFilterState.Z2 = hp.B2 * preOutput - hp.A2 * output;
+
+                    sum += output * output;
+                }
+
+                m_PreFilterStates[channelIndex] = preFilterState;
+                m_HighPassFilterStates[channelIndex] = highPassFilterState;
+            }
+
+            m_SubBlockSum += sum;
+            m_SubBlockSampleCount += length;
+            offset += length;
+
+            if (m_SubBlockSampleCount == m_SubBlockLength)
+            {
+                FinishSubBlock();
+                subBlockFinished = true;
+            }
+        }
+
+        return subBlockFinished;
+    }
+
+
+    LoudnessStats LoudnessMeter::GetStats() const
+    {
+        LoudnessStats result;
+        if (m_CompletedSubBlockCount >= kMomentarySubBlockCount)
+            result.Momentary = ConvertEnergyToLoudness(GetMeanEnergy(kMomentarySubBlockCount));
+        if (m_CompletedSubBlockCount >= kShortTermSubBlockCount)
+            result.ShortTerm = ConvertEnergyToLoudness(GetMeanEnergy(kShortTermSubBlockCount));
+
+        // The relative gate is 10 LU below the loudness of the blocks above the absolute gate.
+        uint64_t totalCount = 0;
+        double totalEnergy = 0.0;
+        for (uint32_t binIndex = 0; binIndex < kHistogramBinCount; ++binIndex)
+        {
+            totalCount += m_HistogramCounts[binIndex];
+            totalEnergy += m_HistogramEnergies[binIndex];
+        }
+
+        if (totalCount == 0)
+            return result;
+
+        const double relativeGate = ConvertEnergyToLoudness(totalEnergy / static_cast<double>(totalCount)) - 10.0;
+        const double gateEnergy = ConvertLoudnessToEnergy(relativeGate);
+
+        uint64_t gatedCount = 0;
+        double gatedEnergy = 0.0;
+        for (uint32_t binIndex = 0; binIndex < kHistogramBinCount; ++binIndex)
+        {
+            if (m_HistogramCounts[binIndex] == 0)
+                continue;
+
+            // The blocks of a bin are within 0.1 LU of each other, so the bin is gated by its mean energy.
+            const double binMeanEnergy = m_HistogramEnergies[binIndex] / static_cast<double>(m_HistogramCounts[binIndex]);
+            if (binMeanEnergy <= gateEnergy)
+                continue;
+
+            gatedCount += m_HistogramCounts[binIndex];
+            gatedEnergy += m_HistogramEnergies[binIndex];
+        }
+
+        if (gatedCount > 0)
+            result.Integrated = ConvertEnergyToLoudness(gatedEnergy / static_cast<double>(gatedCount));
+
+        return result;
+    }
+} // namespace quinte::audio
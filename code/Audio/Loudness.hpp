@@ -0,0 +1,87 @@
+﻿#pragma once
+#include <Core/Core.hpp>
+
+namespace quinte::audio
+{
+    //! \brief The maximum number of channels the loudness meter can measure.
+    inline constexpr uint32_t kMaxLoudnessChannelCount = 8;
+
+
+    //! \brief The loudness of the measured signal in LUFS, negative infinity if there's not enough data yet.
+    struct LoudnessStats final
+    {
+        //! \brief The loudness of the last 400 ms.
+        float Momentary = -std::numeric_limits<float>::infinity();
+
+        //! \brief The loudness of the last 3 s.
+        float ShortTerm = -std::numeric_limits<float>::infinity();
+
+        //! \brief The gated loudness of the whole signal since the last reset.
+        float Integrated = -std::numeric_limits<float>::infinity();
+    };
+
+
+    //! \brief A streaming loudness meter as defined by ITU-R BS.1770-4 and EBU R 128.
+    //!
+    //! The signal is K-weighted and measured in 100 ms sub-blocks, the gating blocks are 400 ms long
+    //! with 75% overlap. The gating blocks are not stored: their energies are accumulated in a histogram
+    //! with 0.1 LU bins, so the memory doesn't grow with the length of the measurement. The integrated
+    //! loudness is computed from the histogram with the same resolution.
+    //!
+    //! All the channels are weighted equally, the surround channel weights are not applied.
+    class LoudnessMeter final
+    {
+        inline static constexpr uint32_t kMomentarySubBlockCount = 4;
+        inline static constexpr uint32_t kShortTermSubBlockCount = 30;
+
+        inline static constexpr float kHistogramMinLoudness = -70.0f;
+        inline static constexpr float kHistogramBinsPerLU = 10.0f;
+        inline static constexpr uint32_t kHistogramBinCount = 1000;
+
+        struct Biquad final
+        {
+            double B0, B1, B2, A1, A2;
+        };
+
+        struct FilterState final
+        {
+            double Z1 = 0.0;
+            double Z2 = 0.0;
+        };
+
+        Biquad m_PreFilter{};
+        Biquad m_HighPassFilter{};
+        FilterState m_PreFilterStates[kMaxLoudnessChannelCount];
+        FilterState m_HighPassFilterStates[kMaxLoudnessChannelCount];
+
+        uint64_t m_SubBlockLength = 0;
+        uint64_t m_SubBlockSampleCount = 0;
+        double m_SubBlockSum = 0.0;
+
+        double m_SubBlockEnergies[kShortTermSubBlockCount] = {};
+        uint64_t m_CompletedSubBlockCount = 0;
+
+        uint32_t m_HistogramCounts[kHistogramBinCount] = {};
+        double m_HistogramEnergies[kHistogramBinCount] = {};
+
+        void FinishSubBlock();
+        double GetMeanEnergy(uint32_t subBlockCount) const;
+
+    public:
+        //! \brief Compute the filters for the sample rate and reset the measurement.
+        void Initialize(uint32_t sampleRate);
+
+        //! \brief Reset the measurement, the filters are kept.
+        void Reset();
+
+        //! \brief Process a block of samples.
+        //!
+        //! \param channels    - The channel data, all the channels must have sampleCount samples.
+        //! \param sampleCount - The number of samples to process.
+        //!
+        //! \return True if a sub-block was completed and the stats have changed.
+        bool Process(std::span<const float* const> channels, uint64_t sampleCount);
+
+        [[nodiscard]] LoudnessStats GetStats() const;
+    };
+} // namespace quinte::audio
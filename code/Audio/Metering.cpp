@@ -0,0 +1,75 @@
+﻿#include <Audio/Metering.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace quinte::audio
+{
+    namespace
+    {
+        // The polyphase interpolation filter from ITU-R BS.1770-4, Annex 2: 48 taps split into 4 phases.
+        constexpr float kTruePeakCoefficients[4][12] = {
+            { 0.0017089843750f, 0.0109863281250f, -0.0196533203125f, 0.0332031250000f, -0.0594482421875f, 0.1373291015625f,
+              0.9721679687500f, -0.1022949218750f, 0.0476074218750f, -0.0266113281250f, 0.0148925781250f, -0.0083007812500f },
+            { -0.0291748046875f, 0.0292968750000f, -0.0517578125000f, 0.0891113281250f, -0.1665039062500f, 0.4650878906250f,
+              0.7797851562500f, -0.2003173828125f, 0.1015625000000f, -0.0582275390625f, 0.0330810546875f, -0.0189208984375f },
+            { -0.0189208984375f, 0.0330810546875f, -0.0582275390625f, 0.1015625000000f, -0.2003173828125f, 0.7797851562500f,
+              0.4650878906250f, -0.1665039062500f, 0.0891113281250f, -0.0517578125000f, 0.0292968750000f, -0.0291748046875f },
+            { -0.0083007812500f, 0.0148925781250f, -0.0266113281250f, 0.0476074218750f, -0.1022949218750f, 0.9721679687500f,
+              0.1373291015625f, -0.0594482421875f, 0.0332031250000f, -0.0196533203125f, 0.0109863281250f, 0.0017089843750f },
+        };
+    } // namespace
+
+
+    float TruePeakDetector::Process(const float* pSource, uint64_t sampleCount)
+    {
+        constexpr uint32_t kHistoryLength = kTapCount - 1;
+
+        float peak = 0.0f;
+        while (sampleCount > 0)
+        {
+            const uint32_t chunkLength = static_cast<uint32_t>(Min<uint64_t>(sampleCount, kChunkSize));
+            memory::Copy(m_Buffer + kHistoryLength, pSource, chunkLength);
+
+            for (uint32_t sampleIndex = 0; sampleIndex < chunkLength; ++sampleIndex)
+            {
+                // The newest sample of the window is at pWindow[kHistoryLength].
+                const float* pWindow = m_Buffer + sampleIndex;
+                for (uint32_t phaseIndex = 0; phaseIndex < kPhaseCount; ++phaseIndex)
+                {
+                    float value = 0.0f;
+                    for (uint32_t tapIndex = 0; tapIndex < kTapCount; ++tapIndex)
+                        value += kTruePeakCoefficients[phaseIndex][tapIndex] * pWindow[kHistoryLength - tapIndex];
+
+                    peak = Max(peak, std::abs(value));
+                }
+            }
+
+            // The ranges overlap for short chunks, std::copy handles it since we copy towards the beginning.
+            std::copy(m_Buffer + chunkLength, m_Buffer + chunkLength + kHistoryLength, m_Buffer);
+
+            pSource += chunkLength;
+            sampleCount -= chunkLength;
+        }
+
+        return peak;
+    }
+
+
+    TrackMeter MeterAccumulator::GetMeter() const
+    {
+        TrackMeter result;
+        result.ChannelCount = m_ChannelCount;
+        if (m_SampleCount == 0)
+            return result;
+
+        for (uint32_t channelIndex = 0; channelIndex < m_ChannelCount; ++channelIndex)
+        {
+            ChannelMeter& channel = result.Channels[channelIndex];
+            channel.Peak = m_Peak[channelIndex];
+            channel.RMS = std::sqrt(m_SumOfSquares[channelIndex] / static_cast<float>(m_SampleCount));
+            channel.TruePeak = m_TruePeak[channelIndex];
+        }
+
+        return result;
+    }
+} // namespace quinte::audio
@@ -0,0 +1,108 @@
+﻿#pragma once
+#include <Audio/Kernels/Kernels.hpp>
+#include <Core/Core.hpp>
+
+namespace quinte::audio
+{
+    //! \brief The maximum number of channels a track meter shows, the rest are not metered.
+    inline constexpr uint32_t kMaxMeterChannelCount = 2;
+
+    //! \brief The number of samples to accumulate the meter values over before publishing them.
+    //!
+    //! About 20 ms at 48 kHz, so the UI polling at frame rate sees every window.
+    inline constexpr uint64_t kMeterWindowSampleCount = 1024;
+
+
+    //! \brief The levels of a single channel over the last meter window, linear amplitudes.
+    struct ChannelMeter final
+    {
+        float Peak = 0.0f;
+        float RMS = 0.0f;
+
+        //! \brief The peak of the 4x oversampled signal, zero if true peak metering is disabled for the track.
+        float TruePeak = 0.0f;
+    };
+
+
+    //! \brief The output levels of a track over the last meter window.
+    struct TrackMeter final
+    {
+        ChannelMeter Channels[kMaxMeterChannelCount];
+        uint32_t ChannelCount = 0;
+
+        //! \brief Get the maximum peak of all the channels.
+        [[nodiscard]] inline float GetPeak() const
+        {
+            float result = 0.0f;
+            for (uint32_t channelIndex = 0; channelIndex < ChannelCount; ++channelIndex)
+                result = Max(result, Channels[channelIndex].Peak);
+            return result;
+        }
+    };
+
+
+    //! \brief Estimates the inter-sample peaks by upsampling the signal 4x (ITU-R BS.1770-4, Annex 2).
+    //!
+    //! Keeps the last input samples between the calls, so the blocks must be consecutive.
+    class TruePeakDetector final
+    {
+        inline static constexpr uint32_t kPhaseCount = 4;
+        inline static constexpr uint32_t kTapCount = 12;
+        inline static constexpr uint32_t kChunkSize = 64;
+
+        float m_Buffer[kTapCount - 1 + kChunkSize] = {};
+
+    public:
+        //! \brief Process a block of samples and get the maximum absolute value of the upsampled signal.
+        float Process(const float* pSource, uint64_t sampleCount);
+
+        inline void Reset()
+        {
+            *this = {};
+        }
+    };
+
+
+    //! \brief Accumulates the output levels of a track over a meter window, used on the audio thread.
+    class MeterAccumulator final
+    {
+        float m_Peak[kMaxMeterChannelCount] = {};
+        float m_SumOfSquares[kMaxMeterChannelCount] = {};
+        float m_TruePeak[kMaxMeterChannelCount] = {};
+        uint64_t m_SampleCount = 0;
+        uint32_t m_ChannelCount = 0;
+
+    public:
+        inline void Add(uint32_t channelIndex, BlockLevels levels)
+        {
+            if (channelIndex >= kMaxMeterChannelCount)
+                return;
+
+            m_Peak[channelIndex] = Max(m_Peak[channelIndex], levels.Peak);
+            m_SumOfSquares[channelIndex] += levels.SumOfSquares;
+            m_ChannelCount = Max(m_ChannelCount, channelIndex + 1);
+        }
+
+        inline void AddTruePeak(uint32_t channelIndex, float truePeak)
+        {
+            if (channelIndex < kMaxMeterChannelCount)
+                m_TruePeak[channelIndex] = Max(m_TruePeak[channelIndex], truePeak);
+        }
+
+        //! \brief Advance the window after the levels of all the channels were added.
+        //!
+        //! \return True if the window is full and the meter should be published.
+        inline bool Advance(uint64_t sampleCount)
+        {
+            m_SampleCount += sampleCount;
+            return m_SampleCount >= kMeterWindowSampleCount;
+        }
+
+        [[nodiscard]] TrackMeter GetMeter() const;
+
+        inline void Reset()
+        {
+            *this = {};
+        }
+    };
+} // namespace quinte::audio
@@ -52,7 +52,7 @@ namespace quinte
 
         SmallVector<audio::PortHandle, 2> m_Sources;
         SmallVector<audio::PortHandle, 2> m_Destinations;
-        void* m_pOwner;
+        void* m_pOwner = nullptr;
         audio::PortHandle m_Handle;
         std::atomic<uint32_t> m_RefCount;
         audio::PortDesc m_Desc;
@@ -117,6 +117,12 @@ namespace quinte
             return nullptr;
         }
 
+        inline void SetOwner(Track* pTrack)
+        {
+            QU_AssertDebug(m_Desc.Kind == audio::PortKind::Track);
+            m_pOwner = pTrack;
+        }
+
         [[nodiscard]] virtual BaseBufferView* GetBufferView() = 0;
         [[nodiscard]] virtual const BaseBufferView* GetBufferView() const = 0;
 
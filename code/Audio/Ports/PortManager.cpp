@@ -80,6 +80,26 @@ namespace quinte
     }
 
 
+    void PortManager::DisconnectPorts(Port* pSource, Port* pDestination)
+    {
+        QU_AssertDebug(pSource->IsOutput() && pDestination->IsInput());
+        const size_t destinationIndex = FindIndex(pSource->m_Destinations, pDestination->m_Handle);
+        if (destinationIndex == InvalidIndex)
+        {
+            QU_AssertDebug(FindIndex(pDestination->m_Sources, pSource->m_Handle) == InvalidIndex);
+            return;
+        }
+
+        const size_t sourceIndex = FindIndex(pDestination->m_Sources, pSource->m_Handle);
+        QU_AssertDebug(sourceIndex != InvalidIndex);
+
+        pSource->m_Destinations[destinationIndex] = pSource->m_Destinations.back();
+        pSource->m_Destinations.pop_back();
+        pDestination->m_Sources[sourceIndex] = pDestination->m_Sources.back();
+        pDestination->m_Sources.pop_back();
+    }
+
+
     void PortManager::DeletePort(Port* pPort)
     {
         const audio::PortHandle portHandle = pPort->m_Handle;
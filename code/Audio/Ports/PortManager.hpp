@@ -12,6 +12,7 @@ namespace quinte
     {
         friend class Port;
         friend class AudioPort;
+        friend class DelayLine;
 
         MemoryPool m_AudioPortPool;
         MemoryPool m_AudioBufferPool;
@@ -47,6 +48,7 @@ namespace quinte
         AudioPort* NewAudioPort(const audio::PortDesc& desc);
 
         void ConnectPorts(Port* pSource, Port* pDestination);
+        void DisconnectPorts(Port* pSource, Port* pDestination);
 
         inline void ConnectPorts(audio::PortHandle source, Port* pDestination)
         {
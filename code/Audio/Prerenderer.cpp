@@ -0,0 +1,89 @@
+﻿#include <Audio/Kernels/Denormals.hpp>
+#include <Audio/Prerenderer.hpp>
+
+namespace quinte
+{
+    void Prerenderer::PrerenderThread(void* pUserData)
+    {
+        static_cast<Prerenderer*>(pUserData)->PrerenderThreadImpl();
+    }
+
+
+    void Prerenderer::PrerenderThreadImpl()
+    {
+        // The clips are read here instead of the audio thread, so the same floating-point mode must apply.
+        audio::DisableDenormals();
+
+        while (!m_ExitRequested.load(std::memory_order_acquire))
+        {
+            if (RenderTracks())
+                continue;
+
+            // The audio thread could have consumed some samples between the check and the wait,
+            // so we look for work once more after announcing that we are going to wait.
+            m_Signal.PrepareWait();
+            if (RenderTracks() || m_ExitRequested.load(std::memory_order_acquire))
+            {
+                m_Signal.CancelWait();
+                continue;
+            }
+
+            m_Signal.Wait();
+        }
+    }
+
+
+    bool Prerenderer::RenderTracks()
+    {
+        std::lock_guard lock{ m_Mutex };
+
+        // One block per track at a time, so that a track far behind doesn't starve the others.
+        bool rendered = false;
+        for (const Rc<Track>& pTrack : m_Tracks)
+        {
+            // The armed and monitored tracks are processed live, their clips are read directly by the audio thread.
+            if (pTrack->IsRecordArmed() || pTrack->IsMonitored())
+                continue;
+
+            PrerenderBuffer* pBuffer = pTrack->GetPrerenderBuffer();
+            if (!pBuffer->BeginRender())
+                continue;
+
+            const Rc<PlaylistSnapshot> pPlaylist = pTrack->GetPlaylistSnapshot();
+            if (!pPlaylist)
+                continue;
+
+            pBuffer->Render(pPlaylist->Get());
+            rendered = true;
+        }
+
+        return rendered;
+    }
+
+
+    Prerenderer::Prerenderer()
+    {
+        m_Thread = threading::CreateThread("Prerender", &PrerenderThread, this, threading::Priority::AboveNormal);
+    }
+
+
+    Prerenderer::~Prerenderer()
+    {
+        m_ExitRequested.store(true, std::memory_order_release);
+        m_Signal.Wake();
+        threading::CloseThread(m_Thread);
+    }
+
+
+    void Prerenderer::SetTracks(std::span<const Rc<Track>> tracks)
+    {
+        std::lock_guard lock{ m_Mutex };
+
+        m_Tracks.clear();
+        for (const Rc<Track>& pTrack : tracks)
+        {
+            if (pTrack->GetPrerenderBuffer())
+                m_Tracks.push_back(pTrack);
+        }
+    }
+} // namespace quinte
@@ -0,0 +1,41 @@
+﻿#pragma once
+#include <Audio/Tracks/Track.hpp>
+#include <Core/Threading.hpp>
+
+namespace quinte
+{
+    //! \brief A background thread that renders the clips of the tracks ahead of the playhead.
+    //!
+    //! The clips are rendered into the PrerenderBuffer of each track, the audio thread then only copies
+    //! the samples instead of reading the clips. If the playhead jumps (seek, loop), the buffer is restarted
+    //! from the new position and the audio thread reads the clips directly until it catches up.
+    //!
+    //! The clips are read from the playlist snapshots, so the UI thread can edit the playlists at the same time.
+    //! The armed and monitored tracks are skipped. When all the buffers are full, the thread waits
+    //! until the audio thread consumes some samples.
+    class Prerenderer final : public NoCopyMove
+    {
+        threading::Mutex m_Mutex;
+        std::pmr::vector<Rc<Track>> m_Tracks;
+        std::atomic<bool> m_ExitRequested = false;
+        PrerenderSignal m_Signal;
+        threading::ThreadHandle m_Thread;
+
+        static void PrerenderThread(void* pUserData);
+        void PrerenderThreadImpl();
+        bool RenderTracks();
+
+    public:
+        Prerenderer();
+        ~Prerenderer();
+
+        //! \brief Get the signal the pre-render buffers must notify when their samples are consumed.
+        [[nodiscard]] inline PrerenderSignal* GetSignal()
+        {
+            return &m_Signal;
+        }
+
+        //! \brief Replace the set of tracks to render, only the tracks that have a pre-render buffer are used.
+        void SetTracks(std::span<const Rc<Track>> tracks);
+    };
+} // namespace quinte
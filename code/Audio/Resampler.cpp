@@ -0,0 +1,314 @@
+﻿#include <Audio/Kernels/Kernels.hpp>
+#include <Audio/Resampler.hpp>
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+
+namespace quinte::audio
+{
+    namespace
+    {
+        struct FilterDesc final
+        {
+            uint32_t TapCount;
+            double KaiserBeta;
+            double Rolloff;
+        };
+
+
+        inline FilterDesc GetFilterDesc(ResamplerQuality quality)
+        {
+            switch (quality)
+            {
+            case ResamplerQuality::Draft:
+                return { 16, 6.0, 0.90 };
+            case ResamplerQuality::Best:
+            default:
+                return { 64, 10.0, 0.95 };
+            }
+        }
+
+
+        //! \brief The zeroth order modified Bessel function of the first kind.
+        inline double BesselI0(double x)
+        {
+            double result = 1.0;
+            double term = 1.0;
+            for (uint32_t k = 1; k < 64; ++k)
+            {
+                const double factor = x / (2.0 * static_cast<double>(k));
+                term *= factor * factor;
+                result += term;
+                if (term < result * 1e-16)
+                    break;
+            }
+
+            return result;
+        }
+    } // namespace
+
+
+    ResamplerFilter::ResamplerFilter(uint32_t inSampleRate, uint32_t outSampleRate, ResamplerQuality quality)
+    {
+        QU_Assert(inSampleRate > 0 && outSampleRate > 0);
+
+        const uint32_t divisor = std::gcd(inSampleRate, outSampleRate);
+        m_InterpolationFactor = outSampleRate / divisor;
+        m_DecimationFactor = inSampleRate / divisor;
+        m_PhaseCount = Min(m_InterpolationFactor, kMaxPhaseCount);
+
+        // When decimating the cutoff is below the input Nyquist frequency, the filter is made longer accordingly
+        // to keep the same transition band relative to the cutoff.
+        const FilterDesc desc = GetFilterDesc(quality);
+        const double ratio = Min(1.0, static_cast<double>(m_InterpolationFactor) / static_cast<double>(m_DecimationFactor));
+        const double cutoff = desc.Rolloff * ratio;
+        const double tapCount = std::ceil(static_cast<double>(desc.TapCount) / ratio);
+        m_TapCount = Min(AlignUp(static_cast<uint32_t>(tapCount), 8u), kMaxTapCount);
+
+        // The extra phase is the first one shifted by one sample, the interpolation between phases needs it.
+        const uint32_t storedPhaseCount = m_PhaseCount + 1;
+        const uint64_t coefficientCount = static_cast<uint64_t>(storedPhaseCount) * m_TapCount;
+        m_pCoefficients = memory::DefaultAlloc<float>(coefficientCount * sizeof(float), memory::kCacheLineSize);
+
+        const double halfLength = static_cast<double>(m_TapCount / 2);
+        const double historyLength = static_cast<double>(GetHistoryLength());
+        const double windowScale = 1.0 / BesselI0(desc.KaiserBeta);
+        for (uint32_t phaseIndex = 0; phaseIndex < storedPhaseCount; ++phaseIndex)
+        {
+            // The output sample is between the input samples historyLength and historyLength + 1 of the window.
+            const double center = historyLength + static_cast<double>(phaseIndex) / static_cast<double>(m_PhaseCount);
+            float* pPhase = m_pCoefficients + static_cast<uint64_t>(phaseIndex) * m_TapCount;
+
+            double sum = 0.0;
+            double taps[kMaxTapCount];
+            for (uint32_t tapIndex = 0; tapIndex < m_TapCount; ++tapIndex)
+            {
+                const double t = static_cast<double>(tapIndex) - center;
+                const double x = std::numbers::pi * cutoff * t;
+                const double sinc = t == 0.0 ? 1.0 : std::sin(x) / x;
+
+                const double position = Min(std::abs(t) / halfLength, 1.0);
+                const double window = BesselI0(desc.KaiserBeta * std::sqrt(1.0 - position * position)) * windowScale;
+
+                taps[tapIndex] = cutoff * sinc * window;
+                sum += taps[tapIndex];
+            }
+
+            // Normalize every phase to unity gain at DC, otherwise the phases would modulate the constant signals.
+            for (uint32_t tapIndex = 0; tapIndex < m_TapCount; ++tapIndex)
+                pPhase[tapIndex] = static_cast<float>(taps[tapIndex] / sum);
+        }
+    }
+
+
+    ResamplerFilter::~ResamplerFilter()
+    {
+        memory::SafeFree(m_pCoefficients);
+    }
+
+
+    Resampler::~Resampler()
+    {
+        memory::SafeFree(m_pInput);
+    }
+
+
+    void Resampler::Initialize(ResamplerFilter* pFilter, uint32_t channelCount, uint32_t maxInputCount)
+    {
+        QU_Assert(pFilter && channelCount > 0);
+        memory::SafeFree(m_pInput);
+
+        // The unused input is kept when the output is limited, so leave space for another filter length.
+        m_pFilter = pFilter;
+        m_ChannelCount = channelCount;
+        m_InputCapacity = AlignUp(maxInputCount + 2 * pFilter->GetTapCount(), memory::kCacheLineSize / sizeof(float));
+
+        const uint64_t totalSampleCount = static_cast<uint64_t>(m_InputCapacity) * channelCount;
+        m_pInput = memory::DefaultAlloc<float>(totalSampleCount * sizeof(float), memory::kCacheLineSize);
+
+        Reset();
+    }
+
+
+    void Resampler::Reset()
+    {
+        [[maybe_unused]] const uint64_t firstInputIndex = Seek(0);
+        QU_AssertDebug(firstInputIndex == 0);
+    }
+
+
+    uint64_t Resampler::Seek(uint64_t outputIndex)
+    {
+        const uint64_t interpolation = m_pFilter->GetInterpolationFactor();
+        const uint64_t decimation = m_pFilter->GetDecimationFactor();
+
+        // Split the index to avoid overflowing outputIndex * decimation.
+        const uint64_t quotient = outputIndex / interpolation;
+        const uint64_t remainder = outputIndex % interpolation;
+        const uint64_t inputIndex = quotient * decimation + remainder * decimation / interpolation;
+
+        m_Phase = static_cast<uint32_t>(remainder * decimation % interpolation);
+        m_InputPosition = 0;
+        m_InputLength = 0;
+
+        // The window starts before the first input sample at the beginning of the stream, pad it with silence.
+        const uint64_t historyLength = m_pFilter->GetHistoryLength();
+        if (inputIndex >= historyLength)
+            return inputIndex - historyLength;
+
+        const uint32_t paddingLength = static_cast<uint32_t>(historyLength - inputIndex);
+        for (uint32_t channelIndex = 0; channelIndex < m_ChannelCount; ++channelIndex)
+            memory::Zero(GetChannelInput(channelIndex), paddingLength);
+
+        m_InputLength = paddingLength;
+        return 0;
+    }
+
+
+    uint32_t Resampler::GetAvailableOutputCount() const
+    {
+        const uint32_t tapCount = m_pFilter->GetTapCount();
+        if (m_InputPosition + tapCount > m_InputLength)
+            return 0;
+
+        // The output k reads the window starting at m_InputPosition + (m_Phase + k * M) / L.
+        const uint64_t interpolation = m_pFilter->GetInterpolationFactor();
+        const uint64_t decimation = m_pFilter->GetDecimationFactor();
+        const uint64_t windowCount = m_InputLength - m_InputPosition - tapCount + 1;
+        return static_cast<uint32_t>(CeilDivide(windowCount * interpolation - m_Phase, decimation));
+    }
+
+
+    uint32_t Resampler::GetRequiredInputCount(uint32_t outputCount) const
+    {
+        if (outputCount == 0)
+            return 0;
+
+        const uint64_t interpolation = m_pFilter->GetInterpolationFactor();
+        const uint64_t decimation = m_pFilter->GetDecimationFactor();
+        const uint64_t lastWindowStart = m_InputPosition + (m_Phase + (outputCount - 1) * decimation) / interpolation;
+        const uint64_t requiredLength = lastWindowStart + m_pFilter->GetTapCount();
+        return requiredLength > m_InputLength ? static_cast<uint32_t>(requiredLength - m_InputLength) : 0;
+    }
+
+
+    void Resampler::Compact()
+    {
+        if (m_InputPosition == 0)
+            return;
+
+        const uint32_t length = m_InputLength - m_InputPosition;
+        for (uint32_t channelIndex = 0; channelIndex < m_ChannelCount; ++channelIndex)
+        {
+            float* pInput = GetChannelInput(channelIndex);
+            std::copy(pInput + m_InputPosition, pInput + m_InputLength, pInput);
+        }
+
+        m_InputLength = length;
+        m_InputPosition = 0;
+    }
+
+
+    void Resampler::PushChannel(uint32_t channelIndex, const float* pSource, uint64_t sourceStride, uint32_t sampleCount)
+    {
+        float* pInput = GetChannelInput(channelIndex) + m_InputLength;
+        if (sourceStride == 1)
+        {
+            memory::Copy(pInput, pSource, sampleCount);
+            return;
+        }
+
+        for (uint32_t sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex)
+            pInput[sampleIndex] = pSource[sampleIndex * sourceStride];
+    }
+
+
+    void Resampler::GenerateChannel(uint32_t channelIndex, float* pDestination, uint64_t destinationStride,
+                                    uint32_t sampleCount) const
+    {
+        const KernelTable& kernels = GetKernels();
+        const ResamplerFilter& filter = *m_pFilter;
+        const uint32_t interpolation = filter.GetInterpolationFactor();
+        const uint32_t decimation = filter.GetDecimationFactor();
+        const uint32_t tapCount = filter.GetTapCount();
+        const float* pInput = GetChannelInput(channelIndex);
+
+        uint32_t position = m_InputPosition;
+        uint32_t phase = m_Phase;
+        for (uint32_t sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex)
+        {
+            const float* pWindow = pInput + position;
+
+            float result;
+            if (filter.IsExact())
+            {
+                result = kernels.DotProduct(filter.GetPhase(phase), pWindow, tapCount);
+            }
+            else
+            {
+                const uint64_t tablePosition = static_cast<uint64_t>(phase) * filter.GetPhaseCount();
+                const uint32_t tableIndex = static_cast<uint32_t>(tablePosition / interpolation);
+                const float fraction = static_cast<float>(tablePosition % interpolation) / static_cast<float>(interpolation);
+
+                const float first = kernels.DotProduct(filter.GetPhase(tableIndex), pWindow, tapCount);
+                const float second = kernels.DotProduct(filter.GetPhase(tableIndex + 1), pWindow, tapCount);
+                result = first + (second - first) * fraction;
+            }
+
+            pDestination[sampleIndex * destinationStride] = result;
+
+            phase += decimation;
+            position += phase / interpolation;
+            phase %= interpolation;
+        }
+    }
+
+
+    void Resampler::Advance(uint32_t outputCount)
+    {
+        const uint64_t interpolation = m_pFilter->GetInterpolationFactor();
+        const uint64_t phase = m_Phase + static_cast<uint64_t>(outputCount) * m_pFilter->GetDecimationFactor();
+        m_InputPosition += static_cast<uint32_t>(phase / interpolation);
+        m_Phase = static_cast<uint32_t>(phase % interpolation);
+    }
+
+
+    uint32_t Resampler::Process(std::span<const float* const> inputs, uint32_t inputCount, std::span<float* const> outputs,
+                                uint32_t maxOutputCount)
+    {
+        QU_Assert(inputs.size() == m_ChannelCount && outputs.size() == m_ChannelCount);
+
+        Compact();
+        QU_Assert(m_InputLength + inputCount <= m_InputCapacity);
+
+        for (uint32_t channelIndex = 0; channelIndex < m_ChannelCount; ++channelIndex)
+            PushChannel(channelIndex, inputs[channelIndex], 1, inputCount);
+        m_InputLength += inputCount;
+
+        const uint32_t outputCount = Min(GetAvailableOutputCount(), maxOutputCount);
+        for (uint32_t channelIndex = 0; channelIndex < m_ChannelCount; ++channelIndex)
+            GenerateChannel(channelIndex, outputs[channelIndex], 1, outputCount);
+
+        Advance(outputCount);
+        return outputCount;
+    }
+
+
+    uint32_t Resampler::ProcessInterleaved(const float* pInput, uint32_t inputCount, float* pOutput, uint32_t maxOutputCount)
+    {
+        Compact();
+        QU_Assert(m_InputLength + inputCount <= m_InputCapacity);
+
+        for (uint32_t channelIndex = 0; channelIndex < m_ChannelCount; ++channelIndex)
+            PushChannel(channelIndex, pInput + channelIndex, m_ChannelCount, inputCount);
+        m_InputLength += inputCount;
+
+        const uint32_t outputCount = Min(GetAvailableOutputCount(), maxOutputCount);
+        for (uint32_t channelIndex = 0; channelIndex < m_ChannelCount; ++channelIndex)
+            GenerateChannel(channelIndex, pOutput + channelIndex, m_ChannelCount, outputCount);
+
+        Advance(outputCount);
+        return outputCount;
+    }
+} // namespace quinte::audio
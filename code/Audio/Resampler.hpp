@@ -0,0 +1,152 @@
+﻿#pragma once
+#include <Core/Core.hpp>
+
+namespace quinte::audio
+{
+    //! \brief The quality of the sample rate conversion.
+    enum class ResamplerQuality : uint32_t
+    {
+        Draft, //!< 16 taps, about 60 dB of stopband attenuation. Cheap enough for real-time playback.
+        Best,  //!< 64 taps, about 100 dB of stopband attenuation and a narrower transition band. Used for export.
+    };
+
+
+    //! \brief A polyphase windowed-sinc lowpass filter for converting between two sample rates.
+    //!
+    //! The ratio is reduced to outSampleRate/inSampleRate = L/M. The filter is stored as a table of phases,
+    //! one for each fractional position of an output sample between two input samples. If L is too large
+    //! the table only has kMaxPhaseCount phases and the outputs are interpolated between the adjacent ones,
+    //! the conversion ratio is still exact.
+    //!
+    //! The table is immutable after construction, so all the channels and resamplers share it.
+    class ResamplerFilter final : public memory::RefCountedObjectBase
+    {
+        float* m_pCoefficients = nullptr;
+        uint32_t m_InterpolationFactor = 0;
+        uint32_t m_DecimationFactor = 0;
+        uint32_t m_PhaseCount = 0;
+        uint32_t m_TapCount = 0;
+
+    public:
+        inline static constexpr uint32_t kMaxPhaseCount = 1024;
+        inline static constexpr uint32_t kMaxTapCount = 1024;
+
+        ResamplerFilter(uint32_t inSampleRate, uint32_t outSampleRate, ResamplerQuality quality);
+        ~ResamplerFilter() override;
+
+        //! \brief Get L, the number of output samples produced per M input samples.
+        [[nodiscard]] inline uint32_t GetInterpolationFactor() const
+        {
+            return m_InterpolationFactor;
+        }
+
+        //! \brief Get M, the number of input samples consumed per L output samples.
+        [[nodiscard]] inline uint32_t GetDecimationFactor() const
+        {
+            return m_DecimationFactor;
+        }
+
+        //! \brief Get the number of phases in the table, not counting the extra one used for interpolation.
+        [[nodiscard]] inline uint32_t GetPhaseCount() const
+        {
+            return m_PhaseCount;
+        }
+
+        [[nodiscard]] inline uint32_t GetTapCount() const
+        {
+            return m_TapCount;
+        }
+
+        //! \brief Get the number of input samples before the position of an output sample that the filter reads.
+        [[nodiscard]] inline uint32_t GetHistoryLength() const
+        {
+            return m_TapCount / 2 - 1;
+        }
+
+        //! \brief Get the taps of a phase, the index is in the range [0, GetPhaseCount()].
+        [[nodiscard]] inline const float* GetPhase(uint32_t phaseIndex) const
+        {
+            QU_AssertDebug(phaseIndex <= m_PhaseCount);
+            return m_pCoefficients + static_cast<uint64_t>(phaseIndex) * m_TapCount;
+        }
+
+        //! \brief Check if the table has a phase for every output position and no interpolation is needed.
+        [[nodiscard]] inline bool IsExact() const
+        {
+            return m_PhaseCount == m_InterpolationFactor;
+        }
+    };
+
+
+    //! \brief A streaming multichannel sample rate converter.
+    //!
+    //! The input is pushed in blocks of any size and the output is produced as soon as there is enough input
+    //! for it. The last input samples are kept between the calls, so the blocks must be consecutive.
+    //! After Reset() the output is aligned with the input: output sample j is at the same time as input
+    //! sample j * M / L, the filter delay is compensated by consuming more input before the first output.
+    class Resampler final : public NoCopyMove
+    {
+        Rc<ResamplerFilter> m_pFilter;
+        float* m_pInput = nullptr;
+        uint32_t m_ChannelCount = 0;
+        uint32_t m_InputCapacity = 0;
+        uint32_t m_InputLength = 0;
+        uint32_t m_InputPosition = 0;
+        uint32_t m_Phase = 0;
+
+        [[nodiscard]] inline float* GetChannelInput(uint32_t channelIndex) const
+        {
+            return m_pInput + static_cast<uint64_t>(channelIndex) * m_InputCapacity;
+        }
+
+        [[nodiscard]] uint32_t GetAvailableOutputCount() const;
+
+        void Compact();
+        void PushChannel(uint32_t channelIndex, const float* pSource, uint64_t sourceStride, uint32_t sampleCount);
+        void GenerateChannel(uint32_t channelIndex, float* pDestination, uint64_t destinationStride, uint32_t sampleCount) const;
+        void Advance(uint32_t outputCount);
+
+    public:
+        Resampler() = default;
+        ~Resampler();
+
+        //! \brief Allocate the buffers and reset the state.
+        //!
+        //! \param pFilter       - The filter to use, can be shared with other resamplers.
+        //! \param channelCount  - The number of channels to convert.
+        //! \param maxInputCount - The maximum number of input samples passed to a single Process() call.
+        void Initialize(ResamplerFilter* pFilter, uint32_t channelCount, uint32_t maxInputCount);
+
+        //! \brief Clear the history as if the stream started from silence.
+        void Reset();
+
+        //! \brief Clear the history and prepare to produce the stream starting from the specified output sample.
+        //!
+        //! \return The index of the first input sample that must be passed to Process() next.
+        [[nodiscard]] uint64_t Seek(uint64_t outputIndex);
+
+        //! \brief Get the number of input samples to push to produce exactly outputCount output samples.
+        [[nodiscard]] uint32_t GetRequiredInputCount(uint32_t outputCount) const;
+
+        //! \brief Push a block of planar samples and produce the output.
+        //!
+        //! The input that wasn't used because of maxOutputCount is kept and used in the next calls.
+        //!
+        //! \return The number of output samples written to every channel.
+        uint32_t Process(std::span<const float* const> inputs, uint32_t inputCount, std::span<float* const> outputs,
+                         uint32_t maxOutputCount);
+
+        //! \brief Same as Process(), but the input and the output are interleaved.
+        uint32_t ProcessInterleaved(const float* pInput, uint32_t inputCount, float* pOutput, uint32_t maxOutputCount);
+
+        [[nodiscard]] inline ResamplerFilter* GetFilter() const
+        {
+            return m_pFilter.Get();
+        }
+
+        [[nodiscard]] inline uint32_t GetChannelCount() const
+        {
+            return m_ChannelCount;
+        }
+    };
+} // namespace quinte::audio
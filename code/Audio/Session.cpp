@@ -2,20 +2,30 @@
 #include <Audio/Ports/PortManager.hpp>
 #include <Audio/Session.hpp>
 #include <Audio/Sources/BufferAudioSource.hpp>
+#include <Audio/Sources/ResampledAudioSource.hpp>
+#include <Core/Memory/TempAllocator.hpp>
 #include <UI/Colors.hpp>
 #include <numbers>
+#include <unordered_set>
 
 namespace quinte
 {
-    static AudioBuffer* GenerateSineWave(float seconds, uint32_t frequency, uint32_t sampleRate)
+    // The sample rate of the test clip that has to be converted to the engine sample rate, like a file recorded elsewhere.
+    inline constexpr uint32_t kTestSourceSampleRate = 44100;
+
+
+    static MultichannelAudioBuffer* GenerateSineWave(float seconds, uint32_t frequency, uint32_t sampleRate)
     {
-        AudioBuffer* pResult = Rc<AudioBuffer>::DefaultNew(static_cast<uint32_t>(sampleRate * seconds));
+        MultichannelAudioBuffer* pResult =
+            Rc<MultichannelAudioBuffer>::DefaultNew(2u, static_cast<uint64_t>(sampleRate * seconds));
 
+        float* pLeft = pResult->GetChannelData(0);
         for (uint32_t sampleIndex = 0; sampleIndex < pResult->GetCapacity(); ++sampleIndex)
         {
-            pResult->Data()[sampleIndex] = 0.9f * std::sin(2 * std::numbers::pi_v<float> * frequency * sampleIndex / sampleRate);
+            pLeft[sampleIndex] = 0.9f * std::sin(2 * std::numbers::pi_v<float> * frequency * sampleIndex / sampleRate);
         }
 
+        memory::Copy(pResult->GetChannelData(1), pLeft, pResult->GetCapacity());
         return pResult;
     }
 
@@ -29,20 +39,131 @@ namespace quinte
     }
 
 
-    Track* Session::CreateTrack(audio::DataType inputDataType, audio::DataType outputDataType)
+    Track* Session::AddTrackImpl(audio::DataType inputDataType, audio::DataType outputDataType)
     {
         constexpr uint32_t kTrackColors[] = { colors::kAzure, colors::kDarkGreen, colors::kRebeccaPurple };
         m_TrackList.AddTrack(Rc<Track>::DefaultNew(inputDataType, outputDataType),
                              kTrackColors[m_TrackList.size() % std::size(kTrackColors)]);
 
         Track* pTrack = m_TrackList.back().pTrack.Get();
-        pTrack->AddSource(0, m_pPortManager->GetHardwarePorts()[0].Get());
         m_pMasterTrack->AddSource(0, pTrack->GetOutputPorts()[0].Get());
         m_pMasterTrack->AddSource(1, pTrack->GetOutputPorts()[1].Get());
         return pTrack;
     }
 
 
+    Track* Session::CreateTrack(audio::DataType inputDataType, audio::DataType outputDataType)
+    {
+        Track* pTrack = AddTrackImpl(inputDataType, outputDataType);
+        pTrack->AddSource(0, m_pPortManager->GetHardwarePorts()[0].Get());
+
+        Interface<AudioEngine>::Get()->RebuildGraph();
+        return pTrack;
+    }
+
+
+    Track* Session::CreateBus(audio::DataType dataType)
+    {
+        Track* pTrack = AddTrackImpl(dataType, dataType);
+
+        Interface<AudioEngine>::Get()->RebuildGraph();
+        return pTrack;
+    }
+
+
+    bool Session::IsTrackReachable(const Track* pFrom, const Track* pTo) const
+    {
+        memory::TempAllocatorScope temp;
+        std::pmr::vector<const Track*> stack{ &temp };
+        std::pmr::unordered_set<const Track*> visited{ &temp };
+
+        // Depth-first search over the track-to-track port connections, the same edges the execution graph is built from.
+        stack.push_back(pFrom);
+        visited.insert(pFrom);
+        while (!stack.empty())
+        {
+            const Track* pTrack = stack.back();
+            stack.pop_back();
+            if (pTrack == pTo)
+                return true;
+
+            for (const Rc<Port>& pOutputPort : pTrack->GetOutputPorts())
+            {
+                for (const audio::PortHandle destinationHandle : pOutputPort->GetDestinations())
+                {
+                    const Track* pDestinationTrack = m_pPortManager->FindPortByHandle(destinationHandle)->TryGetTrack();
+                    if (pDestinationTrack && visited.insert(pDestinationTrack).second)
+                        stack.push_back(pDestinationTrack);
+                }
+            }
+        }
+
+        return false;
+    }
+
+
+    void Session::SetDoublePrecisionMixing(bool enabled)
+    {
+        if (m_DoublePrecisionMixing == enabled)
+            return;
+
+        m_DoublePrecisionMixing = enabled;
+        Interface<AudioEngine>::Get()->RebuildGraph();
+    }
+
+
+    audio::ResultCode Session::ConnectTracks(Track* pSource, Track* pDestination, bool replaceExisting)
+    {
+        QU_AssertDebug(pSource != pDestination);
+        QU_AssertDebug(!pSource->IsMaster());
+
+        // The check doesn't depend on the engine state: the graph is only rebuilt while the stream is running.
+        // Replacing the connections of the source can't break the loop, since a path back to the source never leaves it.
+        if (IsTrackReachable(pDestination, pSource))
+            return audio::ResultCode::FailGraphCycle;
+
+        memory::TempAllocatorScope temp;
+        std::pmr::vector<std::pair<Port*, Port*>> removedConnections{ &temp };
+
+        const std::span<const Rc<Port>> outputPorts = pSource->GetOutputPorts();
+        if (replaceExisting)
+        {
+            for (const Rc<Port>& pOutputPort : outputPorts)
+            {
+                // Copy the handles, since disconnecting modifies the list.
+                const SmallVector<audio::PortHandle, 4> destinations{ pOutputPort->GetDestinations().begin(),
+                                                                      pOutputPort->GetDestinations().end() };
+                for (const audio::PortHandle destinationHandle : destinations)
+                {
+                    Port* pDestinationPort = m_pPortManager->FindPortByHandle(destinationHandle);
+                    if (pDestinationPort->TryGetTrack() == nullptr)
+                        continue;
+
+                    m_pPortManager->DisconnectPorts(pOutputPort.Get(), pDestinationPort);
+                    removedConnections.emplace_back(pOutputPort.Get(), pDestinationPort);
+                }
+            }
+        }
+
+        for (uint32_t channelIndex = 0; channelIndex < outputPorts.size(); ++channelIndex)
+            pDestination->AddSource(channelIndex, outputPorts[channelIndex].Get());
+
+        // The new connections are picked up by the graph built when the stream starts.
+        const audio::ResultCode result = Interface<AudioEngine>::Get()->RebuildGraph();
+        if (result == audio::ResultCode::Success || result == audio::ResultCode::FailStreamNotRunning)
+            return audio::ResultCode::Success;
+
+        // Roll back the connections, the audio thread keeps running the previous graph.
+        const std::span<const Rc<Port>> destinationPorts = pDestination->GetInputPorts();
+        for (uint32_t channelIndex = 0; channelIndex < outputPorts.size(); ++channelIndex)
+            m_pPortManager->DisconnectPorts(outputPorts[channelIndex].Get(), destinationPorts[channelIndex].Get());
+        for (const auto& [pOutputPort, pDestinationPort] : removedConnections)
+            m_pPortManager->ConnectPorts(pOutputPort, pDestinationPort);
+
+        return result;
+    }
+
+
     void Session::OnAudioStreamStarted()
     {
         // Here we hard-code some tracks, clips, etc. for testing purposes.
@@ -77,15 +198,14 @@ namespace quinte
 
         const uint32_t sampleRate = Interface<AudioEngine>::Get()->GetAPI()->GetSampleRate();
 
-        BufferAudioSource* pTestSource1 = Rc<BufferAudioSource>::DefaultNew(GenerateSineWave(1.0f, 440, sampleRate));
-        BufferAudioSource* pTestSource2 = Rc<BufferAudioSource>::DefaultNew(GenerateSineWave(0.5f, 880, sampleRate));
-
-        Playlist& playlist0 = m_TrackList[0].pTrack->GetPlaylist();
-        playlist0.InsertClip(AudioClip{ "Sine Wave 440Hz", pTestSource1, sampleRate * 0.5f });
-        playlist0.InsertClip(AudioClip{ "Sine Wave 440Hz", pTestSource1, sampleRate * 1.5f });
+        AudioSource* pTestSource1 = Rc<BufferAudioSource>::DefaultNew(GenerateSineWave(1.0f, 440, sampleRate));
+        AudioSource* pTestSource2 = ResampledAudioSource::AdaptSampleRate(
+            Rc<BufferAudioSource>::DefaultNew(GenerateSineWave(0.5f, 880, kTestSourceSampleRate), kTestSourceSampleRate),
+            sampleRate);
 
-        Playlist& playlist2 = m_TrackList[2].pTrack->GetPlaylist();
-        playlist2.InsertClip(AudioClip{ "Sine Wave 880Hz", pTestSource2, sampleRate * 0.7f });
+        m_TrackList[0].pTrack->InsertClip(AudioClip{ "Sine Wave 440Hz", pTestSource1, sampleRate * 0.5f });
+        m_TrackList[0].pTrack->InsertClip(AudioClip{ "Sine Wave 440Hz", pTestSource1, sampleRate * 1.5f });
+        m_TrackList[2].pTrack->InsertClip(AudioClip{ "Sine Wave 880Hz", pTestSource2, sampleRate * 0.7f });
     }
 
 
@@ -24,6 +24,11 @@ namespace quinte
 
         TrackList m_TrackList;
 
+        bool m_DoublePrecisionMixing = false;
+
+        Track* AddTrackImpl(audio::DataType inputDataType, audio::DataType outputDataType);
+        bool IsTrackReachable(const Track* pFrom, const Track* pTo) const;
+
         void OnAudioStreamStarted() override;
         void OnAudioStreamStopped() override;
 
@@ -34,6 +39,37 @@ namespace quinte
         Track* CreateTrack(audio::DataType inputDataType = audio::DataType::Audio,
                            audio::DataType outputDataType = audio::DataType::Audio);
 
+        //! \brief Create a track without a hardware input, it can be used as a group bus or an aux return.
+        Track* CreateBus(audio::DataType dataType = audio::DataType::Audio);
+
+        //! \brief Connect the outputs of a track to the inputs of another track.
+        //!
+        //! \param pSource         - The track to connect the outputs of.
+        //! \param pDestination    - The track to receive the signal, e.g. a group bus or a sidechain input.
+        //! \param replaceExisting - If true, the existing track connections of the source are removed (routing
+        //!                          to a group bus), otherwise the connection is added to them (an aux send).
+        //!
+        //! \return audio::ResultCode::FailGraphCycle if the connection creates a feedback loop, the connections
+        //!         are left unchanged in this case. The loop is detected even if the engine is stopped.
+        //!         Other graph build failures are returned as is, after the connections are rolled back.
+        audio::ResultCode ConnectTracks(Track* pSource, Track* pDestination, bool replaceExisting);
+
+        //! \brief Accumulate the inputs of the buses and the master in double precision.
+        //!
+        //! Reduces the rounding error when many tracks are summed, at the cost of twice the memory traffic
+        //! of the bus mixing.
+        void SetDoublePrecisionMixing(bool enabled);
+
+        [[nodiscard]] inline bool IsDoublePrecisionMixing() const
+        {
+            return m_DoublePrecisionMixing;
+        }
+
+        [[nodiscard]] inline const StereoPorts& GetMasterOutputPorts() const
+        {
+            return m_MasterOutputPorts;
+        }
+
         inline TrackList& GetTrackList()
         {
             return m_TrackList;
@@ -0,0 +1,21 @@
+﻿#pragma once
+#include <Audio/Base.hpp>
+
+namespace quinte
+{
+    //! \brief Receives the audio rendered by the engine, e.g. writes it to a file.
+    class AudioSink : public NoCopyMove
+    {
+    public:
+        virtual ~AudioSink() = default;
+
+        //! \brief Write a block of samples.
+        //!
+        //! \param channels   - Pointers to the planar channel data.
+        //! \param frameCount - The number of samples in each channel.
+        virtual audio::ResultCode Write(std::span<const float* const> channels, uint32_t frameCount) = 0;
+
+        //! \brief Called after the last block is written.
+        virtual audio::ResultCode Finalize() = 0;
+    };
+} // namespace quinte
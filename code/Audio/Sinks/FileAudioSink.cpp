@@ -0,0 +1,178 @@
+﻿#include <Audio/Kernels/Kernels.hpp>
+#include <Audio/Sinks/FileAudioSink.hpp>
+
+namespace quinte
+{
+    namespace
+    {
+        inline constexpr uint16_t kWaveFormatPCM = 1;
+        inline constexpr uint16_t kWaveFormatIEEEFloat = 3;
+
+#pragma pack(push, 1)
+        struct WaveHeader final
+        {
+            char RiffID[4] = { 'R', 'I', 'F', 'F' };
+            uint32_t RiffSize = 0;
+            char WaveID[4] = { 'W', 'A', 'V', 'E' };
+
+            char FormatID[4] = { 'f', 'm', 't', ' ' };
+            uint32_t FormatSize = 18;
+            uint16_t FormatTag = kWaveFormatIEEEFloat;
+            uint16_t ChannelCount = 0;
+            uint32_t SampleRate = 0;
+            uint32_t ByteRate = 0;
+            uint16_t BlockAlign = 0;
+            uint16_t BitsPerSample = 32;
+            uint16_t ExtensionSize = 0;
+
+            // The fact chunk is required for the non-PCM formats, the PCM readers skip it.
+            char FactID[4] = { 'f', 'a', 'c', 't' };
+            uint32_t FactSize = 4;
+            uint32_t FrameCount = 0;
+
+            char DataID[4] = { 'd', 'a', 't', 'a' };
+            uint32_t DataSize = 0;
+        };
+#pragma pack(pop)
+
+        static_assert(sizeof(WaveHeader) == 58);
+    } // namespace
+
+
+    FileAudioSink::~FileAudioSink()
+    {
+        if (m_pFile)
+            Finalize();
+    }
+
+
+    bool FileAudioSink::WriteWaveHeader()
+    {
+        const uint32_t sampleByteSize = audio::GetFormatByteSize(m_SampleFormat);
+        const uint64_t dataSize = m_FrameCount * m_ChannelCount * sampleByteSize;
+
+        WaveHeader header;
+        header.FormatTag = m_SampleFormat == audio::Format::Float32 ? kWaveFormatIEEEFloat : kWaveFormatPCM;
+        header.ChannelCount = static_cast<uint16_t>(m_ChannelCount);
+        header.SampleRate = m_SampleRate;
+        header.BlockAlign = static_cast<uint16_t>(m_ChannelCount * sampleByteSize);
+        header.ByteRate = m_SampleRate * header.BlockAlign;
+        header.BitsPerSample = static_cast<uint16_t>(sampleByteSize * 8);
+
+        // The sizes are clamped for the files over 4GB, most readers can handle this.
+        header.FrameCount = static_cast<uint32_t>(Min<uint64_t>(m_FrameCount, std::numeric_limits<uint32_t>::max()));
+        header.DataSize = static_cast<uint32_t>(Min<uint64_t>(dataSize, std::numeric_limits<uint32_t>::max()));
+        header.RiffSize =
+            static_cast<uint32_t>(Min<uint64_t>(dataSize + sizeof(WaveHeader) - 8, std::numeric_limits<uint32_t>::max()));
+
+        return fseek(m_pFile, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, m_pFile) == 1;
+    }
+
+
+    audio::ResultCode FileAudioSink::Open(StringSlice path, audio::FileFormat format, uint32_t sampleRate, uint32_t channelCount,
+                                          audio::Format sampleFormat, audio::NoiseShaping noiseShaping)
+    {
+        QU_Assert(m_pFile == nullptr);
+        QU_Assert(channelCount > 0);
+        QU_Assert(sampleFormat == audio::Format::Int16 || sampleFormat == audio::Format::Int24
+                  || sampleFormat == audio::Format::Int32 || sampleFormat == audio::Format::Float32);
+
+        const String nullTerminatedPath{ path };
+        m_pFile = fopen(nullTerminatedPath.Data(), "wb");
+        if (m_pFile == nullptr)
+            return audio::ResultCode::FailFileAccess;
+
+        m_Format = format;
+        m_SampleFormat = sampleFormat;
+        m_SampleRate = sampleRate;
+        m_ChannelCount = channelCount;
+        m_FrameCount = 0;
+
+        const uint32_t ditherBitDepth = audio::GetDitherBitDepth(audio::Format::Float32, sampleFormat);
+        if (ditherBitDepth > 0)
+            m_Ditherer.Initialize(channelCount, ditherBitDepth, noiseShaping);
+
+        // Reserve the space for the header, it's rewritten in Finalize() when the length is known.
+        if (m_Format == audio::FileFormat::Wave && !WriteWaveHeader())
+            return audio::ResultCode::FailFileAccess;
+
+        return audio::ResultCode::Success;
+    }
+
+
+    audio::ResultCode FileAudioSink::Write(std::span<const float* const> channels, uint32_t frameCount)
+    {
+        QU_Assert(m_pFile);
+
+        const bool dither = audio::GetDitherBitDepth(audio::Format::Float32, m_SampleFormat) > 0;
+        if (dither)
+            m_ChannelBuffer.resize(frameCount);
+
+        m_InterleavedBuffer.resize(static_cast<size_t>(frameCount) * m_ChannelCount);
+        float* pInterleaved = m_InterleavedBuffer.data();
+        for (uint32_t channelIndex = 0; channelIndex < m_ChannelCount; ++channelIndex)
+        {
+            // The missing channels are written as silence.
+            const float* pChannel = channelIndex < channels.size() ? channels[channelIndex] : nullptr;
+            if (pChannel && dither)
+            {
+                m_Ditherer.Process(channelIndex, m_ChannelBuffer.data(), pChannel, frameCount);
+                pChannel = m_ChannelBuffer.data();
+            }
+
+            for (uint32_t frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+                pInterleaved[frameIndex * m_ChannelCount + channelIndex] = pChannel ? pChannel[frameIndex] : 0.0f;
+        }
+
+        const size_t sampleCount = m_InterleavedBuffer.size();
+        const void* pOutput = pInterleaved;
+        if (m_SampleFormat != audio::Format::Float32)
+        {
+            // The 24-bit samples are converted to 32-bit integers and packed in place.
+            const audio::KernelTable& kernels = audio::GetKernels();
+            m_OutputBuffer.resize(sampleCount * sizeof(int32_t));
+            int32_t* pInt32 = reinterpret_cast<int32_t*>(m_OutputBuffer.data());
+            switch (m_SampleFormat)
+            {
+            case audio::Format::Int16:
+                kernels.FloatToInt16(reinterpret_cast<int16_t*>(m_OutputBuffer.data()), pInterleaved, sampleCount);
+                break;
+            case audio::Format::Int24:
+                kernels.FloatToInt32(pInt32, pInterleaved, 8388608.0f, sampleCount);
+                for (size_t sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex)
+                {
+                    const Int24 value{ pInt32[sampleIndex] };
+                    memcpy(m_OutputBuffer.data() + sampleIndex * Int24::kByteCount, value.Data, Int24::kByteCount);
+                }
+                break;
+            default:
+                kernels.FloatToInt32(pInt32, pInterleaved, 2147483648.0f, sampleCount);
+                break;
+            }
+
+            pOutput = m_OutputBuffer.data();
+        }
+
+        const size_t sampleByteSize = audio::GetFormatByteSize(m_SampleFormat);
+        if (fwrite(pOutput, sampleByteSize, sampleCount, m_pFile) != sampleCount)
+            return audio::ResultCode::FailFileAccess;
+
+        m_FrameCount += frameCount;
+        return audio::ResultCode::Success;
+    }
+
+
+    audio::ResultCode FileAudioSink::Finalize()
+    {
+        if (m_pFile == nullptr)
+            return audio::ResultCode::FailUninitialized;
+
+        bool success = true;
+        if (m_Format == audio::FileFormat::Wave)
+            success = WriteWaveHeader();
+
+        success &= fclose(m_pFile) == 0;
+        m_pFile = nullptr;
+        return success ? audio::ResultCode::Success : audio::ResultCode::FailFileAccess;
+    }
+} // namespace quinte
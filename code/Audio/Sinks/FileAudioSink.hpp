@@ -0,0 +1,56 @@
+﻿#pragma once
+#include <Audio/Dither.hpp>
+#include <Audio/Sinks/AudioSink.hpp>
+#include <Core/String.hpp>
+#include <cstdio>
+
+namespace quinte
+{
+    namespace audio
+    {
+        enum class FileFormat : uint32_t
+        {
+            Wave, //!< RIFF WAVE.
+            Raw,  //!< Interleaved samples without a header.
+        };
+    } // namespace audio
+
+
+    //! \brief Writes the rendered audio to an interleaved file.
+    //!
+    //! The samples are written as 32-bit float or as 16, 24 or 32-bit integers. The 16 and 24-bit
+    //! integers are dithered, see audio::Ditherer.
+    class FileAudioSink final : public AudioSink
+    {
+        FILE* m_pFile = nullptr;
+        audio::FileFormat m_Format = audio::FileFormat::Wave;
+        audio::Format m_SampleFormat = audio::Format::Float32;
+        uint32_t m_SampleRate = 0;
+        uint32_t m_ChannelCount = 0;
+        uint64_t m_FrameCount = 0;
+        audio::Ditherer m_Ditherer;
+        std::pmr::vector<float> m_InterleavedBuffer;
+        std::pmr::vector<float> m_ChannelBuffer;
+        std::pmr::vector<uint8_t> m_OutputBuffer;
+
+        bool WriteWaveHeader();
+
+    public:
+        ~FileAudioSink() override;
+
+        //! \brief Create the file, the existing file is overwritten.
+        //!
+        //! \param sampleFormat - Int16, Int24, Int32 or Float32.
+        //! \param noiseShaping - The noise shaping of the dither, used for the 16 and 24-bit formats.
+        //!
+        //! \return audio::ResultCode::FailFileAccess if the file could not be created.
+        audio::ResultCode Open(StringSlice path, audio::FileFormat format, uint32_t sampleRate, uint32_t channelCount,
+                               audio::Format sampleFormat = audio::Format::Float32,
+                               audio::NoiseShaping noiseShaping = audio::NoiseShaping::None);
+
+        audio::ResultCode Write(std::span<const float* const> channels, uint32_t frameCount) override;
+
+        //! \brief Update the header with the final length and close the file.
+        audio::ResultCode Finalize() override;
+    };
+} // namespace quinte
@@ -3,6 +3,12 @@
 
 namespace quinte
 {
+    namespace audio
+    {
+        enum class ResamplerQuality : uint32_t;
+    }
+
+
     class AudioBufferView;
 
 
@@ -11,18 +17,19 @@ namespace quinte
     protected:
         uint64_t m_Length : 48;
         uint64_t m_ChannelCount : 16;
+        uint32_t m_SampleRate = 0;
 
-        inline AudioSource(uint64_t length, uint32_t channelCount)
+        inline AudioSource(uint64_t length, uint32_t channelCount, uint32_t sampleRate = 0)
             : BaseSource(audio::DataType::Audio)
             , m_Length(length)
             , m_ChannelCount(channelCount)
+            , m_SampleRate(sampleRate)
         {
-            // TODO: stereo sources
-            QU_AssertMsg(channelCount == 1, "not implemented");
+            QU_Assert(channelCount > 0);
         }
 
         virtual uint64_t ReadImpl(AudioBufferView* pDestination, uint64_t firstSampleIndex, uint64_t dstOffset,
-                                  uint64_t sampleCount) = 0;
+                                  uint64_t sampleCount, uint32_t channelIndex) = 0;
 
     public:
         [[nodiscard]] inline uint64_t GetLength() const
@@ -30,12 +37,29 @@ namespace quinte
             return m_Length;
         }
 
+        [[nodiscard]] inline uint32_t GetChannelCount() const
+        {
+            return static_cast<uint32_t>(m_ChannelCount);
+        }
+
+        //! \brief Get the sample rate of the source data, zero if the data is generated at the engine sample rate.
+        [[nodiscard]] inline uint32_t GetSampleRate() const
+        {
+            return m_SampleRate;
+        }
+
+        //! \brief Set the quality of the sample rate conversion, ignored if the source doesn't convert its data.
+        virtual void SetQuality(audio::ResamplerQuality quality)
+        {
+            QU_Unused(quality);
+        }
+
         [[nodiscard]] inline uint64_t Read(AudioBufferView* pDestination, uint64_t firstSampleIndex, uint64_t dstOffset,
                                            uint64_t sampleCount, uint32_t channelIndex)
         {
             const std::lock_guard lock{ m_Mutex };
-            if (channelIndex == 0)
-                return ReadImpl(pDestination, firstSampleIndex, dstOffset, sampleCount);
+            if (channelIndex < m_ChannelCount)
+                return ReadImpl(pDestination, firstSampleIndex, dstOffset, sampleCount, channelIndex);
             return 0;
         }
     };
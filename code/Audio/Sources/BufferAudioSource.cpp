@@ -4,10 +4,10 @@
 namespace quinte
 {
     uint64_t BufferAudioSource::ReadImpl(AudioBufferView* pDestination, uint64_t firstSampleIndex, uint64_t dstOffset,
-                                         uint64_t sampleCount)
+                                         uint64_t sampleCount, uint32_t channelIndex)
     {
         const uint64_t actualSampleCount = Min(firstSampleIndex + sampleCount, m_Length) - firstSampleIndex;
-        pDestination->Read(m_pBuffer->Data() + firstSampleIndex, dstOffset, actualSampleCount);
+        m_pBuffer->ReadChannel(channelIndex, pDestination, firstSampleIndex, dstOffset, actualSampleCount);
         return actualSampleCount;
     }
 } // namespace quinte
@@ -1,20 +1,22 @@
 ﻿#pragma once
-#include <Audio/Buffers/AudioBuffer.hpp>
+#include <Audio/Buffers/MultichannelAudioBuffer.hpp>
 #include <Audio/Sources/AudioSource.hpp>
 
 namespace quinte
 {
     class BufferAudioSource final : public AudioSource
     {
-        Rc<AudioBuffer> m_pBuffer;
+        Rc<MultichannelAudioBuffer> m_pBuffer;
 
     protected:
-        uint64_t ReadImpl(AudioBufferView* pDestination, uint64_t firstSampleIndex, uint64_t dstOffset,
-                          uint64_t sampleCount) override;
+        uint64_t ReadImpl(AudioBufferView* pDestination, uint64_t firstSampleIndex, uint64_t dstOffset, uint64_t sampleCount,
+                          uint32_t channelIndex) override;
 
     public:
-        inline BufferAudioSource(AudioBuffer* pSourceBuffer)
-            : AudioSource(pSourceBuffer->GetCapacity(), 1)
+        //! \param pSourceBuffer - The samples of the source.
+        //! \param sampleRate    - The sample rate the samples were recorded at, zero if it's the engine sample rate.
+        inline BufferAudioSource(MultichannelAudioBuffer* pSourceBuffer, uint32_t sampleRate = 0)
+            : AudioSource(pSourceBuffer->GetCapacity(), pSourceBuffer->GetChannelCount(), sampleRate)
             , m_pBuffer(pSourceBuffer)
         {
         }
@@ -0,0 +1,125 @@
+﻿#include <Audio/Sources/ResampledAudioSource.hpp>
+
+namespace quinte
+{
+    namespace
+    {
+        uint64_t GetResampledLength(uint64_t length, uint32_t sourceSampleRate, uint32_t sampleRate)
+        {
+            // Split the length to avoid overflowing length * sampleRate.
+            const uint64_t quotient = length / sourceSampleRate;
+            const uint64_t remainder = length % sourceSampleRate;
+            return quotient * sampleRate + CeilDivide(remainder * sampleRate, sourceSampleRate);
+        }
+    } // namespace
+
+
+    ResampledAudioSource::ResampledAudioSource(AudioSource* pSource, uint32_t sourceSampleRate, uint32_t sampleRate,
+                                               audio::ResamplerQuality quality)
+        : AudioSource(GetResampledLength(pSource->GetLength(), sourceSampleRate, sampleRate), pSource->GetChannelCount(),
+                      sampleRate)
+        , m_pSource(pSource)
+        , m_SourceSampleRate(sourceSampleRate)
+        , m_Quality(quality)
+    {
+        m_pOutputData = memory::DefaultAlloc<float>(kOutputChunkSize * sizeof(float), AudioBufferView::kDataAlignment);
+        InitializeChannels();
+    }
+
+
+    ResampledAudioSource::~ResampledAudioSource()
+    {
+        if (m_pChannels)
+            memory::DefaultDeleteArray(m_pChannels, m_ChannelCount);
+
+        memory::SafeFree(m_pInputData);
+        memory::SafeFree(m_pOutputData);
+    }
+
+
+    AudioSource* ResampledAudioSource::AdaptSampleRate(AudioSource* pSource, uint32_t sampleRate, audio::ResamplerQuality quality)
+    {
+        const uint32_t sourceSampleRate = pSource->GetSampleRate();
+        if (sourceSampleRate == 0 || sourceSampleRate == sampleRate)
+            return pSource;
+
+        return Rc<ResampledAudioSource>::DefaultNew(pSource, sourceSampleRate, sampleRate, quality);
+    }
+
+
+    void ResampledAudioSource::InitializeChannels()
+    {
+        const Rc<audio::ResamplerFilter> pFilter = Rc<audio::ResamplerFilter>::DefaultNew(m_SourceSampleRate, m_SampleRate, m_Quality);
+
+        // The most input needed for a chunk: the window of the last output, starting from any phase.
+        const uint64_t interpolation = pFilter->GetInterpolationFactor();
+        const uint64_t decimation = pFilter->GetDecimationFactor();
+        const uint64_t maxWindowStart = CeilDivide((kOutputChunkSize - 1) * decimation + interpolation, interpolation);
+        m_MaxInputChunkSize = static_cast<uint32_t>(maxWindowStart + pFilter->GetTapCount());
+
+        if (m_pChannels)
+            memory::DefaultDeleteArray(m_pChannels, m_ChannelCount);
+
+        m_pChannels = memory::DefaultNewArray<ChannelState>(m_ChannelCount);
+        for (uint32_t channelIndex = 0; channelIndex < m_ChannelCount; ++channelIndex)
+            m_pChannels[channelIndex].Resampler.Initialize(pFilter.Get(), 1, m_MaxInputChunkSize);
+
+        memory::SafeFree(m_pInputData);
+        m_pInputData = memory::DefaultAlloc<float>(m_MaxInputChunkSize * sizeof(float), AudioBufferView::kDataAlignment);
+        m_InputView = AudioBufferView{ m_pInputData, m_MaxInputChunkSize };
+    }
+
+
+    void ResampledAudioSource::SetQuality(audio::ResamplerQuality quality)
+    {
+        const std::lock_guard lock{ m_Mutex };
+        if (m_Quality == quality)
+            return;
+
+        m_Quality = quality;
+        InitializeChannels();
+    }
+
+
+    uint64_t ResampledAudioSource::ReadImpl(AudioBufferView* pDestination, uint64_t firstSampleIndex, uint64_t dstOffset,
+                                            uint64_t sampleCount, uint32_t channelIndex)
+    {
+        if (firstSampleIndex >= m_Length)
+            return 0;
+
+        const uint64_t actualSampleCount = Min(firstSampleIndex + sampleCount, m_Length) - firstSampleIndex;
+
+        ChannelState& state = m_pChannels[channelIndex];
+        if (state.NextOutputIndex != firstSampleIndex)
+            state.NextInputIndex = state.Resampler.Seek(firstSampleIndex);
+
+        const float* pInput = m_pInputData;
+        float* pOutput = m_pOutputData;
+
+        uint64_t outputOffset = 0;
+        while (outputOffset < actualSampleCount)
+        {
+            const uint32_t outputCount = static_cast<uint32_t>(Min<uint64_t>(actualSampleCount - outputOffset, kOutputChunkSize));
+            const uint32_t inputCount = state.Resampler.GetRequiredInputCount(outputCount);
+            QU_AssertDebug(inputCount <= m_MaxInputChunkSize);
+
+            // The filter reads past the end of the source, it's padded with silence.
+            uint64_t readCount = 0;
+            if (inputCount > 0 && state.NextInputIndex < m_pSource->GetLength())
+                readCount = m_pSource->Read(&m_InputView, state.NextInputIndex, 0, inputCount, channelIndex);
+            if (readCount < inputCount)
+                memory::Zero(m_pInputData + readCount, inputCount - readCount);
+
+            [[maybe_unused]] const uint32_t producedCount =
+                state.Resampler.Process(std::span{ &pInput, 1 }, inputCount, std::span{ &pOutput, 1 }, outputCount);
+            QU_AssertDebug(producedCount == outputCount);
+
+            pDestination->Read(pOutput, dstOffset + outputOffset, outputCount);
+            state.NextInputIndex += inputCount;
+            outputOffset += outputCount;
+        }
+
+        state.NextOutputIndex = firstSampleIndex + actualSampleCount;
+        return actualSampleCount;
+    }
+} // namespace quinte
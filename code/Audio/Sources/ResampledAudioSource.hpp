@@ -0,0 +1,64 @@
+﻿#pragma once
+#include <Audio/Buffers/AudioBufferView.hpp>
+#include <Audio/Resampler.hpp>
+#include <Audio/Sources/AudioSource.hpp>
+
+namespace quinte
+{
+    //! \brief Converts another audio source to a different sample rate on the fly.
+    //!
+    //! Every channel has its own resampler state, so the channels can be read independently.
+    //! Consecutive reads of a channel are streamed; a read at any other position seeks and primes the filter
+    //! with the preceding source samples, so the output doesn't depend on the read pattern.
+    class ResampledAudioSource final : public AudioSource
+    {
+        inline static constexpr uint32_t kOutputChunkSize = 256;
+
+        struct ChannelState final
+        {
+            audio::Resampler Resampler;
+            uint64_t NextOutputIndex = std::numeric_limits<uint64_t>::max();
+            uint64_t NextInputIndex = 0;
+        };
+
+        Rc<AudioSource> m_pSource;
+        ChannelState* m_pChannels = nullptr;
+        float* m_pInputData = nullptr;
+        float* m_pOutputData = nullptr;
+        AudioBufferView m_InputView;
+        uint32_t m_MaxInputChunkSize = 0;
+        uint32_t m_SourceSampleRate = 0;
+        audio::ResamplerQuality m_Quality = audio::ResamplerQuality::Draft;
+
+        void InitializeChannels();
+
+    protected:
+        uint64_t ReadImpl(AudioBufferView* pDestination, uint64_t firstSampleIndex, uint64_t dstOffset, uint64_t sampleCount,
+                          uint32_t channelIndex) override;
+
+    public:
+        //! \brief Wrap a source recorded at sourceSampleRate to be read at sampleRate.
+        ResampledAudioSource(AudioSource* pSource, uint32_t sourceSampleRate, uint32_t sampleRate,
+                             audio::ResamplerQuality quality = audio::ResamplerQuality::Draft);
+        ~ResampledAudioSource() override;
+
+        //! \brief Wrap the source if its sample rate differs from the specified one.
+        //!
+        //! \return The source itself if it doesn't need a conversion, a new ResampledAudioSource otherwise.
+        [[nodiscard]] static AudioSource* AdaptSampleRate(AudioSource* pSource, uint32_t sampleRate,
+                                                          audio::ResamplerQuality quality = audio::ResamplerQuality::Draft);
+
+        //! \brief Rebuild the filter with a different quality, e.g. Best before an offline render.
+        void SetQuality(audio::ResamplerQuality quality) override;
+
+        [[nodiscard]] inline audio::ResamplerQuality GetQuality() const
+        {
+            return m_Quality;
+        }
+
+        [[nodiscard]] inline AudioSource* GetSource() const
+        {
+            return m_pSource.Get();
+        }
+    };
+} // namespace quinte
@@ -0,0 +1,148 @@
+﻿#include <Audio/Kernels/Denormals.hpp>
+#include <Audio/Sinks/AudioSink.hpp>
+#include <Audio/StemExporter.hpp>
+#include <Graph/ExecutionGraph.hpp>
+
+namespace quinte
+{
+    void StemExporter::WriterThread(void* pUserData)
+    {
+        Stem* pStem = static_cast<Stem*>(pUserData);
+        pStem->pExporter->WriterThreadImpl(pStem);
+    }
+
+
+    void StemExporter::WriterThreadImpl(Stem* pStem)
+    {
+        // The sinks convert and dither the samples, denormals would slow them down the same way as the graph.
+        audio::DisableDenormals();
+
+        SmallVector<const float*, 2> channels;
+        channels.resize(pStem->ChannelCount);
+
+        while (true)
+        {
+            pStem->FilledSemaphore.Wait();
+
+            Block block;
+            const bool popped = pStem->Queue.TryPop(block);
+            QU_AssertDebug(popped);
+            QU_Unused(popped);
+
+            if (block.FrameCount == 0)
+                return;
+
+            // After an error we keep draining the queue, so that the render thread doesn't block.
+            if (!audio::Failed(pStem->Result))
+            {
+                const float* pBlock = pStem->pBlockData + static_cast<size_t>(block.Index) * pStem->ChannelCount * m_BlockSize;
+                for (uint32_t channelIndex = 0; channelIndex < pStem->ChannelCount; ++channelIndex)
+                    channels[channelIndex] = pBlock + static_cast<size_t>(channelIndex) * m_BlockSize;
+
+                pStem->Result = pStem->pSink->Write(channels, block.FrameCount);
+            }
+
+            pStem->FreeSemaphore.Release();
+        }
+    }
+
+
+    void StemExporter::PushBlock(Stem* pStem, uint64_t offset, uint32_t frameCount)
+    {
+        pStem->FreeSemaphore.Wait();
+
+        const uint32_t blockIndex = pStem->NextBlockIndex;
+        pStem->NextBlockIndex = (blockIndex + 1) % kBlockCount;
+
+        float* pBlock = pStem->pBlockData + static_cast<size_t>(blockIndex) * pStem->ChannelCount * m_BlockSize;
+        const std::span<const Rc<Port>> outputPorts = pStem->pTrack->GetOutputPorts();
+        for (uint32_t channelIndex = 0; channelIndex < pStem->ChannelCount; ++channelIndex)
+        {
+            float* pDestination = pBlock + static_cast<size_t>(channelIndex) * m_BlockSize;
+            const AudioPort* pPort = static_cast<const AudioPort*>(outputPorts[channelIndex].Get());
+
+            // The silent buffers are always zeroed, so we can just copy them.
+            memory::Copy(pDestination, pPort->GetBufferView()->Data() + offset, frameCount);
+        }
+
+        const bool pushed = pStem->Queue.Push(Block{ .Index = blockIndex, .FrameCount = frameCount });
+        QU_AssertDebug(pushed);
+        QU_Unused(pushed);
+
+        pStem->FilledSemaphore.Release();
+    }
+
+
+    StemExporter::StemExporter(std::span<const audio::StemDesc> stems, uint32_t blockSize, uint64_t frameCount,
+                               const ExecutionGraph* pGraph)
+        : m_BlockSize(blockSize)
+        , m_TotalFrameCount(frameCount)
+    {
+        m_Stems.reserve(stems.size());
+        for (const audio::StemDesc& stemDesc : stems)
+        {
+            memory::unique_ptr<Stem>& pStem = m_Stems.emplace_back(memory::make_unique<Stem>());
+            pStem->pExporter = this;
+            pStem->pTrack = stemDesc.pTrack;
+            pStem->pSink = stemDesc.pSink;
+            pStem->ChannelCount = static_cast<uint32_t>(stemDesc.pTrack->GetOutputPorts().size());
+            pStem->Compensator = audio::LatencyCompensator{ frameCount, pGraph->GetTrackOutputLatency(stemDesc.pTrack.Get()) };
+            pStem->pBlockData =
+                memory::DefaultNewArray<float>(static_cast<size_t>(kBlockCount) * pStem->ChannelCount * blockSize);
+
+            // The end-of-stream marker needs a slot too.
+            pStem->Queue.Initialize(kBlockCount * 2);
+            pStem->Thread = threading::CreateThread("Stem Writer", &WriterThread, pStem.get());
+
+            m_TotalFrameCount = Max(m_TotalFrameCount, pStem->Compensator.GetPendingFrameCount());
+        }
+    }
+
+
+    StemExporter::~StemExporter()
+    {
+        Finish();
+
+        for (memory::unique_ptr<Stem>& pStem : m_Stems)
+            memory::DefaultDeleteArray(pStem->pBlockData, static_cast<size_t>(kBlockCount) * pStem->ChannelCount * m_BlockSize);
+    }
+
+
+    void StemExporter::ProcessCycle(uint32_t frameCount)
+    {
+        QU_AssertDebug(frameCount <= m_BlockSize);
+
+        for (memory::unique_ptr<Stem>& pStem : m_Stems)
+        {
+            const audio::TimeRange32 outputRange = pStem->Compensator.Advance(frameCount);
+            if (outputRange.Length > 0)
+                PushBlock(pStem.get(), outputRange.GetFirstSampleIndex(), outputRange.Length);
+        }
+    }
+
+
+    audio::ResultCode StemExporter::Finish()
+    {
+        audio::ResultCode result = audio::ResultCode::Success;
+        for (memory::unique_ptr<Stem>& pStem : m_Stems)
+        {
+            if (!pStem->Thread)
+                continue;
+
+            const bool pushed = pStem->Queue.Push(Block{});
+            QU_AssertDebug(pushed);
+            QU_Unused(pushed);
+
+            pStem->FilledSemaphore.Release();
+            threading::CloseThread(pStem->Thread);
+
+            const audio::ResultCode finalizeResult = pStem->pSink->Finalize();
+            if (audio::Failed(pStem->Result))
+                result = audio::Failed(result) ? result : pStem->Result;
+            if (audio::Failed(finalizeResult))
+                result = audio::Failed(result) ? result : finalizeResult;
+        }
+
+        return result;
+    }
+} // namespace quinte
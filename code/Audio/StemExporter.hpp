@@ -0,0 +1,91 @@
+﻿#pragma once
+#include <Audio/Engine.hpp>
+#include <Audio/Tracks/Track.hpp>
+#include <Core/SPSCQueue.hpp>
+#include <Core/Threading.hpp>
+
+namespace quinte
+{
+    class AudioSink;
+    class ExecutionGraph;
+
+
+    namespace audio
+    {
+        //! \brief A track whose output is exported to a separate sink.
+        struct StemDesc final
+        {
+            Rc<Track> pTrack;
+            AudioSink* pSink = nullptr;
+        };
+    } // namespace audio
+
+
+    //! \brief Streams the outputs of several tracks to their sinks during an offline render.
+    //!
+    //! The outputs are copied after each cycle into a pool of blocks and passed to a writer thread per stem
+    //! through a lock-free queue, so the encoding and disk I/O don't stall the render.
+    //! The stems are aligned to the timeline: the output latency of each track is skipped.
+    class StemExporter final : public NoCopyMove
+    {
+        struct Block final
+        {
+            uint32_t Index = 0;
+            uint32_t FrameCount = 0; //!< Zero marks the end of the stream.
+        };
+
+        struct Stem final
+        {
+            StemExporter* pExporter = nullptr;
+            Rc<Track> pTrack;
+            AudioSink* pSink = nullptr;
+            uint32_t ChannelCount = 0;
+            uint32_t NextBlockIndex = 0;
+            audio::LatencyCompensator Compensator;
+            float* pBlockData = nullptr;
+
+            SPSCQueue<Block> Queue;
+            threading::Semaphore FilledSemaphore;
+            threading::Semaphore FreeSemaphore{ kBlockCount };
+            threading::ThreadHandle Thread;
+            audio::ResultCode Result = audio::ResultCode::Success;
+        };
+
+        SmallVector<memory::unique_ptr<Stem>, 8> m_Stems;
+        uint32_t m_BlockSize = 0;
+        uint64_t m_TotalFrameCount = 0;
+
+        static void WriterThread(void* pUserData);
+        void WriterThreadImpl(Stem* pStem);
+
+        void PushBlock(Stem* pStem, uint64_t offset, uint32_t frameCount);
+
+    public:
+        //! \brief The number of blocks that can be queued for writing per stem.
+        inline static constexpr uint32_t kBlockCount = 16;
+
+        //! \param stems      - The tracks to export.
+        //! \param blockSize  - The maximum number of frames in a cycle.
+        //! \param frameCount - The number of frames to write to each sink.
+        //! \param pGraph     - The graph used to render, needed for latency compensation.
+        StemExporter(std::span<const audio::StemDesc> stems, uint32_t blockSize, uint64_t frameCount,
+                     const ExecutionGraph* pGraph);
+        ~StemExporter();
+
+        //! \brief Get the number of frames to render, includes the latency of the stems.
+        [[nodiscard]] inline uint64_t GetTotalFrameCount() const
+        {
+            return m_TotalFrameCount;
+        }
+
+        //! \brief Queue the track outputs of the last cycle for writing, called after each cycle.
+        //!
+        //! Blocks if a writer thread falls behind by more than kBlockCount blocks.
+        void ProcessCycle(uint32_t frameCount);
+
+        //! \brief Wait for the writers to finish and finalize the sinks.
+        //!
+        //! \return The first error reported by the sinks.
+        audio::ResultCode Finish();
+    };
+} // namespace quinte
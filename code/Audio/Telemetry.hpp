@@ -0,0 +1,85 @@
+﻿#pragma once
+#include <Core/Core.hpp>
+#include <chrono>
+
+namespace quinte::audio
+{
+    //! \brief The number of audio cycles to accumulate the statistics over before publishing them.
+    inline constexpr uint32_t kTelemetryWindowCycleCount = 64;
+
+
+    //! \brief Processing time statistics over the last telemetry window, in microseconds.
+    struct TimingStats final
+    {
+        float Min = 0.0f;
+        float Avg = 0.0f;
+        float Max = 0.0f;
+    };
+
+
+    //! \brief Engine-wide processing statistics over the last telemetry window.
+    struct EngineStats final
+    {
+        //! \brief Total processing time relative to the total duration of the processed buffers.
+        float DSPLoad = 0.0f;
+
+        //! \brief The maximum processing time of a single cycle relative to the buffer duration.
+        float PeakDSPLoad = 0.0f;
+
+        TimingStats CycleTime;
+
+        //! \brief The number of denormal samples found in the port buffers at the end of the cycles.
+        //!
+        //! Only counted in debug builds, always zero otherwise.
+        uint32_t DenormalCount = 0;
+    };
+
+
+    using TelemetryClock = std::chrono::steady_clock;
+
+
+    inline float GetElapsedMicroseconds(TelemetryClock::time_point start, TelemetryClock::time_point end)
+    {
+        return std::chrono::duration<float, std::micro>(end - start).count();
+    }
+
+
+    //! \brief Accumulates timing samples over a window of audio cycles, used on the audio thread.
+    class TimingAccumulator final
+    {
+        float m_Min = std::numeric_limits<float>::max();
+        float m_Max = 0.0f;
+        float m_Sum = 0.0f;
+        uint32_t m_Count = 0;
+
+    public:
+        //! \brief Add a sample.
+        //!
+        //! \return True if the window is full and the statistics should be published.
+        inline bool Add(float microseconds)
+        {
+            m_Min = Min(m_Min, microseconds);
+            m_Max = Max(m_Max, microseconds);
+            m_Sum += microseconds;
+            return ++m_Count >= kTelemetryWindowCycleCount;
+        }
+
+        [[nodiscard]] inline float GetSum() const
+        {
+            return m_Sum;
+        }
+
+        [[nodiscard]] inline TimingStats GetStats() const
+        {
+            if (m_Count == 0)
+                return {};
+
+            return { m_Min, m_Sum / static_cast<float>(m_Count), m_Max };
+        }
+
+        inline void Reset()
+        {
+            *this = {};
+        }
+    };
+} // namespace quinte::audio
@@ -74,6 +74,11 @@ namespace quinte
             return m_SourceRange;
         }
 
+        [[nodiscard]] inline AudioSource* GetSource() const
+        {
+            return m_pSource.Get();
+        }
+
         [[nodiscard]] inline audio::DataType GetDataType() const
         {
             return m_pSource->GetDataType();
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <Audio/Base.hpp>
+#include <numbers>
 
 namespace quinte
 {
@@ -49,6 +50,20 @@ namespace quinte
             {
                 return static_cast<uint32_t>(Value * -100.0f);
             }
+
+            //! \brief Get the gain of the channel according to the constant-power pan law.
+            //!
+            //! The gains are normalized so that the center position keeps unity gain, a hard pan boosts one side by 3 dB.
+            //! Only the first two channels are panned, the others always have unity gain.
+            [[nodiscard]] inline float GetChannelGain(uint32_t channelIndex) const
+            {
+                if (channelIndex > 1)
+                    return 1.0f;
+
+                const float angle = (Clamp(Value, -1.0f, 1.0f) + 1.0f) * std::numbers::pi_v<float> * 0.25f;
+                const float gain = channelIndex == 0 ? std::cos(angle) : std::sin(angle);
+                return gain * std::numbers::sqrt2_v<float>;
+            }
         };
 
 
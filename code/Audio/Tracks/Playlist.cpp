@@ -18,15 +18,28 @@ namespace quinte
     {
         auto iter = std::lower_bound(
             m_AudioClips.begin(), m_AudioClips.end(), range.StartPos, [](const AudioClip& lhs, audio::TimePos64 rhs) {
-                return lhs.GetEndPosition() < rhs;
+                return lhs.GetEndPosition() <= rhs;
             });
 
+        // The end position is exclusive, a clip that ends at the start of the range has nothing to read.
         while (iter != m_AudioClips.end() && iter->GetPosition() <= range.GetFirstSampleIndex()
-               && iter->GetEndPosition() >= range.GetFirstSampleIndex())
+               && iter->GetEndPosition() > range.GetFirstSampleIndex())
         {
             // TODO: zero-out the rest
             [[maybe_unused]] const auto ignore = iter->Read(pDestination, dstOffset, range, channelIndex);
             ++iter;
         }
     }
+
+
+    bool Playlist::HasClipsInRange(audio::TimeRange64 range) const
+    {
+        const auto iter = std::lower_bound(
+            m_AudioClips.begin(), m_AudioClips.end(), range.StartPos, [](const AudioClip& lhs, audio::TimePos64 rhs) {
+                return lhs.GetEndPosition() <= rhs;
+            });
+
+        // The end position is exclusive, same as in Read().
+        return iter != m_AudioClips.end() && iter->GetPosition().GetSampleIndex() < range.GetLastSampleIndex();
+    }
 } // namespace quinte
@@ -14,6 +14,9 @@ namespace quinte
         void InsertClip(AudioClip&& clip);
         void Read(AudioBufferView* pDestination, uint64_t dstOffset, audio::TimeRange64 range, uint32_t channelIndex) const;
 
+        //! \brief Check if any clip overlaps the specified range.
+        [[nodiscard]] bool HasClipsInRange(audio::TimeRange64 range) const;
+
         inline AudioClip* begin()
         {
             return m_AudioClips.data();
@@ -34,4 +37,24 @@ namespace quinte
             return m_AudioClips.data() + m_AudioClips.size();
         }
     };
+
+
+    //! \brief An immutable copy of a playlist, read by the threads that render the clips in the background.
+    //!
+    //! The playlist of a track is edited on the UI thread, a new snapshot is published after every edit.
+    class PlaylistSnapshot final : public memory::RefCountedObjectBase
+    {
+        Playlist m_Playlist;
+
+    public:
+        inline explicit PlaylistSnapshot(const Playlist& playlist)
+            : m_Playlist(playlist)
+        {
+        }
+
+        [[nodiscard]] inline const Playlist& Get() const
+        {
+            return m_Playlist;
+        }
+    };
 } // namespace quinte
@@ -0,0 +1,138 @@
+﻿#include <Audio/Buffers/AudioBufferView.hpp>
+#include <Audio/Tracks/Playlist.hpp>
+#include <Audio/Tracks/PrerenderBuffer.hpp>
+
+namespace quinte
+{
+    PrerenderBuffer::PrerenderBuffer(uint32_t channelCount, uint64_t blockSize, uint32_t blockCount, PrerenderSignal* pSignal)
+        : m_pSignal(pSignal)
+        , m_Capacity(blockSize * blockCount)
+        , m_BlockSize(blockSize)
+    {
+        QU_AssertDebug(blockCount > 1);
+
+        m_Channels.resize(channelCount);
+        for (float*& pChannel : m_Channels)
+            pChannel = memory::DefaultNewArray<float>(m_Capacity);
+
+        m_pScratch = memory::DefaultNewArray<float>(m_BlockSize);
+    }
+
+
+    PrerenderBuffer::~PrerenderBuffer()
+    {
+        for (float* pChannel : m_Channels)
+            memory::DefaultDeleteArray(pChannel, m_Capacity);
+
+        memory::DefaultDeleteArray(m_pScratch, m_BlockSize);
+    }
+
+
+    bool PrerenderBuffer::BeginRender()
+    {
+        const uint64_t readPos = m_ReadPos.load(std::memory_order_acquire);
+        const uint64_t writePos = m_WritePos.load(std::memory_order_relaxed);
+
+        // The consumer has jumped backwards or past the rendered range, start over from its position.
+        // ValidStart is updated before WritePos, so the consumer never sees stale samples as valid.
+        if (m_RestartRequested.load(std::memory_order_acquire) || writePos < readPos)
+        {
+            m_ValidStart.store(readPos, std::memory_order_release);
+            m_WritePos.store(readPos, std::memory_order_release);
+            m_RestartRequested.store(false, std::memory_order_release);
+            return true;
+        }
+
+        return writePos + m_BlockSize <= readPos + m_Capacity;
+    }
+
+
+    void PrerenderBuffer::Render(const Playlist& playlist)
+    {
+        const uint64_t writePos = m_WritePos.load(std::memory_order_relaxed);
+        const audio::TimeRange64 blockRange{ writePos, m_BlockSize };
+        const uint64_t ringOffset = writePos % m_Capacity;
+        const uint64_t firstPartLength = Min(m_BlockSize, m_Capacity - ringOffset);
+
+        AudioBufferView scratch{ m_pScratch, m_BlockSize };
+        for (uint32_t channelIndex = 0; channelIndex < m_Channels.size(); ++channelIndex)
+        {
+            scratch.Clear();
+            playlist.Read(&scratch, 0, blockRange, channelIndex);
+
+            float* pChannel = m_Channels[channelIndex];
+            memory::Copy(pChannel + ringOffset, scratch.Data(), firstPartLength);
+            if (firstPartLength < m_BlockSize)
+                memory::Copy(pChannel, scratch.Data() + firstPartLength, m_BlockSize - firstPartLength);
+        }
+
+        m_WritePos.store(writePos + m_BlockSize, std::memory_order_release);
+    }
+
+
+    void PrerenderBuffer::Invalidate(audio::TimeRange64 range)
+    {
+        // The samples behind the consumer will be discarded anyway. The rest is not compared with WritePos,
+        // the producer could be rendering a block of the old playlist that hasn't been published yet.
+        if (range.GetLastSampleIndex() > m_ReadPos.load(std::memory_order_acquire))
+            m_InvalidateRequested.store(true, std::memory_order_release);
+    }
+
+
+    bool PrerenderBuffer::Acquire(audio::TimeRange64 range)
+    {
+        if (m_InvalidateRequested.exchange(false, std::memory_order_acq_rel))
+            m_RestartRequested.store(true, std::memory_order_release);
+
+        if (m_RestartRequested.load(std::memory_order_acquire))
+            return false;
+
+        const uint64_t start = range.GetFirstSampleIndex();
+        const uint64_t end = range.GetLastSampleIndex();
+        const uint64_t readPos = m_ReadPos.load(std::memory_order_relaxed);
+        const uint64_t writePos = m_WritePos.load(std::memory_order_acquire);
+        const uint64_t validStart = m_ValidStart.load(std::memory_order_acquire);
+
+        // The samples before ReadPos can be overwritten by the producer at any time. If the producer has
+        // restarted ahead of us, it won't render our range either, so we ask it to start over in both cases.
+        if (start < readPos || start < validStart)
+        {
+            m_RestartRequested.store(true, std::memory_order_release);
+            return false;
+        }
+
+        return end <= writePos;
+    }
+
+
+    void PrerenderBuffer::CopyFromRing(uint32_t channelIndex, AudioBufferView* pDestination, uint64_t destOffset,
+                                       audio::TimeRange64 range) const
+    {
+        const float* pChannel = m_Channels[channelIndex];
+        const uint64_t ringOffset = range.GetFirstSampleIndex() % m_Capacity;
+        const uint64_t length = range.GetLengthInSamples();
+        const uint64_t firstPartLength = Min(length, m_Capacity - ringOffset);
+
+        pDestination->Read(pChannel + ringOffset, destOffset, firstPartLength);
+        if (firstPartLength < length)
+            pDestination->Read(pChannel, destOffset + firstPartLength, length - firstPartLength);
+    }
+
+
+    bool PrerenderBuffer::Read(uint32_t channelIndex, AudioBufferView* pDestination, uint64_t destOffset,
+                               audio::TimeRange64 range) const
+    {
+        if (channelIndex >= m_Channels.size())
+            return false;
+
+        CopyFromRing(channelIndex, pDestination, destOffset, range);
+        return true;
+    }
+
+
+    void PrerenderBuffer::Release(audio::TimeRange64 range)
+    {
+        m_ReadPos.store(range.GetLastSampleIndex(), std::memory_order_release);
+        m_pSignal->Notify();
+    }
+} // namespace quinte
@@ -0,0 +1,128 @@
+﻿#pragma once
+#include <Audio/Base.hpp>
+#include <Core/FixedVector.hpp>
+#include <Core/Threading.hpp>
+
+namespace quinte
+{
+    class AudioBufferView;
+    class Playlist;
+
+
+    //! \brief Wakes the producer of the pre-render buffers up when a consumer has freed some space.
+    //!
+    //! The consumers only signal the semaphore if the producer is about to wait, so the audio thread
+    //! doesn't make a system call every cycle.
+    class PrerenderSignal final : public NoCopyMove
+    {
+        threading::Semaphore m_Semaphore;
+        std::atomic<bool> m_Waiting = false;
+
+    public:
+        //! \brief Wake the producer if it's waiting. Called by the consumers.
+        inline void Notify()
+        {
+            // Pairs with the fence in PrepareWait(): either the producer sees our progress or we see its flag.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_Waiting.load(std::memory_order_relaxed) && m_Waiting.exchange(false, std::memory_order_acq_rel))
+                m_Semaphore.Release();
+        }
+
+        //! \brief Announce that the producer is going to wait, it must check for work once more after this call.
+        inline void PrepareWait()
+        {
+            m_Waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        //! \brief Called by the producer instead of Wait() if it has found some work after PrepareWait().
+        inline void CancelWait()
+        {
+            // A consumer has already taken the flag and is going to signal the semaphore, consume the signal.
+            if (!m_Waiting.exchange(false, std::memory_order_acq_rel))
+                m_Semaphore.Wait();
+        }
+
+        //! \brief Wait until a consumer calls Notify() or Wake().
+        inline void Wait()
+        {
+            m_Semaphore.Wait();
+        }
+
+        //! \brief Wake the producer unconditionally, e.g. to let it exit.
+        inline void Wake()
+        {
+            m_Waiting.store(false, std::memory_order_relaxed);
+            m_Semaphore.Release();
+        }
+    };
+
+
+    //! \brief A ring of the track's clip data rendered ahead of the playhead.
+    //!
+    //! Single producer (the prerender thread) and single consumer (the audio thread that processes the track).
+    //! The samples are indexed by their timeline position: the sample at position P is stored at P % capacity.
+    //! The producer renders the range [ValidStart, WritePos), it never gets further than one capacity ahead
+    //! of ReadPos, which is the position the consumer expects to read next.
+    //!
+    //! When the playlist is edited, the rendered samples are invalidated. The consumer could be reading them
+    //! at that moment, so the restart of the producer is always requested by the consumer in Acquire().
+    class PrerenderBuffer final : public NoCopyMove
+    {
+        SmallVector<float*, 2> m_Channels;
+        float* m_pScratch = nullptr;
+        PrerenderSignal* m_pSignal = nullptr;
+        uint64_t m_Capacity = 0;
+        uint64_t m_BlockSize = 0;
+
+        alignas(memory::kCacheLineSize) std::atomic<uint64_t> m_ReadPos = 0;
+        std::atomic<bool> m_RestartRequested = false;
+        std::atomic<bool> m_InvalidateRequested = false;
+
+        alignas(memory::kCacheLineSize) std::atomic<uint64_t> m_ValidStart = 0;
+        std::atomic<uint64_t> m_WritePos = 0;
+
+        void CopyFromRing(uint32_t channelIndex, AudioBufferView* pDestination, uint64_t destOffset,
+                          audio::TimeRange64 range) const;
+
+    public:
+        //! \param channelCount - The number of channels to render.
+        //! \param blockSize    - The number of samples rendered at once.
+        //! \param blockCount   - The capacity of the ring in blocks.
+        //! \param pSignal      - Notified when the consumer frees some space in the ring.
+        PrerenderBuffer(uint32_t channelCount, uint64_t blockSize, uint32_t blockCount, PrerenderSignal* pSignal);
+        ~PrerenderBuffer();
+
+        //! \brief Check if the next block can be rendered, restart the rendering if requested. Called by the producer.
+        //!
+        //! The playlist passed to Render() must be taken after this call, so that it's not older than
+        //! the edit that has invalidated the buffer.
+        //!
+        //! \return True if there's space in the ring for the next block.
+        [[nodiscard]] bool BeginRender();
+
+        //! \brief Render the next block, must only be called if BeginRender() has returned true. Called by the producer.
+        void Render(const Playlist& playlist);
+
+        //! \brief Discard the rendered samples in the range, called when the playlist has been edited.
+        //!
+        //! Can be called from any thread, the rendering will restart from the consumer position.
+        void Invalidate(audio::TimeRange64 range);
+
+        //! \brief Check if the range is rendered and can be read. Called by the consumer.
+        //!
+        //! If the range is not available because the playhead has jumped, the producer is asked
+        //! to restart from the end of the range.
+        [[nodiscard]] bool Acquire(audio::TimeRange64 range);
+
+        //! \brief Read a channel of a range previously acquired with Acquire(). Called by the consumer.
+        //!
+        //! \return False if the channel is not rendered.
+        bool Read(uint32_t channelIndex, AudioBufferView* pDestination, uint64_t destOffset, audio::TimeRange64 range) const;
+
+        //! \brief Let the producer know the range has been consumed, must be called after every Acquire().
+        //!
+        //! Wakes the producer up if it's waiting for space in the ring.
+        void Release(audio::TimeRange64 range);
+    };
+} // namespace quinte
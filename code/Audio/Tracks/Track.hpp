@@ -1,10 +1,14 @@
 ﻿#pragma once
 #include <Audio/Base.hpp>
+#include <Audio/Metering.hpp>
 #include <Audio/Ports/AudioPort.hpp>
 #include <Audio/Ports/PortManager.hpp>
+#include <Audio/Telemetry.hpp>
 #include <Audio/Tracks/AudioClip.hpp>
 #include <Audio/Tracks/Fader.hpp>
 #include <Audio/Tracks/Playlist.hpp>
+#include <Audio/Tracks/PrerenderBuffer.hpp>
+#include <Core/SeqLock.hpp>
 #include <Core/String.hpp>
 
 namespace quinte
@@ -34,8 +38,15 @@ namespace quinte
         [[maybe_unused]] audio::DataType m_InputDataType;
         [[maybe_unused]] audio::DataType m_OutputDataType;
         std::atomic<audio::TrackFlags> m_Flags = audio::TrackFlags::None;
+        std::atomic<uint32_t> m_LatencySampleCount = 0;
+        std::atomic<bool> m_TruePeakMetering = false;
         Fader m_Fader;
         String m_Name;
+        SeqLock<audio::TimingStats> m_TimingStats;
+        SeqLock<audio::TrackMeter> m_Meter;
+        memory::unique_ptr<PrerenderBuffer> m_pPrerenderBuffer;
+        mutable threading::SpinLock m_PlaylistSnapshotLock;
+        Rc<PlaylistSnapshot> m_pPlaylistSnapshot;
 
         inline static void ShrinkPorts(PortContainer& ports)
         {
@@ -47,16 +58,33 @@ namespace quinte
 
         inline static void SetPort(PortContainer& ports, uint32_t channelIndex, Port* pPort)
         {
-            ports.resize(channelIndex + 1);
+            if (ports.size() <= channelIndex)
+                ports.resize(channelIndex + 1);
+
             ports[channelIndex] = pPort;
             ShrinkPorts(ports);
         }
 
+        inline void SetPortOwners()
+        {
+            for (const Rc<Port>& pPort : m_InputPorts)
+            {
+                if (pPort)
+                    pPort->SetOwner(this);
+            }
+            for (const Rc<Port>& pPort : m_OutputPorts)
+            {
+                if (pPort)
+                    pPort->SetOwner(this);
+            }
+        }
+
         inline Port* EnsurePortExists(uint32_t channelIndex, audio::DataDirection dir)
         {
             PortContainer& ports = dir == audio::DataDirection::Input ? m_InputPorts : m_OutputPorts;
-            ports.resize(channelIndex + 1);
-            if (ports[channelIndex])
+            if (ports.size() <= channelIndex)
+                ports.resize(channelIndex + 1);
+            else if (ports[channelIndex])
                 return ports[channelIndex].Get();
 
             QU_AssertDebugMsg(m_InputDataType == audio::DataType::Audio, "not implemented");
@@ -65,10 +93,14 @@ namespace quinte
             const audio::PortDesc portDesc{ .Kind = audio::PortKind::Track, .Direction = dir };
             ports[channelIndex] = Interface<PortManager>::Get()->NewAudioPort(portDesc);
             ports[channelIndex]->AllocateBuffer();
+            ports[channelIndex]->SetOwner(this);
             return ports[channelIndex].Get();
         }
 
     public:
+        //! \brief The number of audio buffers the clips are pre-rendered ahead of the playhead.
+        inline static constexpr uint32_t kPrerenderBlockCount = 16;
+
         struct MasterConstruct final
         {
         };
@@ -85,6 +117,7 @@ namespace quinte
             SetPort(m_InputPorts, 1, inputPorts.Right.Get());
             SetPort(m_OutputPorts, 0, outputPorts.Left.Get());
             SetPort(m_OutputPorts, 1, outputPorts.Right.Get());
+            SetPortOwners();
         }
 
         inline Track(audio::DataType inputDataType, audio::DataType outputDataType)
@@ -122,6 +155,8 @@ namespace quinte
                     .Flags = audio::PortFlags::StereoRight,
                 }))
                 ->AllocateBuffer();
+
+            SetPortOwners();
         }
 
         inline void AddSource(uint32_t channelIndex, Port* pPort)
@@ -140,11 +175,40 @@ namespace quinte
             return m_OutputPorts;
         }
 
-        [[nodiscard]] inline Playlist& GetPlaylist()
+        [[nodiscard]] inline const Playlist& GetPlaylist() const
         {
             return m_Playlist;
         }
 
+        //! \brief Add a clip to the playlist, called by the UI thread.
+        //!
+        //! Publishes a new playlist snapshot and invalidates the pre-rendered samples the clip overlaps.
+        inline void InsertClip(AudioClip&& clip)
+        {
+            const uint64_t clipStart = clip.GetPosition().GetSampleIndex();
+            const audio::TimeRange64 clipRange{ clipStart, clip.GetEndPosition().GetSampleIndex() - clipStart };
+            m_Playlist.InsertClip(std::move(clip));
+
+            // The previous snapshot is released outside of the lock, it can be the last reference.
+            Rc<PlaylistSnapshot> pSnapshot = Rc<PlaylistSnapshot>::DefaultNew(m_Playlist);
+            {
+                std::lock_guard lock{ m_PlaylistSnapshotLock };
+                std::swap(m_pPlaylistSnapshot, pSnapshot);
+            }
+
+            if (m_pPrerenderBuffer)
+                m_pPrerenderBuffer->Invalidate(clipRange);
+        }
+
+        //! \brief Get the latest published copy of the playlist, can be called from any thread except the audio thread.
+        //!
+        //! \return Null if no clips have been inserted yet.
+        [[nodiscard]] inline Rc<PlaylistSnapshot> GetPlaylistSnapshot() const
+        {
+            std::lock_guard lock{ m_PlaylistSnapshotLock };
+            return m_pPlaylistSnapshot;
+        }
+
         [[nodiscard]] inline bool IsMaster() const
         {
             return (m_Flags.load(std::memory_order_acquire) & audio::TrackFlags::Master) == audio::TrackFlags::Master;
@@ -160,6 +224,77 @@ namespace quinte
             return (m_Flags.load(std::memory_order_acquire) & audio::TrackFlags::RecordArmed) == audio::TrackFlags::RecordArmed;
         }
 
+        //! \brief Get the processing latency of the track in samples, e.g. introduced by look-ahead plug-ins.
+        [[nodiscard]] inline uint32_t GetLatency() const
+        {
+            return m_LatencySampleCount.load(std::memory_order_relaxed);
+        }
+
+        //! \brief Set the processing latency of the track in samples.
+        //!
+        //! The execution graph must be rebuilt for the latency compensation to take effect.
+        inline void SetLatency(uint32_t sampleCount)
+        {
+            m_LatencySampleCount.store(sampleCount, std::memory_order_relaxed);
+        }
+
+        //! \brief Get the processing time statistics of the track, can be called from any thread.
+        [[nodiscard]] inline audio::TimingStats GetTimingStats() const
+        {
+            return m_TimingStats.Load();
+        }
+
+        //! \brief Publish the processing time statistics, called by the engine.
+        inline void PublishTimingStats(const audio::TimingStats& stats)
+        {
+            m_TimingStats.Store(stats);
+        }
+
+        //! \brief Get the output levels of the track over the last meter window, can be called from any thread.
+        [[nodiscard]] inline audio::TrackMeter GetMeter() const
+        {
+            return m_Meter.Load();
+        }
+
+        //! \brief Publish the output levels, called by the engine.
+        inline void PublishMeter(const audio::TrackMeter& meter)
+        {
+            m_Meter.Store(meter);
+        }
+
+        [[nodiscard]] inline bool IsTruePeakMetering() const
+        {
+            return m_TruePeakMetering.load(std::memory_order_relaxed);
+        }
+
+        //! \brief Enable the 4x oversampled true peak measurement of the track outputs, it's much more expensive
+        //!        than the sample peak and RMS, so it's disabled by default.
+        inline void SetTruePeakMetering(bool enabled)
+        {
+            m_TruePeakMetering.store(enabled, std::memory_order_relaxed);
+        }
+
+        //! \brief Get the buffer the clips of the track are rendered to ahead of time, can be null.
+        [[nodiscard]] inline PrerenderBuffer* GetPrerenderBuffer() const
+        {
+            return m_pPrerenderBuffer.get();
+        }
+
+        //! \brief Create the pre-render buffer, replacing the existing one.
+        //!
+        //! Must not be called while the track is processed by the audio thread or rendered by the Prerenderer.
+        inline void CreatePrerenderBuffer(uint64_t blockSize, PrerenderSignal* pSignal)
+        {
+            const uint32_t channelCount = static_cast<uint32_t>(m_InputPorts.size());
+            m_pPrerenderBuffer = memory::make_unique<PrerenderBuffer>(channelCount, blockSize, kPrerenderBlockCount, pSignal);
+        }
+
+        //! \brief Destroy the pre-render buffer, the same restrictions as for CreatePrerenderBuffer() apply.
+        inline void DestroyPrerenderBuffer()
+        {
+            m_pPrerenderBuffer.reset();
+        }
+
         [[nodiscard]] inline StringSlice GetName() const
         {
             return m_Name;
@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include <Audio/Base.hpp>
 #include <Core/Interface.hpp>
+#include <Core/Threading.hpp>
 
 namespace quinte
 {
@@ -22,11 +23,37 @@ namespace quinte
 
         // data actually used by the engine in the current cycle
         audio::TimePos64 m_Playhead;
+        audio::TimeRange64 m_LoopRange;
         bool m_Recording = false;
+        bool m_LoopEnabled = false;
 
         std::atomic<audio::TimePos64> m_PlayheadRequest;
         std::atomic<audio::PlayState> m_PlayState = audio::PlayState::Paused;
         std::atomic<bool> m_RecordingRequested = false;
+        std::atomic<bool> m_LoopEnabledRequest = false;
+
+        threading::SpinLock m_LoopRangeLock;
+        audio::TimeRange64 m_LoopRangeRequest;
+
+        //! \brief Copy the loop settings requested by the UI, called by the engine at the beginning of the cycle.
+        inline void AcquireLoop()
+        {
+            m_LoopEnabled = m_LoopEnabledRequest.load(std::memory_order_relaxed);
+
+            // The audio thread never waits for the UI: if the range is being updated right now,
+            // we'll just get it in the next cycle.
+            if (m_LoopRangeLock.try_lock())
+            {
+                m_LoopRange = m_LoopRangeRequest;
+                m_LoopRangeLock.unlock();
+            }
+        }
+
+        //! \brief Move the playhead at the end of the cycle, unless the UI has requested a new position during the cycle.
+        inline void AdvancePlayhead(audio::TimePos64 cycleStartPos, audio::TimePos64 newPos)
+        {
+            m_PlayheadRequest.compare_exchange_strong(cycleStartPos, newPos);
+        }
 
     public:
         inline void SetPlayhead(uint64_t sampleCount)
@@ -83,6 +110,28 @@ namespace quinte
             m_RecordingRequested.store(true);
         }
 
+        inline void SetLoopRange(audio::TimeRange64 range)
+        {
+            std::lock_guard lock{ m_LoopRangeLock };
+            m_LoopRangeRequest = range;
+        }
+
+        inline void SetLoopEnabled(bool value)
+        {
+            m_LoopEnabledRequest.store(value);
+        }
+
+        [[nodiscard]] inline bool IsLoopEnabled() const
+        {
+            return m_LoopEnabledRequest.load();
+        }
+
+        [[nodiscard]] inline audio::TimeRange64 GetLoopRange()
+        {
+            std::lock_guard lock{ m_LoopRangeLock };
+            return m_LoopRangeRequest;
+        }
+
         [[nodiscard]] inline audio::PlayState GetPlayState() const
         {
             return m_PlayState;
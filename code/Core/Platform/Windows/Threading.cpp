@@ -1,11 +1,18 @@
 ﻿#include <Core/Threading.hpp>
 #include <Core/Platform/Windows/Utils.hpp>
 #include <Core/Memory/MemoryPool.hpp>
+#include <timeapi.h>
+
+#pragma comment(lib, "winmm")
 
 #ifdef CreateMutex
 #    undef CreateMutex
 #endif
 
+#ifdef CreateSemaphore
+#    undef CreateSemaphore
+#endif
+
 namespace quinte::threading
 {
     namespace
@@ -143,6 +150,81 @@ namespace quinte::threading
     }
 
 
+    SemaphoreHandle CreateSemaphore(uint32_t initialCount)
+    {
+        const HANDLE hSemaphore = CreateSemaphoreW(nullptr, static_cast<LONG>(initialCount), LONG_MAX, nullptr);
+        QU_Assert(hSemaphore);
+        return SemaphoreHandle{ reinterpret_cast<uint64_t>(hSemaphore) };
+    }
+
+
+    void ReleaseSemaphore(SemaphoreHandle semaphore, uint32_t count)
+    {
+        const BOOL result = ::ReleaseSemaphore(reinterpret_cast<HANDLE>(semaphore.Value), static_cast<LONG>(count), nullptr);
+        QU_Assert(result);
+    }
+
+
+    void WaitSemaphore(SemaphoreHandle semaphore)
+    {
+        WaitForSingleObject(reinterpret_cast<HANDLE>(semaphore.Value), INFINITE);
+    }
+
+
+    void CloseSemaphore(SemaphoreHandle& semaphore)
+    {
+        if (!semaphore)
+            return;
+
+        CloseHandle(reinterpret_cast<HANDLE>(semaphore.Value));
+        semaphore.Reset();
+    }
+
+
+    // The high resolution timers are available since Windows 10 1803. On the older systems, the resolution of the regular
+    // timers is raised to 1 ms while the timer exists, the caller spins for the rest.
+    TimerHandle CreateHighResolutionTimer()
+    {
+        HANDLE hTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (hTimer)
+            return TimerHandle{ reinterpret_cast<uint64_t>(hTimer) };
+
+        hTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        QU_Assert(hTimer);
+
+        timeBeginPeriod(1);
+        // The low bit marks the timers that have raised the system timer resolution, the handles are aligned.
+        return TimerHandle{ reinterpret_cast<uint64_t>(hTimer) | 1 };
+    }
+
+
+    void WaitTimer(TimerHandle timer, uint32_t microseconds)
+    {
+        const HANDLE hTimer = reinterpret_cast<HANDLE>(timer.Value & ~uint64_t{ 1 });
+
+        // A negative due time is relative, in 100 ns units.
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -static_cast<LONGLONG>(microseconds) * 10;
+        const BOOL setResult = SetWaitableTimerEx(hTimer, &dueTime, 0, nullptr, nullptr, nullptr, 0);
+        QU_Assert(setResult);
+
+        WaitForSingleObject(hTimer, INFINITE);
+    }
+
+
+    void CloseTimer(TimerHandle& timer)
+    {
+        if (!timer)
+            return;
+
+        if (timer.Value & 1)
+            timeEndPeriod(1);
+
+        CloseHandle(reinterpret_cast<HANDLE>(timer.Value & ~uint64_t{ 1 }));
+        timer.Reset();
+    }
+
+
     ThreadHandle CreateThread(StringSlice name, ThreadFunction startRoutine, void* pUserData, Priority priority, size_t stackSize)
     {
         ThreadDataImpl* pData = AllocateThreadData();
@@ -184,4 +266,24 @@ namespace quinte::threading
         QU_Assert(closeRes);
         thread.Reset();
     }
+
+
+    uint32_t GetProcessorCount()
+    {
+        return GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+    }
+
+
+    void PromoteCurrentThreadToRealtime()
+    {
+        windows::SetThreadProAudio();
+    }
+
+
+    void SetCurrentThreadAffinity(uint32_t processorIndex)
+    {
+        // We only support the first processor group, that's 64 logical processors.
+        const DWORD_PTR mask = DWORD_PTR{ 1 } << (processorIndex % (sizeof(DWORD_PTR) * 8));
+        SetThreadAffinityMask(GetCurrentThread(), mask);
+    }
 } // namespace quinte::threading
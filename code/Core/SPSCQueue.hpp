@@ -0,0 +1,80 @@
+﻿#pragma once
+#include <Core/Core.hpp>
+
+namespace quinte
+{
+    //! \brief A bounded lock-free single-producer single-consumer queue.
+    //!
+    //! Only one thread can call Push() and only one (other) thread can call TryPop().
+    //! The indices grow monotonically, the storage is indexed by the lower bits.
+    template<class T>
+    requires std::is_trivially_copyable_v<T>
+    class SPSCQueue final : public NoCopyMove
+    {
+        alignas(memory::kCacheLineSize) std::atomic<uint64_t> m_Head = 0;
+        alignas(memory::kCacheLineSize) std::atomic<uint64_t> m_Tail = 0;
+
+        alignas(memory::kCacheLineSize) T* m_pItems = nullptr;
+        uint64_t m_Mask = 0;
+
+    public:
+        inline SPSCQueue() = default;
+
+        inline explicit SPSCQueue(uint32_t capacity)
+        {
+            Initialize(capacity);
+        }
+
+        inline ~SPSCQueue()
+        {
+            if (m_pItems)
+                memory::DefaultDeleteArray(m_pItems, static_cast<size_t>(m_Mask + 1));
+        }
+
+        //! \brief Allocate the storage, capacity must be a power of two.
+        inline void Initialize(uint32_t capacity)
+        {
+            QU_AssertDebug(m_pItems == nullptr);
+            QU_AssertDebug(capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+            m_pItems = memory::DefaultNewArray<T>(capacity);
+            m_Mask = static_cast<uint64_t>(capacity) - 1;
+        }
+
+        [[nodiscard]] inline uint32_t GetCapacity() const
+        {
+            return static_cast<uint32_t>(m_Mask + 1);
+        }
+
+        //! \brief Push an item to the queue. Must be called only by the producer.
+        //!
+        //! \return False if the queue is full.
+        inline bool Push(const T& item)
+        {
+            const uint64_t tail = m_Tail.load(std::memory_order_relaxed);
+            if (tail - m_Head.load(std::memory_order_acquire) > m_Mask)
+                return false;
+
+            m_pItems[tail & m_Mask] = item;
+            m_Tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! \brief Pop an item from the queue. Must be called only by the consumer.
+        inline bool TryPop(T& result)
+        {
+            const uint64_t head = m_Head.load(std::memory_order_relaxed);
+            if (head == m_Tail.load(std::memory_order_acquire))
+                return false;
+
+            result = m_pItems[head & m_Mask];
+            m_Head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] inline bool Empty() const
+        {
+            return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire);
+        }
+    };
+} // namespace quinte
@@ -0,0 +1,57 @@
+﻿#pragma once
+#include <Core/Core.hpp>
+
+namespace quinte
+{
+    //! \brief A sequence lock that allows a single writer to publish a value to any number of readers.
+    //!
+    //! The writer never waits for the readers, so it can be used on the audio thread.
+    //! The readers retry if the value was modified while they were copying it.
+    //!
+    //! \tparam T - The type of the published value, must be trivially copyable.
+    template<class T>
+    requires std::is_trivially_copyable_v<T>
+    class SeqLock final : public NoCopyMove
+    {
+        std::atomic<uint32_t> m_Sequence = 0;
+        T m_Value{};
+
+    public:
+        //! \brief Publish a new value. Must not be called from more than one thread at a time.
+        inline void Store(const T& value)
+        {
+            const uint32_t sequence = m_Sequence.load(std::memory_order_relaxed);
+            m_Sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            memcpy(&m_Value, &value, sizeof(T));
+
+            m_Sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        //! \brief Try to read the value once.
+        //!
+        //! \return False if the value was being modified, the result is not valid in this case.
+        inline bool TryLoad(T& result) const
+        {
+            const uint32_t sequenceBefore = m_Sequence.load(std::memory_order_acquire);
+            if (sequenceBefore & 1)
+                return false;
+
+            memcpy(&result, &m_Value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            return m_Sequence.load(std::memory_order_relaxed) == sequenceBefore;
+        }
+
+        //! \brief Read the value, retry until a consistent copy is made.
+        [[nodiscard]] inline T Load() const
+        {
+            T result;
+            while (!TryLoad(result))
+                _mm_pause();
+
+            return result;
+        }
+    };
+} // namespace quinte
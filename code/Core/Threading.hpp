@@ -6,6 +6,10 @@
 #    undef CreateMutex
 #endif
 
+#ifdef CreateSemaphore
+#    undef CreateSemaphore
+#endif
+
 namespace quinte::threading
 {
     class SpinLock final
@@ -193,6 +197,108 @@ namespace quinte::threading
     };
 
 
+    struct SemaphoreHandle final : TypedHandle<SemaphoreHandle, uint64_t, 0>
+    {
+    };
+
+
+    SemaphoreHandle CreateSemaphore(uint32_t initialCount = 0);
+    void ReleaseSemaphore(SemaphoreHandle semaphore, uint32_t count = 1);
+    void WaitSemaphore(SemaphoreHandle semaphore);
+    void CloseSemaphore(SemaphoreHandle& semaphore);
+
+
+    class Semaphore final : public NoCopy
+    {
+        SemaphoreHandle m_Handle;
+
+    public:
+        inline Semaphore(uint32_t initialCount = 0)
+        {
+            m_Handle = CreateSemaphore(initialCount);
+        }
+
+        inline Semaphore(Semaphore&& other) noexcept
+            : m_Handle(other.m_Handle)
+        {
+            other.m_Handle.Reset();
+        }
+
+        inline Semaphore& operator=(Semaphore&& other) noexcept
+        {
+            CloseSemaphore(m_Handle);
+            m_Handle = other.m_Handle;
+            other.m_Handle.Reset();
+            return *this;
+        }
+
+        inline ~Semaphore()
+        {
+            CloseSemaphore(m_Handle);
+        }
+
+        inline void Release(uint32_t count = 1)
+        {
+            ReleaseSemaphore(m_Handle, count);
+        }
+
+        inline void Wait()
+        {
+            WaitSemaphore(m_Handle);
+        }
+    };
+
+
+    struct TimerHandle final : TypedHandle<TimerHandle, uint64_t, 0>
+    {
+    };
+
+
+    TimerHandle CreateHighResolutionTimer();
+    void WaitTimer(TimerHandle timer, uint32_t microseconds);
+    void CloseTimer(TimerHandle& timer);
+
+
+    //! \brief A timer to suspend the calling thread with sub-millisecond precision.
+    //!
+    //! Unlike a regular sleep, the wait time doesn't depend on the system timer tick. It's still a wait for at least
+    //! the specified time, so the threads that need a precise deadline spin for the last part of it.
+    class HighResolutionTimer final : public NoCopy
+    {
+        TimerHandle m_Handle;
+
+    public:
+        inline HighResolutionTimer()
+        {
+            m_Handle = CreateHighResolutionTimer();
+        }
+
+        inline HighResolutionTimer(HighResolutionTimer&& other) noexcept
+            : m_Handle(other.m_Handle)
+        {
+            other.m_Handle.Reset();
+        }
+
+        inline HighResolutionTimer& operator=(HighResolutionTimer&& other) noexcept
+        {
+            CloseTimer(m_Handle);
+            m_Handle = other.m_Handle;
+            other.m_Handle.Reset();
+            return *this;
+        }
+
+        inline ~HighResolutionTimer()
+        {
+            CloseTimer(m_Handle);
+        }
+
+        inline void Wait(uint32_t microseconds)
+        {
+            WaitTimer(m_Handle, microseconds);
+        }
+    };
+
+
     typedef void (*ThreadFunction)(void*);
 
 
@@ -216,6 +322,18 @@ namespace quinte::threading
     void CloseThread(ThreadHandle& thread);
 
 
+    //! \brief Get the number of logical processors available to the process.
+    uint32_t GetProcessorCount();
+
+
+    //! \brief Register the calling thread with the OS scheduler as a real-time audio thread.
+    void PromoteCurrentThreadToRealtime();
+
+
+    //! \brief Restrict the calling thread to run only on the specified logical processor.
+    void SetCurrentThreadAffinity(uint32_t processorIndex);
+
+
     class Thread final : public NoCopy
     {
         ThreadHandle m_Handle;
@@ -0,0 +1,111 @@
+﻿#pragma once
+#include <Core/Core.hpp>
+
+namespace quinte
+{
+    //! \brief A bounded lock-free work-stealing deque (Chase-Lev).
+    //!
+    //! Only the owner thread can call Push() and TryPop(), any other thread can call TrySteal().
+    //! The owner works with the bottom of the deque (LIFO), the thieves take items from the top (FIFO).
+    //!
+    //! The implementation follows "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013).
+    //! Unlike the original algorithm, the buffer never grows, since we want to use it on the audio thread.
+    template<class T>
+    requires std::is_trivially_copyable_v<T>
+    class WorkStealingDeque final : public NoCopyMove
+    {
+        alignas(memory::kCacheLineSize) std::atomic<int64_t> m_Top = 0;
+        alignas(memory::kCacheLineSize) std::atomic<int64_t> m_Bottom = 0;
+
+        alignas(memory::kCacheLineSize) std::atomic<T>* m_pItems = nullptr;
+        int64_t m_Mask = 0;
+
+    public:
+        inline WorkStealingDeque() = default;
+
+        inline explicit WorkStealingDeque(uint32_t capacity)
+        {
+            Initialize(capacity);
+        }
+
+        inline ~WorkStealingDeque()
+        {
+            if (m_pItems)
+                memory::DefaultDeleteArray(m_pItems, static_cast<size_t>(m_Mask + 1));
+        }
+
+        //! \brief Allocate the storage, capacity must be a power of two.
+        inline void Initialize(uint32_t capacity)
+        {
+            QU_AssertDebug(m_pItems == nullptr);
+            QU_AssertDebug(capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+            m_pItems = memory::DefaultNewArray<std::atomic<T>>(capacity);
+            m_Mask = static_cast<int64_t>(capacity) - 1;
+        }
+
+        [[nodiscard]] inline uint32_t GetCapacity() const
+        {
+            return static_cast<uint32_t>(m_Mask + 1);
+        }
+
+        //! \brief Push an item to the bottom of the deque. Must be called only by the owner.
+        //!
+        //! \return False if the deque is full.
+        inline bool Push(T item)
+        {
+            const int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+            const int64_t top = m_Top.load(std::memory_order_acquire);
+            if (bottom - top > m_Mask) [[unlikely]]
+                return false;
+
+            m_pItems[bottom & m_Mask].store(item, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        //! \brief Pop an item from the bottom of the deque. Must be called only by the owner.
+        inline bool TryPop(T& result)
+        {
+            const int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+            m_Bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = m_Top.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            result = m_pItems[bottom & m_Mask].load(std::memory_order_relaxed);
+            if (top != bottom)
+                return true;
+
+            // This is the last item, we have to race with the thieves for it.
+            const bool won = m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+
+        //! \brief Steal an item from the top of the deque. Can be called from any thread.
+        inline bool TrySteal(T& result)
+        {
+            int64_t top = m_Top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+
+            if (top >= bottom)
+                return false;
+
+            result = m_pItems[top & m_Mask].load(std::memory_order_relaxed);
+            return m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] inline bool Empty() const
+        {
+            return m_Bottom.load(std::memory_order_relaxed) <= m_Top.load(std::memory_order_relaxed);
+        }
+    };
+} // namespace quinte
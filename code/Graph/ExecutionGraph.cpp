@@ -1,142 +1,703 @@
 ﻿#include <Audio/Engine.hpp>
+#include <Audio/Kernels/Denormals.hpp>
 #include <Audio/Ports/PortManager.hpp>
 #include <Audio/Session.hpp>
 #include <Audio/Transport.hpp>
 #include <Core/Memory/TempAllocator.hpp>
 #include <Graph/ExecutionGraph.hpp>
+#include <Graph/GraphWorkerPool.hpp>
 
 namespace quinte
 {
-    void ExecutionGraph::ProcessNode(const audio::EngineProcessInfo& processInfo, ExecutionGraphNode* pNode)
+    namespace
     {
-        Transport* pTransport = Interface<Transport>::Get();
-        PortManager* pPortManager = Interface<PortManager>::Get();
+        inline AudioBufferView* GetAudioBufferView(Port* pPort)
+        {
+            QU_AssertDebugMsg(pPort->GetDataType() == audio::DataType::Audio, "not implemented");
+            return static_cast<AudioPort*>(pPort)->GetBufferView();
+        }
+
+
+        //! \brief Get the timeline range to read the clips from.
+        //!
+        //! The range is shifted back by the input latency of the node, so that the clips are aligned with the
+        //! delayed signals coming from the other nodes.
+        //!
+        //! \return False if the whole range is before the timeline start.
+        inline bool GetClipRange(const audio::EngineProcessInfo& processInfo, uint64_t latency, audio::TimeRange64& range,
+                                 uint64_t& destOffset)
+        {
+            const audio::TimeRange64 globalRange = processInfo.LocalRange + processInfo.StartTime;
+            const uint64_t start = globalRange.GetFirstSampleIndex();
+            const uint64_t length = globalRange.GetLengthInSamples();
+
+            destOffset = processInfo.LocalRange.GetFirstSampleIndex();
+            if (start >= latency)
+            {
+                range = { start - latency, length };
+                return true;
+            }
+
+            if (start + length <= latency)
+                return false;
+
+            const uint64_t skippedLength = latency - start;
+            range = { 0, length - skippedLength };
+            destOffset += skippedLength;
+            return true;
+        }
+    } // namespace
 
-        const auto globalRange = processInfo.LocalRange + processInfo.StartTime;
 
+    void ExecutionGraph::ExecuteSteps(const audio::EngineProcessInfo& processInfo, ExecutionGraphNode* pNode,
+                                      uint32_t firstStepIndex, uint32_t stepCount) const
+    {
+        Track* pTrack = pNode ? pNode->Track.Get() : nullptr;
+        const uint64_t firstSampleIndex = processInfo.LocalRange.GetFirstSampleIndex();
+        const uint64_t length = processInfo.LocalRange.GetLengthInSamples();
+
+        const bool rolling = Interface<Transport>::Get()->IsActuallyRolling();
+        const bool recordArmed = pTrack && pTrack->IsRecordArmed();
+        const float amp = pTrack ? pTrack->GetFader()->GetGain().GetAmplitude() : 1.0f;
+        const audio::PanValue pan = pTrack ? pTrack->GetFader()->GetPan() : audio::PanValue{ audio::PanValue::Pos::Center };
+        const bool truePeakMetering = pTrack && pTrack->IsTruePeakMetering();
+
+        audio::TimeRange64 clipRange;
+        uint64_t destOffset = 0;
+        const bool readClips =
+            rolling && pNode && GetClipRange(processInfo, pNode->InputLatencySampleCount, clipRange, destOffset);
+
+        PrerenderBuffer* pPrerenderBuffer = readClips ? pNode->pPrerenderBuffer : nullptr;
+        const bool prerendered = pPrerenderBuffer && pPrerenderBuffer->Acquire(clipRange);
+
+        const ExecutionGraphStep* pSteps = m_Steps.data() + firstStepIndex;
+        for (uint32_t stepIndex = 0; stepIndex < stepCount; ++stepIndex)
+        {
+            const ExecutionGraphStep& step = pSteps[stepIndex];
+            switch (step.Kind)
+            {
+            case ExecutionGraphStepKind::Clear:
+                step.pDestination->Clear(firstSampleIndex, length);
+                break;
+            case ExecutionGraphStepKind::ReadClips:
+                if (!readClips)
+                    break;
+
+                // Fall back to reading the clips directly if the pre-rendered samples are not ready,
+                // e.g. right after a seek.
+                if (!prerendered || !pPrerenderBuffer->Read(step.ChannelIndex, step.pDestination, destOffset, clipRange))
+                    pTrack->GetPlaylist().Read(step.pDestination, destOffset, clipRange, step.ChannelIndex);
+                break;
+            case ExecutionGraphStepKind::Mix:
+                if ((step.Flags & ExecutionGraphStepFlags::RecordingOnly) == ExecutionGraphStepFlags::RecordingOnly
+                    && !recordArmed)
+                    break;
+
+                step.pDestination->Mix(step.pSource, firstSampleIndex, firstSampleIndex, length);
+                break;
+            case ExecutionGraphStepKind::MixWithGain:
+            {
+                // The fader changes are ramped over the cycle, starting from the gain applied at the end of the last one.
+                // This is the last write to the output port, so the meter is computed in the same pass.
+                float& currentGain = pNode->OutputGains[step.ChannelIndex];
+                const float targetGain = amp * pan.GetChannelGain(step.ChannelIndex);
+                const float gainStep = (targetGain - currentGain) / static_cast<float>(length);
+                const audio::BlockLevels levels = step.pDestination->MixWithGainRampAndMeasure(
+                    step.pSource, currentGain + gainStep, gainStep, firstSampleIndex, firstSampleIndex, length);
+                currentGain = targetGain;
+
+                pNode->Meter.Add(step.ChannelIndex, levels);
+                if (truePeakMetering && step.ChannelIndex < audio::kMaxMeterChannelCount)
+                {
+                    audio::TruePeakDetector& detector = pNode->TruePeakDetectors[step.ChannelIndex];
+                    pNode->Meter.AddTruePeak(step.ChannelIndex,
+                                             detector.Process(step.pDestination->Data() + firstSampleIndex, length));
+                }
+                break;
+            }
+            case ExecutionGraphStepKind::MixMany:
+                step.pDestination->MixMany({ m_MixSources.data() + step.FirstSourceIndex, step.SourceCount }, {},
+                                           firstSampleIndex, length, step.pAccumulator);
+                break;
+            case ExecutionGraphStepKind::Delay:
+                step.pDelayLine->Process(step.pSource, firstSampleIndex, length);
+                break;
+            }
+        }
+
+        if (pPrerenderBuffer)
+            pPrerenderBuffer->Release(clipRange);
+    }
+
+
+    bool ExecutionGraph::HasAudibleInput(const audio::EngineProcessInfo& processInfo, const ExecutionGraphNode* pNode) const
+    {
         Track* pTrack = pNode->Track.Get();
-        const float amp = pTrack->GetFader()->GetGain().GetAmplitude();
+        const bool rolling = Interface<Transport>::Get()->IsActuallyRolling();
+        const bool recordArmed = pTrack->IsRecordArmed();
+
+        bool clipsChecked = false;
+        const ExecutionGraphStep* pSteps = m_Steps.data() + pNode->FirstStepIndex;
+        for (uint32_t stepIndex = 0; stepIndex < pNode->StepCount; ++stepIndex)
+        {
+            const ExecutionGraphStep& step = pSteps[stepIndex];
+            switch (step.Kind)
+            {
+            case ExecutionGraphStepKind::ReadClips:
+                if (!rolling || clipsChecked)
+                    break;
+
+                {
+                    audio::TimeRange64 clipRange;
+                    uint64_t destOffset;
+                    if (GetClipRange(processInfo, pNode->InputLatencySampleCount, clipRange, destOffset)
+                        && pTrack->GetPlaylist().HasClipsInRange(clipRange))
+                        return true;
+                }
+
+                clipsChecked = true;
+                break;
+            case ExecutionGraphStepKind::Delay:
+                if (!step.pSource->IsSilent() || step.pDelayLine->HasPendingSamples())
+                    return true;
+                break;
+            case ExecutionGraphStepKind::Mix:
+                if ((step.Flags & ExecutionGraphStepFlags::RecordingOnly) == ExecutionGraphStepFlags::RecordingOnly
+                    && !recordArmed)
+                    break;
+
+                // The delay line output is only updated when the delay step is executed, it's checked above.
+                if ((step.Flags & ExecutionGraphStepFlags::Delayed) == ExecutionGraphStepFlags::Delayed)
+                    break;
+
+                if (!step.pSource->IsSilent())
+                    return true;
+                break;
+            case ExecutionGraphStepKind::MixMany:
+                for (uint32_t sourceIndex = step.FirstSourceIndex; sourceIndex < step.FirstSourceIndex + step.SourceCount;
+                     ++sourceIndex)
+                {
+                    if ((m_MixSourceFlags[sourceIndex] & ExecutionGraphStepFlags::Delayed) == ExecutionGraphStepFlags::Delayed)
+                        continue;
+
+                    if (!m_MixSources[sourceIndex]->IsSilent())
+                        return true;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        return false;
+    }
+
+
+    void ExecutionGraph::ClearNodeBuffers(const audio::EngineProcessInfo& processInfo, const ExecutionGraphNode* pNode) const
+    {
         const uint64_t firstSampleIndex = processInfo.LocalRange.GetFirstSampleIndex();
         const uint64_t length = processInfo.LocalRange.GetLengthInSamples();
 
+        // Clearing a buffer that is already silent doesn't touch the memory,
+        // so a node that stays silent for a long time costs almost nothing.
+        const ExecutionGraphStep* pSteps = m_Steps.data() + pNode->FirstStepIndex;
+        for (uint32_t stepIndex = 0; stepIndex < pNode->StepCount; ++stepIndex)
+        {
+            if (pSteps[stepIndex].Kind == ExecutionGraphStepKind::Clear)
+                pSteps[stepIndex].pDestination->Clear(firstSampleIndex, length);
+        }
+    }
+
+
+    void ExecutionGraph::ProcessNode(const audio::EngineProcessInfo& processInfo, ExecutionGraphNode* pNode) const
+    {
+        const audio::TelemetryClock::time_point startTime = audio::TelemetryClock::now();
+        QU_Defer
+        {
+            // Only one thread processes a node in a cycle, and the cycles are separated by the worker pool
+            // barrier, so the accumulator doesn't need any synchronization.
+            const float elapsed = audio::GetElapsedMicroseconds(startTime, audio::TelemetryClock::now());
+            if (pNode->Timing.Add(elapsed))
+            {
+                pNode->Track->PublishTimingStats(pNode->Timing.GetStats());
+                pNode->Timing.Reset();
+            }
+        };
+
+        if (HasAudibleInput(processInfo, pNode))
+        {
+            pNode->SilentSampleCount = 0;
+        }
+        else
+        {
+            if (pNode->SilentSampleCount >= pNode->TailSampleCount)
+            {
+                // The outputs are marked silent, so the downstream nodes will skip mixing them.
+                ClearNodeBuffers(processInfo, pNode);
+                UpdateMeter(processInfo, pNode);
+                return;
+            }
+
+            pNode->SilentSampleCount += processInfo.LocalRange.GetLengthInSamples();
+        }
+
+        ExecuteSteps(processInfo, pNode, pNode->FirstStepIndex, pNode->StepCount);
+        UpdateMeter(processInfo, pNode);
+    }
+
+
+    void ExecutionGraph::UpdateMeter(const audio::EngineProcessInfo& processInfo, ExecutionGraphNode* pNode) const
+    {
+        if (!pNode->Meter.Advance(processInfo.LocalRange.GetLengthInSamples()))
+            return;
+
+        pNode->Track->PublishMeter(pNode->Meter.GetMeter());
+        pNode->Meter.Reset();
+    }
+
+
+    void ExecutionGraph::AddStep(ExecutionGraphStepKind kind, AudioBufferView* pDestination, const AudioBufferView* pSource,
+                                 uint32_t channelIndex, ExecutionGraphStepFlags flags)
+    {
+        ExecutionGraphStep& step = m_Steps.emplace_back();
+        step.pDestination = pDestination;
+        step.pSource = pSource;
+        step.Kind = kind;
+        step.Flags = flags;
+        step.ChannelIndex = channelIndex;
+    }
+
+
+    void ExecutionGraph::AddMixSteps(AudioBufferView* pDestination, uint32_t channelIndex, std::span<const MixSource> sources)
+    {
+        // The sources that are only mixed when the track is record armed are kept as separate steps,
+        // the rest is summed by a single step that writes the destination once.
+        const uint32_t firstSourceIndex = static_cast<uint32_t>(m_MixSources.size());
+        for (const auto& [pSource, flags] : sources)
+        {
+            if ((flags & ExecutionGraphStepFlags::RecordingOnly) == ExecutionGraphStepFlags::RecordingOnly)
+            {
+                AddStep(ExecutionGraphStepKind::Mix, pDestination, pSource, channelIndex, flags);
+                continue;
+            }
+
+            m_MixSources.push_back(pSource);
+            m_MixSourceFlags.push_back(flags);
+        }
+
+        const uint32_t sourceCount = static_cast<uint32_t>(m_MixSources.size()) - firstSourceIndex;
+        if (sourceCount == 1)
+        {
+            AddStep(ExecutionGraphStepKind::Mix, pDestination, m_MixSources.back(), channelIndex, m_MixSourceFlags.back());
+            m_MixSources.pop_back();
+            m_MixSourceFlags.pop_back();
+        }
+        else if (sourceCount > 1)
+        {
+            AddStep(ExecutionGraphStepKind::MixMany, pDestination, nullptr, channelIndex);
+            ExecutionGraphStep& step = m_Steps.back();
+            step.FirstSourceIndex = firstSourceIndex;
+            step.SourceCount = sourceCount;
+
+            // Each step gets its own accumulator, the steps of different nodes can run in parallel.
+            if (Interface<Session>::Get()->IsDoublePrecisionMixing())
+            {
+                const size_t byteSize = pDestination->GetCapacity() * sizeof(double);
+                step.pAccumulator = memory::Alloc<double>(&m_NodeAllocator, byteSize, AudioBufferView::kDataAlignment);
+            }
+        }
+    }
+
+
+    void ExecutionGraph::CompileNode(ExecutionGraphNode* pNode, const NodeMap& nodeMap)
+    {
+        PortManager* pPortManager = Interface<PortManager>::Get();
+        Track* pTrack = pNode->Track.Get();
+
+        pNode->FirstStepIndex = static_cast<uint32_t>(m_Steps.size());
+
         // The first two ports are for the clips, the others only participate in sends/receives
 
+        SmallVector<MixSource, 16> mixSources;
         const std::span<const Rc<Port>> inputPorts = pTrack->GetInputPorts();
         for (uint32_t channelIndex = 0; channelIndex < inputPorts.size(); ++channelIndex)
         {
             Port* pPort = inputPorts[channelIndex].Get();
-            pPort->GetBufferView()->Clear(firstSampleIndex, length);
-
-            QU_AssertDebugMsg(pPort->GetDataType() == audio::DataType::Audio, "not implemented");
-            AudioPort* pAudioPort = static_cast<AudioPort*>(pPort);
-            AudioBufferView* pAudioBuffer = pAudioPort->GetBufferView();
+            AudioBufferView* pAudioBuffer = GetAudioBufferView(pPort);
 
-            if (pTransport->IsActuallyRolling())
-                pTrack->GetPlaylist().Read(pAudioBuffer, firstSampleIndex, globalRange, channelIndex);
+            AddStep(ExecutionGraphStepKind::Clear, pAudioBuffer);
+            AddStep(ExecutionGraphStepKind::ReadClips, pAudioBuffer, nullptr, channelIndex);
 
+            // The delay steps are added first, so that all the mixes can be fused into a single step.
+            mixSources.clear();
             for (const audio::PortHandle sourceHandle : pPort->GetSources())
             {
                 Port* pSource = pPortManager->FindPortByHandle(sourceHandle);
-                if ((pSource->GetDesc().Flags & audio::PortFlags::RecordingOnly) == audio::PortFlags::RecordingOnly)
+                const bool recordingOnly =
+                    (pSource->GetDesc().Flags & audio::PortFlags::RecordingOnly) == audio::PortFlags::RecordingOnly;
+
+                ExecutionGraphStepFlags flags = recordingOnly ? ExecutionGraphStepFlags::RecordingOnly
+                                                              : ExecutionGraphStepFlags::None;
+                const AudioBufferView* pSourceBuffer = GetAudioBufferView(pSource);
+
+                // Delay the sources that arrive earlier than the ones on the longest path.
+                uint64_t sourceLatency = 0;
+                if (const Track* pSourceTrack = pSource->TryGetTrack())
                 {
-                    if (!pTrack->IsRecordArmed())
-                        continue;
+                    const auto it = nodeMap.find(pSourceTrack);
+                    if (it != nodeMap.end())
+                        sourceLatency = it->second->GetOutputLatency();
                 }
 
-                pAudioBuffer->Mix(pSource->GetBufferView(), firstSampleIndex, firstSampleIndex, length);
+                if (sourceLatency < pNode->InputLatencySampleCount)
+                {
+                    DelayLine* pDelayLine =
+                        memory::New<DelayLine>(&m_NodeAllocator, pNode->InputLatencySampleCount - sourceLatency);
+                    m_DelayLines.push_back(pDelayLine);
+
+                    ExecutionGraphStep& delayStep = m_Steps.emplace_back();
+                    delayStep.Kind = ExecutionGraphStepKind::Delay;
+                    delayStep.pSource = pSourceBuffer;
+                    delayStep.pDelayLine = pDelayLine;
+
+                    pSourceBuffer = pDelayLine->GetOutput();
+                    flags |= ExecutionGraphStepFlags::Delayed;
+                }
+
+                mixSources.emplace_back(pSourceBuffer, flags);
             }
+
+            AddMixSteps(pAudioBuffer, channelIndex, mixSources);
         }
 
         // TODO: we should connect the input ports to the output ports directly
         // and generalize port processing, because later we will connect the plug-ins in between.
 
+        const Fader* pFader = pTrack->GetFader();
         const std::span<const Rc<Port>> outputPorts = pTrack->GetOutputPorts();
         for (uint32_t channelIndex = 0; channelIndex < outputPorts.size(); ++channelIndex)
         {
-            Port* pOutputPort = outputPorts[channelIndex].Get();
-            QU_AssertDebugMsg(pOutputPort->GetDataType() == audio::DataType::Audio, "not implemented");
-            AudioPort* pAudioPort = static_cast<AudioPort*>(pOutputPort);
-            pAudioPort->GetBufferView()->Clear(firstSampleIndex, length);
+            const float gain = pFader->GetGain().GetAmplitude() * pFader->GetPan().GetChannelGain(channelIndex);
+            pNode->OutputGains.push_back(gain);
+
+            AudioBufferView* pAudioBuffer = GetAudioBufferView(outputPorts[channelIndex].Get());
+            AddStep(ExecutionGraphStepKind::Clear, pAudioBuffer);
 
             if (channelIndex < inputPorts.size())
             {
-                Port* pInputPort = inputPorts[channelIndex].Get();
-                pAudioPort->GetBufferView()->MixWithGain(pInputPort->GetBufferView(), amp, 0, firstSampleIndex, length);
+                const AudioBufferView* pInputBuffer = GetAudioBufferView(inputPorts[channelIndex].Get());
+                AddStep(ExecutionGraphStepKind::MixWithGain, pAudioBuffer, pInputBuffer, channelIndex);
             }
         }
 
-        for (ExecutionGraphNode* pOutgoingNode : pNode->Outgoing)
+        pNode->StepCount = static_cast<uint32_t>(m_Steps.size()) - pNode->FirstStepIndex;
+    }
+
+
+    void ExecutionGraph::CompileMonitor()
+    {
+        PortManager* pPortManager = Interface<PortManager>::Get();
+        const StereoPorts& monitorPorts = pPortManager->GetMonitorPorts();
+        Port* ports[] = { monitorPorts.Left.Get(), monitorPorts.Right.Get() };
+
+        SmallVector<MixSource, 16> mixSources;
+        m_MonitorFirstStepIndex = static_cast<uint32_t>(m_Steps.size());
+        for (Port* pPort : ports)
         {
-            if (pOutgoingNode->Trigger())
-                ProcessNode(processInfo, pOutgoingNode);
+            AudioBufferView* pAudioBuffer = GetAudioBufferView(pPort);
+            AddStep(ExecutionGraphStepKind::Clear, pAudioBuffer);
+
+            mixSources.clear();
+            for (const audio::PortHandle sourceHandle : pPort->GetSources())
+            {
+                Port* pSource = pPortManager->FindPortByHandle(sourceHandle);
+                mixSources.emplace_back(GetAudioBufferView(pSource), ExecutionGraphStepFlags::None);
+            }
+
+            AddMixSteps(pAudioBuffer, 0, mixSources);
         }
+
+        m_MonitorStepCount = static_cast<uint32_t>(m_Steps.size()) - m_MonitorFirstStepIndex;
     }
 
 
-    ExecutionGraph::~ExecutionGraph()
+    bool ExecutionGraph::SortNodes()
     {
-        m_InitialNodes.clear();
+        // Kahn's algorithm: the dependency counters are used as the in-degrees,
+        // they are reset before every run anyway.
+        m_SortedNodes.clear();
+        m_SortedNodes.reserve(m_AllNodes.size());
+
         for (ExecutionGraphNode* pNode : m_AllNodes)
-            pNode->~ExecutionGraphNode();
+            pNode->DependencyCount.store(pNode->InitialDependencyCount, std::memory_order_relaxed);
 
-        m_AllNodes.clear();
-        m_NodeAllocator.Clear();
+        m_SortedNodes.insert(m_SortedNodes.end(), m_InitialNodes.begin(), m_InitialNodes.end());
+        for (size_t nodeIndex = 0; nodeIndex < m_SortedNodes.size(); ++nodeIndex)
+        {
+            for (ExecutionGraphNode* pOutgoingNode : m_SortedNodes[nodeIndex]->Outgoing)
+            {
+                if (pOutgoingNode->Trigger())
+                    m_SortedNodes.push_back(pOutgoingNode);
+            }
+        }
+
+        // If there's a cycle, the nodes in it never reach zero dependencies.
+        return m_SortedNodes.size() == m_AllNodes.size();
     }
 
 
-    void ExecutionGraph::Build()
+    void ExecutionGraph::ComputeLatencies(const NodeMap& nodeMap)
+    {
+        PortManager* pPortManager = Interface<PortManager>::Get();
+
+        // The nodes are sorted, so the latencies of all the sources are known by the time we get to a node.
+        for (ExecutionGraphNode* pNode : m_SortedNodes)
+        {
+            pNode->LatencySampleCount = pNode->Track->GetLatency();
+            pNode->TailSampleCount = pNode->LatencySampleCount;
+            pNode->InputLatencySampleCount = 0;
+
+            for (const Rc<Port>& pInputPort : pNode->Track->GetInputPorts())
+            {
+                for (const audio::PortHandle sourceHandle : pInputPort->GetSources())
+                {
+                    const Track* pSourceTrack = pPortManager->FindPortByHandle(sourceHandle)->TryGetTrack();
+                    if (pSourceTrack == nullptr)
+                        continue;
+
+                    const auto it = nodeMap.find(pSourceTrack);
+                    if (it != nodeMap.end())
+                        pNode->InputLatencySampleCount = Max(pNode->InputLatencySampleCount, it->second->GetOutputLatency());
+                }
+            }
+
+            if (pNode->Track->IsMaster())
+                m_OutputLatency = pNode->GetOutputLatency();
+        }
+    }
+
+
+    void ExecutionGraph::Partition(uint32_t workerCount)
+    {
+        // A node that feeds a single bus joins the affinity set of that bus, so that the bus is likely
+        // to mix the buffers that are still in the cache of the same core. The nodes that feed a sink (e.g. master)
+        // are not merged, otherwise all the tracks would end up in the same set.
+        for (auto it = m_SortedNodes.rbegin(); it != m_SortedNodes.rend(); ++it)
+        {
+            ExecutionGraphNode* pNode = *it;
+            pNode->pAffinityRoot = pNode;
+            if (pNode->Outgoing.size() == 1 && !pNode->Outgoing[0]->Outgoing.empty())
+                pNode->pAffinityRoot = pNode->Outgoing[0]->pAffinityRoot;
+        }
+
+        // Nodes that haven't been measured yet still have some cost.
+        constexpr float kMinNodeCost = 1.0f;
+
+        memory::TempAllocatorScope temp;
+        std::pmr::vector<std::pair<ExecutionGraphNode*, float>> affinitySets{ &temp };
+        std::pmr::unordered_map<const ExecutionGraphNode*, size_t> affinitySetIndices{ &temp };
+        affinitySetIndices.reserve(m_SortedNodes.size());
+        for (ExecutionGraphNode* pNode : m_SortedNodes)
+        {
+            const float cost = Max(pNode->Track->GetTimingStats().Avg, kMinNodeCost);
+            const auto [indexIter, inserted] = affinitySetIndices.try_emplace(pNode->pAffinityRoot, affinitySets.size());
+            if (inserted)
+                affinitySets.emplace_back(pNode->pAffinityRoot, cost);
+            else
+                affinitySets[indexIter->second].second += cost;
+        }
+
+        // Longest processing time first: assign the most expensive sets to the least loaded workers.
+        std::sort(affinitySets.begin(), affinitySets.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second > rhs.second;
+        });
+
+        SmallVector<float, 16> workerLoads;
+        workerLoads.resize(workerCount, 0.0f);
+        for (const auto& [pRoot, cost] : affinitySets)
+        {
+            const auto minIter = std::min_element(workerLoads.begin(), workerLoads.end());
+            pRoot->WorkerIndex = static_cast<uint32_t>(minIter - workerLoads.begin());
+            *minIter += cost;
+        }
+
+        for (ExecutionGraphNode* pNode : m_SortedNodes)
+            pNode->WorkerIndex = pNode->pAffinityRoot->WorkerIndex;
+
+        std::stable_sort(m_InitialNodes.begin(), m_InitialNodes.end(), [](const auto* pLhs, const auto* pRhs) {
+            return pLhs->WorkerIndex < pRhs->WorkerIndex;
+        });
+
+        m_WorkerInitialNodeOffsets.clear();
+        m_WorkerInitialNodeOffsets.resize(workerCount + 1, 0);
+        for (const ExecutionGraphNode* pNode : m_InitialNodes)
+            ++m_WorkerInitialNodeOffsets[pNode->WorkerIndex + 1];
+        for (uint32_t workerIndex = 0; workerIndex < workerCount; ++workerIndex)
+            m_WorkerInitialNodeOffsets[workerIndex + 1] += m_WorkerInitialNodeOffsets[workerIndex];
+    }
+
+
+    void ExecutionGraph::Reset()
     {
         m_InitialNodes.clear();
         for (ExecutionGraphNode* pNode : m_AllNodes)
             pNode->~ExecutionGraphNode();
+        for (DelayLine* pDelayLine : m_DelayLines)
+            pDelayLine->~DelayLine();
 
         m_AllNodes.clear();
+        m_SortedNodes.clear();
+        m_DelayLines.clear();
+        m_WorkerInitialNodeOffsets.clear();
+        m_Steps.clear();
+        m_MixSources.clear();
+        m_MixSourceFlags.clear();
+        m_OutputLatency = 0;
         m_NodeAllocator.Clear();
+    }
+
+
+    ExecutionGraph::~ExecutionGraph()
+    {
+        Reset();
+    }
+
+
+    audio::ResultCode ExecutionGraph::Build(uint32_t workerCount)
+    {
+        QU_AssertDebug(workerCount > 0);
+
+        Reset();
         m_NodeAllocator.Maintain();
 
+        memory::TempAllocatorScope temp;
+        NodeMap nodeMap{ &temp };
+
         Session* pSession = Interface<Session>::Get();
-        ExecutionGraphNode* pMasterNode = memory::New<ExecutionGraphNode>(&m_NodeAllocator);
-        m_AllNodes.push_back(pMasterNode);
-        m_AllNodes.back()->Track = pSession->m_pMasterTrack;
+        const auto addNode = [&](const Rc<Track>& pTrack) {
+            ExecutionGraphNode* pNode = memory::New<ExecutionGraphNode>(&m_NodeAllocator);
+            pNode->Track = pTrack;
+            pNode->pPrerenderBuffer = pTrack->GetPrerenderBuffer();
+            m_AllNodes.push_back(pNode);
+            nodeMap[pTrack.Get()] = pNode;
+        };
 
+        addNode(pSession->m_pMasterTrack);
         for (const TrackInfo& trackInfo : pSession->GetTrackList())
+            addNode(trackInfo.pTrack);
+
+        // The edges are derived from the port connections: if any input port of a track is connected
+        // to an output port of another track, the former depends on the latter. This covers the master,
+        // group buses, sends and sidechains uniformly.
+        PortManager* pPortManager = Interface<PortManager>::Get();
+        for (ExecutionGraphNode* pNode : m_AllNodes)
         {
-            m_AllNodes.push_back(memory::New<ExecutionGraphNode>(&m_NodeAllocator));
-            m_AllNodes.back()->Track = trackInfo.pTrack;
-            m_InitialNodes.push_back(m_AllNodes.back());
-            m_InitialNodes.back()->Outgoing.push_back(pMasterNode);
+            for (const Rc<Port>& pInputPort : pNode->Track->GetInputPorts())
+            {
+                for (const audio::PortHandle sourceHandle : pInputPort->GetSources())
+                {
+                    const Track* pSourceTrack = pPortManager->FindPortByHandle(sourceHandle)->TryGetTrack();
+                    if (pSourceTrack == nullptr)
+                        continue;
+
+                    const auto it = nodeMap.find(pSourceTrack);
+                    if (it == nodeMap.end())
+                        continue;
 
-            // Master track depends on all the other tracks.
-            // Once they finish processing, master processing is triggered.
-            pMasterNode->InitialDependencyCount++;
+                    ExecutionGraphNode* pSourceNode = it->second;
+                    if (pSourceNode == pNode)
+                        return audio::ResultCode::FailGraphCycle;
+
+                    if (FindIndex(pSourceNode->Outgoing, pNode) != InvalidIndex)
+                        continue;
+
+                    pSourceNode->Outgoing.push_back(pNode);
+                    pNode->InitialDependencyCount++;
+                }
+            }
         }
+
+        for (ExecutionGraphNode* pNode : m_AllNodes)
+        {
+            if (pNode->InitialDependencyCount == 0)
+                m_InitialNodes.push_back(pNode);
+        }
+
+        if (!SortNodes())
+            return audio::ResultCode::FailGraphCycle;
+
+        ComputeLatencies(nodeMap);
+        Partition(workerCount);
+
+        for (ExecutionGraphNode* pNode : m_AllNodes)
+            CompileNode(pNode, nodeMap);
+
+        CompileMonitor();
+        return audio::ResultCode::Success;
     }
 
 
-    void ExecutionGraph::Run(const audio::EngineProcessInfo& processInfo)
+    uint64_t ExecutionGraph::GetTrackOutputLatency(const Track* pTrack) const
     {
-        for (ExecutionGraphNode* pNode : m_AllNodes)
-            pNode->DependencyCount = pNode->InitialDependencyCount;
-        for (ExecutionGraphNode* pNode : m_InitialNodes)
-            ProcessNode(processInfo, pNode);
+        const ExecutionGraphNode* pNode = FindNode(pTrack);
+        return pNode ? pNode->GetOutputLatency() : 0;
+    }
 
-        PortManager* pPortManager = Interface<PortManager>::Get();
-        const StereoPorts& monitorPorts = pPortManager->GetMonitorPorts();
-        Port* ports[] = { monitorPorts.Left.Get(), monitorPorts.Right.Get() };
 
-        const uint64_t firstSampleIndex = processInfo.LocalRange.GetFirstSampleIndex();
-        const uint64_t length = processInfo.LocalRange.GetLengthInSamples();
-        for (Port* pPort : ports)
+    const ExecutionGraphNode* ExecutionGraph::FindNode(const Track* pTrack) const
+    {
+        for (const ExecutionGraphNode* pNode : m_AllNodes)
         {
-            pPort->GetBufferView()->Clear(firstSampleIndex, length);
-            QU_AssertDebug(pPort->GetDataType() == audio::DataType::Audio);
-            AudioPort* pAudioPort = static_cast<AudioPort*>(pPort);
-            AudioBufferView* pAudioBuffer = pAudioPort->GetBufferView();
-            for (const audio::PortHandle sourceHandle : pPort->GetSources())
+            if (pNode->Track.Get() == pTrack)
+                return pNode;
+        }
+
+        return nullptr;
+    }
+
+
+    void ExecutionGraph::Run(const audio::EngineProcessInfo& processInfo, GraphWorkerPool* pWorkerPool)
+    {
+        if (pWorkerPool->GetWorkerCount() > 1)
+        {
+            for (ExecutionGraphNode* pNode : m_AllNodes)
+                pNode->DependencyCount.store(pNode->InitialDependencyCount, std::memory_order_relaxed);
+
+            pWorkerPool->Execute(this, processInfo);
+        }
+        else
+        {
+            // Without the worker threads there's no point in tracking the dependencies,
+            // so we just walk the nodes in topological order.
+            for (ExecutionGraphNode* pNode : m_SortedNodes)
+                ProcessNode(processInfo, pNode);
+        }
+
+        ExecuteSteps(processInfo, nullptr, m_MonitorFirstStepIndex, m_MonitorStepCount);
+    }
+
+
+    uint32_t ExecutionGraph::CountDenormals(uint64_t sampleCount) const
+    {
+        const auto countPortDenormals = [sampleCount](std::span<const Rc<Port>> ports) {
+            uint32_t result = 0;
+            for (const Rc<Port>& pPort : ports)
             {
-                Port* pSource = pPortManager->FindPortByHandle(sourceHandle);
-                pAudioBuffer->Mix(pSource->GetBufferView(), firstSampleIndex, firstSampleIndex, length);
+                const AudioBufferView* pBuffer = GetAudioBufferView(pPort.Get());
+                if (!pBuffer->IsSilent())
+                    result += audio::CountDenormals(pBuffer->Data(), Min(sampleCount, pBuffer->GetCapacity()));
             }
+
+            return result;
+        };
+
+        uint32_t result = 0;
+        for (const ExecutionGraphNode* pNode : m_AllNodes)
+        {
+            result += countPortDenormals(pNode->Track->GetInputPorts());
+            result += countPortDenormals(pNode->Track->GetOutputPorts());
         }
+
+        return result;
     }
 } // namespace quinte
@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include <Core/Memory/LinearAllocator.hpp>
 #include <Graph/ExecutionGraphNode.hpp>
+#include <unordered_map>
 
 namespace quinte
 {
@@ -10,18 +11,104 @@ namespace quinte
     }
 
 
+    class GraphWorkerPool;
+
+
     class ExecutionGraph final
     {
+        friend class GraphWorkerPool;
+
+        using NodeMap = std::pmr::unordered_map<const Track*, ExecutionGraphNode*>;
+        using MixSource = std::pair<const AudioBufferView*, ExecutionGraphStepFlags>;
+
         memory::LinearAllocator m_NodeAllocator;
         std::pmr::vector<ExecutionGraphNode*> m_InitialNodes;
         std::pmr::vector<ExecutionGraphNode*> m_AllNodes;
+        std::pmr::vector<ExecutionGraphNode*> m_SortedNodes;
+        std::pmr::vector<ExecutionGraphStep> m_Steps;
+        std::pmr::vector<const AudioBufferView*> m_MixSources;
+        std::pmr::vector<ExecutionGraphStepFlags> m_MixSourceFlags;
+        std::pmr::vector<DelayLine*> m_DelayLines;
+        SmallVector<uint32_t, 16> m_WorkerInitialNodeOffsets;
+        uint64_t m_OutputLatency = 0;
+        uint32_t m_MonitorFirstStepIndex = 0;
+        uint32_t m_MonitorStepCount = 0;
 
-        void ProcessNode(const audio::EngineProcessInfo& processInfo, ExecutionGraphNode* pNode);
+        void AddStep(ExecutionGraphStepKind kind, AudioBufferView* pDestination, const AudioBufferView* pSource = nullptr,
+                     uint32_t channelIndex = 0, ExecutionGraphStepFlags flags = ExecutionGraphStepFlags::None);
+        void AddMixSteps(AudioBufferView* pDestination, uint32_t channelIndex, std::span<const MixSource> sources);
+        void CompileNode(ExecutionGraphNode* pNode, const NodeMap& nodeMap);
+        void CompileMonitor();
+        bool SortNodes();
+        void ComputeLatencies(const NodeMap& nodeMap);
+        void Partition(uint32_t workerCount);
+        void Reset();
+
+        void ExecuteSteps(const audio::EngineProcessInfo& processInfo, ExecutionGraphNode* pNode, uint32_t firstStepIndex,
+                          uint32_t stepCount) const;
+        bool HasAudibleInput(const audio::EngineProcessInfo& processInfo, const ExecutionGraphNode* pNode) const;
+        void ClearNodeBuffers(const audio::EngineProcessInfo& processInfo, const ExecutionGraphNode* pNode) const;
+        void ProcessNode(const audio::EngineProcessInfo& processInfo, ExecutionGraphNode* pNode) const;
+        void UpdateMeter(const audio::EngineProcessInfo& processInfo, ExecutionGraphNode* pNode) const;
 
     public:
         ~ExecutionGraph();
 
-        void Build();
-        void Run(const audio::EngineProcessInfo& processInfo);
+        //! \brief Build the graph from the current session and compile it into a flat list of steps.
+        //!
+        //! Must be called every time the topology changes: the steps reference the port buffers directly.
+        //! The dependencies between the nodes are derived from the port connections.
+        //!
+        //! \param workerCount - The number of workers in the pool that will run the graph, the nodes are
+        //!                      partitioned between them.
+        //!
+        //! \return audio::ResultCode::FailGraphCycle if the port connections contain a feedback loop.
+        audio::ResultCode Build(uint32_t workerCount);
+
+        //! \brief Get the initial nodes that are scheduled on the specified worker.
+        [[nodiscard]] inline std::span<ExecutionGraphNode* const> GetInitialNodes(uint32_t workerIndex) const
+        {
+            if (workerIndex + 1 >= m_WorkerInitialNodeOffsets.size())
+                return {};
+
+            const uint32_t first = m_WorkerInitialNodeOffsets[workerIndex];
+            const uint32_t last = m_WorkerInitialNodeOffsets[workerIndex + 1];
+            return { m_InitialNodes.data() + first, m_InitialNodes.data() + last };
+        }
+
+        void Run(const audio::EngineProcessInfo& processInfo, GraphWorkerPool* pWorkerPool);
+
+        //! \brief Count the denormal samples in the port buffers of all the tracks, used for debugging.
+        [[nodiscard]] uint32_t CountDenormals(uint64_t sampleCount) const;
+
+        //! \brief Get the latency of the master output in samples, including the latency compensation delays.
+        [[nodiscard]] inline uint64_t GetOutputLatency() const
+        {
+            return m_OutputLatency;
+        }
+
+        //! \brief Get the output latency of the track in samples, zero if the track is not in the graph.
+        [[nodiscard]] uint64_t GetTrackOutputLatency(const Track* pTrack) const;
+
+        //! \brief Find the node that processes the track, null if the track is not in the graph.
+        [[nodiscard]] const ExecutionGraphNode* FindNode(const Track* pTrack) const;
+
+        //! \brief Get the nodes in the order they are processed without the worker pool.
+        [[nodiscard]] inline std::span<const ExecutionGraphNode* const> GetSortedNodes() const
+        {
+            return { m_SortedNodes.data(), m_SortedNodes.size() };
+        }
+
+        //! \brief Get the compiled steps of a node.
+        [[nodiscard]] inline std::span<const ExecutionGraphStep> GetNodeSteps(const ExecutionGraphNode* pNode) const
+        {
+            return { m_Steps.data() + pNode->FirstStepIndex, pNode->StepCount };
+        }
+
+        //! \brief Get the buffers summed by an ExecutionGraphStepKind::MixMany step.
+        [[nodiscard]] inline std::span<const AudioBufferView* const> GetMixSources(const ExecutionGraphStep& step) const
+        {
+            return { m_MixSources.data() + step.FirstSourceIndex, step.SourceCount };
+        }
     };
 } // namespace quinte
@@ -1,16 +1,97 @@
 ﻿#pragma once
+#include <Audio/Buffers/DelayLine.hpp>
+#include <Audio/Metering.hpp>
+#include <Audio/Telemetry.hpp>
 #include <Audio/Tracks/Track.hpp>
 #include <Core/FixedVector.hpp>
 
 namespace quinte
 {
+    enum class ExecutionGraphStepKind : uint32_t
+    {
+        Clear,       //!< Clear the destination buffer.
+        ReadClips,   //!< Read the clips of the track to the destination buffer if the transport is rolling.
+        Mix,         //!< Mix the source buffer into the destination buffer.
+        MixWithGain, //!< Mix the source buffer into the destination buffer applying the track fader gain.
+        MixMany,     //!< Mix several source buffers into the destination buffer in a single pass.
+        Delay,       //!< Push the source buffer to the delay line, the delayed signal is mixed by the next step.
+    };
+
+
+    enum class ExecutionGraphStepFlags : uint32_t
+    {
+        None = 0,
+        RecordingOnly = 1 << 0, //!< The step is skipped if the track is not record armed.
+        Delayed = 1 << 1,       //!< The source is the output of a delay line.
+    };
+
+    QU_ENUM_BIT_OPERATORS(ExecutionGraphStepFlags);
+
+
+    //! \brief A single buffer operation with the ports resolved at build time.
+    struct ExecutionGraphStep final
+    {
+        AudioBufferView* pDestination = nullptr;
+        const AudioBufferView* pSource = nullptr;
+        DelayLine* pDelayLine = nullptr;
+        ExecutionGraphStepKind Kind = ExecutionGraphStepKind::Clear;
+        ExecutionGraphStepFlags Flags = ExecutionGraphStepFlags::None;
+        uint32_t ChannelIndex = 0;
+
+        //! \brief The range of ExecutionGraph::m_MixSources mixed by an ExecutionGraphStepKind::MixMany step.
+        uint32_t FirstSourceIndex = 0;
+        uint32_t SourceCount = 0;
+
+        //! \brief The double precision accumulator of a MixMany step, null if the bus is mixed in single precision.
+        double* pAccumulator = nullptr;
+    };
+
+
     struct ExecutionGraphNode final
     {
         Rc<Track> Track;
         SmallVector<ExecutionGraphNode*> Outgoing;
+
+        //! \brief The buffer the clips of the track are pre-rendered to, null if the clips are read directly.
+        PrerenderBuffer* pPrerenderBuffer = nullptr;
+
+        uint32_t FirstStepIndex = 0;
+        uint32_t StepCount = 0;
+
+        //! \brief The fader gains applied to the output channels at the end of the last cycle.
+        //!
+        //! The fader changes are ramped from these values over the next cycle to avoid zipper noise.
+        SmallVector<float, 2> OutputGains;
+
+        //! \brief The processing latency of the node itself.
+        uint64_t LatencySampleCount = 0;
+
+        //! \brief The latency of the longest path to the node inputs, all the inputs are delayed to match it.
+        uint64_t InputLatencySampleCount = 0;
+
+        //! \brief The number of samples the node keeps producing sound after its inputs become silent.
+        uint64_t TailSampleCount = 0;
+
+        //! \brief The number of samples since the inputs of the node became silent.
+        uint64_t SilentSampleCount = 0;
+
+        audio::TimingAccumulator Timing;
+        audio::MeterAccumulator Meter;
+        audio::TruePeakDetector TruePeakDetectors[audio::kMaxMeterChannelCount];
+
+        //! \brief The root of the affinity set of the node: the nodes in a set are processed on the same worker.
+        ExecutionGraphNode* pAffinityRoot = nullptr;
+
+        //! \brief The index of the worker the node is initially scheduled on.
+        uint32_t WorkerIndex = 0;
         std::atomic<uint32_t> DependencyCount = 0;
         uint32_t InitialDependencyCount = 0;
 
+        [[nodiscard]] inline uint64_t GetOutputLatency() const
+        {
+            return InputLatencySampleCount + LatencySampleCount;
+        }
+
         inline bool Trigger()
         {
             return --DependencyCount == 0;
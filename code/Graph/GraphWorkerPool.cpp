@@ -0,0 +1,200 @@
+﻿#include <Audio/Kernels/Denormals.hpp>
+#include <Graph/ExecutionGraph.hpp>
+#include <Graph/GraphWorkerPool.hpp>
+
+namespace quinte
+{
+    void GraphWorkerPool::WorkerThread(void* pUserData)
+    {
+        Worker* pWorker = static_cast<Worker*>(pUserData);
+        pWorker->pPool->WorkerThreadImpl(pWorker);
+    }
+
+
+    void GraphWorkerPool::WorkerThreadImpl(Worker* pWorker)
+    {
+        threading::PromoteCurrentThreadToRealtime();
+        threading::SetCurrentThreadAffinity(pWorker->Index);
+        audio::DisableDenormals();
+
+        while (true)
+        {
+            pWorker->WakeSemaphore.Wait();
+            if (m_ExitRequested.load(std::memory_order_acquire))
+                return;
+
+            // The worker must be registered before it checks the epoch: either Execute() sees it and waits for it
+            // to leave, or the worker sees the cycle closed and doesn't touch the graph.
+            m_ActiveWorkerCount.fetch_add(1, std::memory_order_seq_cst);
+            if (m_OpenEpoch.load(std::memory_order_seq_cst) == pWorker->WakeEpoch.load(std::memory_order_relaxed))
+                RunWorkerLoop(pWorker);
+
+            m_ActiveWorkerCount.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+
+    void GraphWorkerPool::RunWorkerLoop(Worker* pWorker)
+    {
+        while (m_PendingNodeCount.load(std::memory_order_acquire) > 0)
+        {
+            ExecutionGraphNode* pNode = TryGetNode(pWorker);
+            if (pNode == nullptr)
+            {
+                _mm_pause();
+                continue;
+            }
+
+            while (pNode)
+                pNode = ExecuteNode(pWorker, pNode);
+        }
+    }
+
+
+    ExecutionGraphNode* GraphWorkerPool::ExecuteNode(Worker* pWorker, ExecutionGraphNode* pNode)
+    {
+        m_pGraph->ProcessNode(m_ProcessInfo, pNode);
+
+        // We continue with the first node that became ready on the same thread instead of pushing it
+        // to the queue: its inputs have just been written by this worker, so they are likely still in the cache.
+        ExecutionGraphNode* pContinuation = nullptr;
+        for (ExecutionGraphNode* pOutgoingNode : pNode->Outgoing)
+        {
+            if (!pOutgoingNode->Trigger())
+                continue;
+
+            if (pContinuation == nullptr)
+                pContinuation = pOutgoingNode;
+            else
+                Push(pWorker, pOutgoingNode);
+        }
+
+        // Must be decremented only after the outgoing nodes are scheduled, otherwise the other threads
+        // could see zero pending nodes and leave while the graph has not been fully processed.
+        m_PendingNodeCount.fetch_sub(1, std::memory_order_acq_rel);
+        return pContinuation;
+    }
+
+
+    ExecutionGraphNode* GraphWorkerPool::TryTakeInitialNode(Worker* pOwner)
+    {
+        // Check before the increment, so that the index doesn't grow on every attempt once the partition is empty.
+        if (pOwner->NextInitialNodeIndex.load(std::memory_order_acquire) >= m_pGraph->GetInitialNodes(pOwner->Index).size())
+            return nullptr;
+
+        const uint32_t nodeIndex = pOwner->NextInitialNodeIndex.fetch_add(1, std::memory_order_acquire);
+        const std::span<ExecutionGraphNode* const> initialNodes = m_pGraph->GetInitialNodes(pOwner->Index);
+        return nodeIndex < initialNodes.size() ? initialNodes[nodeIndex] : nullptr;
+    }
+
+
+    ExecutionGraphNode* GraphWorkerPool::TryGetNode(Worker* pWorker)
+    {
+        ExecutionGraphNode* pResult;
+        if (pWorker->Queue.TryPop(pResult))
+            return pResult;
+
+        // The initial nodes of our own partition first, then the ones left by the workers that haven't started yet.
+        const uint32_t workerCount = GetWorkerCount();
+        for (uint32_t offset = 0; offset < workerCount; ++offset)
+        {
+            pResult = TryTakeInitialNode(m_Workers[(pWorker->Index + offset) % workerCount].get());
+            if (pResult)
+                return pResult;
+        }
+
+        for (uint32_t offset = 1; offset < workerCount; ++offset)
+        {
+            Worker* pVictim = m_Workers[(pWorker->Index + offset) % workerCount].get();
+            if (pVictim->Queue.TrySteal(pResult))
+                return pResult;
+        }
+
+        return nullptr;
+    }
+
+
+    void GraphWorkerPool::Push(Worker* pWorker, ExecutionGraphNode* pNode)
+    {
+        if (pWorker->Queue.Push(pNode)) [[likely]]
+            return;
+
+        QU_AssertDebugMsg(false, "Worker queue overflow");
+        while (pNode)
+            pNode = ExecuteNode(pWorker, pNode);
+    }
+
+
+    GraphWorkerPool::GraphWorkerPool(uint32_t threadCount)
+    {
+        m_Workers.reserve(threadCount + 1);
+        for (uint32_t workerIndex = 0; workerIndex <= threadCount; ++workerIndex)
+        {
+            memory::unique_ptr<Worker>& pWorker = m_Workers.emplace_back(memory::make_unique<Worker>());
+            pWorker->Queue.Initialize(kMaxQueuedNodeCount);
+            pWorker->pPool = this;
+            pWorker->Index = workerIndex;
+        }
+
+        // Worker zero is the audio callback thread, we don't create a thread for it.
+        for (uint32_t workerIndex = 1; workerIndex <= threadCount; ++workerIndex)
+        {
+            Worker* pWorker = m_Workers[workerIndex].get();
+            pWorker->Thread = threading::CreateThread("Graph Worker", &WorkerThread, pWorker, threading::Priority::Highest);
+        }
+    }
+
+
+    GraphWorkerPool::~GraphWorkerPool()
+    {
+        m_ExitRequested.store(true, std::memory_order_release);
+        for (memory::unique_ptr<Worker>& pWorker : m_Workers)
+            pWorker->WakeSemaphore.Release();
+
+        for (memory::unique_ptr<Worker>& pWorker : m_Workers)
+            threading::CloseThread(pWorker->Thread);
+    }
+
+
+    void GraphWorkerPool::Execute(ExecutionGraph* pGraph, const audio::EngineProcessInfo& processInfo)
+    {
+        QU_AssertDebug(m_PendingNodeCount.load(std::memory_order_relaxed) == 0);
+        QU_AssertDebug(IsIdle());
+
+        const uint32_t nodeCount = static_cast<uint32_t>(pGraph->m_AllNodes.size());
+        if (nodeCount == 0)
+            return;
+
+        // No worker can be running here, so the cycle state can be written without synchronization.
+        m_pGraph = pGraph;
+        m_ProcessInfo = processInfo;
+
+        // The initial nodes are taken from the graph partitions, so they are available to all the workers
+        // as soon as the cycle is open, even if the thread of their partition is not running yet.
+        for (const memory::unique_ptr<Worker>& pWorker : m_Workers)
+            pWorker->NextInitialNodeIndex.store(0, std::memory_order_relaxed);
+
+        m_PendingNodeCount.store(nodeCount, std::memory_order_relaxed);
+
+        // Any node can make many others ready, so all the workers are woken up, not only the ones that have
+        // initial nodes. There's no point in waking up more threads than there are nodes though.
+        const uint64_t epoch = ++m_LastEpoch;
+        const uint32_t wakeCount = Min(GetWorkerCount(), nodeCount);
+        for (uint32_t workerIndex = 1; workerIndex < wakeCount; ++workerIndex)
+            m_Workers[workerIndex]->WakeEpoch.store(epoch, std::memory_order_relaxed);
+
+        // Publishes all of the above to the workers that see the epoch.
+        m_OpenEpoch.store(epoch, std::memory_order_seq_cst);
+        for (uint32_t workerIndex = 1; workerIndex < wakeCount; ++workerIndex)
+            m_Workers[workerIndex]->WakeSemaphore.Release();
+
+        // The callback thread joins the workers and spins until the whole graph is processed.
+        RunWorkerLoop(m_Workers[0].get());
+
+        // The workers that haven't joined yet won't join anymore, and we wait for the others to leave
+        // the worker loop, so that the next cycle (or the graph destruction) doesn't race with them.
+        m_OpenEpoch.store(0, std::memory_order_seq_cst);
+        while (m_ActiveWorkerCount.load(std::memory_order_seq_cst) > 0)
+            _mm_pause();
+    }
+} // namespace quinte
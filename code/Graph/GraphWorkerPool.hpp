@@ -0,0 +1,92 @@
+﻿#pragma once
+#include <Audio/Engine.hpp>
+#include <Core/FixedVector.hpp>
+#include <Core/Threading.hpp>
+#include <Core/WorkStealingDeque.hpp>
+
+namespace quinte
+{
+    class ExecutionGraph;
+    struct ExecutionGraphNode;
+
+
+    //! \brief A pool of real-time threads that execute ExecutionGraph nodes in parallel.
+    //!
+    //! Each worker owns a work-stealing deque. When a node is processed, the nodes that became ready
+    //! (their dependency counter reached zero) are pushed to the deque of the current worker, so the data they
+    //! read is likely still in the cache. Idle workers steal from the others.
+    //!
+    //! The thread that calls Execute() (the audio callback thread) is worker zero: it participates in processing
+    //! and returns only when all the nodes of the graph have been processed.
+    //!
+    //! The initial nodes are partitioned between the workers in ExecutionGraph::Build(), the worker threads are pinned
+    //! to separate cores, so that the nodes of the same affinity set share the caches. The partitions are shared
+    //! injection queues: a worker takes the nodes of its own partition first, but any worker can take them,
+    //! so the cycle never waits for a particular thread to be scheduled. Work stealing balances the load
+    //! when the partitioning is off.
+    class GraphWorkerPool final : public NoCopyMove
+    {
+        struct alignas(memory::kCacheLineSize) Worker final
+        {
+            WorkStealingDeque<ExecutionGraphNode*> Queue;
+            std::atomic<uint32_t> NextInitialNodeIndex = 0;
+            std::atomic<uint64_t> WakeEpoch = 0;
+            threading::Semaphore WakeSemaphore;
+            threading::ThreadHandle Thread;
+            GraphWorkerPool* pPool = nullptr;
+            uint32_t Index = 0;
+        };
+
+        SmallVector<memory::unique_ptr<Worker>, 16> m_Workers;
+
+        ExecutionGraph* m_pGraph = nullptr;
+        audio::EngineProcessInfo m_ProcessInfo{};
+
+        alignas(memory::kCacheLineSize) std::atomic<uint32_t> m_PendingNodeCount = 0;
+        std::atomic<bool> m_ExitRequested = false;
+
+        // The epoch of the cycle the workers are allowed to join, zero when no cycle is running.
+        // A worker woken late compares it with the epoch it was woken for and goes back to sleep if the cycle is over.
+        alignas(memory::kCacheLineSize) std::atomic<uint64_t> m_OpenEpoch = 0;
+        std::atomic<uint32_t> m_ActiveWorkerCount = 0;
+        uint64_t m_LastEpoch = 0;
+
+        static void WorkerThread(void* pUserData);
+        void WorkerThreadImpl(Worker* pWorker);
+
+        void RunWorkerLoop(Worker* pWorker);
+        ExecutionGraphNode* ExecuteNode(Worker* pWorker, ExecutionGraphNode* pNode);
+        ExecutionGraphNode* TryTakeInitialNode(Worker* pOwner);
+        ExecutionGraphNode* TryGetNode(Worker* pWorker);
+        void Push(Worker* pWorker, ExecutionGraphNode* pNode);
+
+    public:
+        //! \brief The maximum number of nodes that can be ready for execution at the same time.
+        inline static constexpr uint32_t kMaxQueuedNodeCount = 4096;
+
+        //! \brief Create a pool.
+        //!
+        //! \param threadCount - The number of threads to create, the calling thread is not included.
+        explicit GraphWorkerPool(uint32_t threadCount);
+        ~GraphWorkerPool();
+
+        [[nodiscard]] inline uint32_t GetWorkerCount() const
+        {
+            return static_cast<uint32_t>(m_Workers.size());
+        }
+
+        //! \brief Check if none of the worker threads is currently running.
+        //!
+        //! Always true between the calls to Execute(): it waits for all the workers to leave the cycle.
+        [[nodiscard]] inline bool IsIdle() const
+        {
+            return m_ActiveWorkerCount.load(std::memory_order_acquire) == 0;
+        }
+
+        //! \brief Process all the nodes of the graph and wait for completion.
+        //!
+        //! Must be called from the audio callback thread only. When this function returns, no worker thread
+        //! references the graph anymore.
+        void Execute(ExecutionGraph* pGraph, const audio::EngineProcessInfo& processInfo);
+    };
+} // namespace quinte
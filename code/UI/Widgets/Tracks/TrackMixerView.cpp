@@ -14,7 +14,8 @@ namespace quinte
 
         Fader* pFader = pTrack->GetFader();
 
-        MaxVolume = Max(MaxVolume, pFader->GetGain().GetAmplitude());
+        const float meterPeak = pTrack->GetMeter().GetPeak();
+        MaxVolume = Max(MaxVolume, meterPeak);
 
         const ImGuiStyle& style = GetStyle();
         const float width = 80.0f + style.ItemInnerSpacing.x * 2.0f;
@@ -64,14 +65,14 @@ namespace quinte
 
                 const ColorScope colorTxt{ ImGuiCol_Text, ui::GetAmplitudeValueColor(MaxVolume) };
                 if (Button(FixFmt32{ "{:.1f}", audio::ConvertAmplitudeToDBFS(MaxVolume) }.Data(), ImVec2{ labelWidth, 0.0f }))
-                    MaxVolume = pFader->GetGain().GetAmplitude();
+                    MaxVolume = 0.0f;
             }
 
             // TODO: move fader view to its own class
             float faderAmplitude = pFader->GetGain().GetAmplitude();
 
             SetCursorPosY(GetCursorPosY() + 8.0f);
-            if (ui::Fader("##Fader", &faderAmplitude, faderAmplitude, 200.0f))
+            if (ui::Fader("##Fader", &faderAmplitude, meterPeak, 200.0f))
             {
                 pFader->SetGain(audio::GainValue{ faderAmplitude });
                 valuesChanged = true;
@@ -7,7 +7,7 @@ namespace quinte
     class TrackMixerView final
     {
     public:
-        float MaxVolume = 1.0f;
+        float MaxVolume = 0.0f;
         Rc<Track> pTrack;
 
         uint32_t ID = 0;
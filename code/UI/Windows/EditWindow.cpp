@@ -27,7 +27,7 @@ namespace quinte
         ImDrawList* pDrawList = GetWindowDrawList();
         InvisibleButton(FixFmt32{ "##TrackLane_{}", trackInfo.ID }.Data(), { width, height });
 
-        for (AudioClip& clip : trackInfo.pTrack->GetPlaylist())
+        for (const AudioClip& clip : trackInfo.pTrack->GetPlaylist())
         {
             const int64_t clipPos = static_cast<int64_t>(clip.GetPosition().GetSampleIndex()) - m_TimelineStart;
             const int64_t clipEndPos = static_cast<int64_t>(clip.GetEndPosition().GetSampleIndex()) - m_TimelineStart;
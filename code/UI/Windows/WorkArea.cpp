@@ -1,4 +1,5 @@
 ﻿#include <Application/Application.hpp>
+#include <Audio/Engine.hpp>
 #include <Audio/Tracks/Track.hpp>
 #include <UI/Icons.hpp>
 #include <UI/Widgets/Tracks/TrackMixerView.hpp>
@@ -28,6 +29,8 @@ namespace quinte
 
         static bool s_ShowDemo = false;
 
+        Interface<AudioEngine>::Get()->CollectRetiredGraphs();
+
         const auto* pApplication = Interface<Application>::Get();
         const int32_t rootWidth = pApplication->GetWidth();
         const int32_t rootHeight = pApplication->GetHeight();
@@ -190,6 +193,9 @@ namespace quinte
             const StringSlice streamStateString = audio::ToString(pAPI->GetState());
             Text("Current stream state: %.*s", static_cast<int32_t>(streamStateString.Size()), streamStateString.Data());
 
+            const audio::EngineStats engineStats = Interface<AudioEngine>::Get()->GetStats();
+            Text("DSP load: %.1f%% (peak %.1f%%)", engineStats.DSPLoad * 100.0f, engineStats.PeakDSPLoad * 100.0f);
+
             if (Button("Open Stream"))
             {
                 if (pAPI->GetState() != audio::StreamState::Running)
@@ -0,0 +1,111 @@
+﻿#include <Audio/Backend/Dummy.hpp>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace quinte;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t kBufferSize = 480;
+    constexpr uint32_t kCycleCount = 16;
+
+    //! \brief The period of a cycle at 48 kHz.
+    constexpr std::chrono::microseconds kPeriod{ 10000 };
+
+
+    struct CallbackRecord final
+    {
+        Clock::time_point Times[kCycleCount];
+        audio::StreamStatus Statuses[kCycleCount];
+        uint32_t CycleCount = 0;
+
+        //! \brief The callback sleeps for this long on the cycle kSlowCycleIndex.
+        std::chrono::microseconds SlowCycleDuration{ 0 };
+        inline static constexpr uint32_t kSlowCycleIndex = 4;
+    };
+
+
+    audio::CallbackResult RecordCallback(void*, void*, uint32_t frameCount, double, audio::StreamStatus status, void* pUserData)
+    {
+        CallbackRecord* pRecord = static_cast<CallbackRecord*>(pUserData);
+        EXPECT_EQ(frameCount, kBufferSize);
+
+        const uint32_t cycleIndex = pRecord->CycleCount++;
+        pRecord->Times[cycleIndex] = Clock::now();
+        pRecord->Statuses[cycleIndex] = status;
+
+        if (cycleIndex == CallbackRecord::kSlowCycleIndex)
+            std::this_thread::sleep_for(pRecord->SlowCycleDuration);
+
+        return pRecord->CycleCount == kCycleCount ? audio::CallbackResult::Stop : audio::CallbackResult::OK;
+    }
+
+
+    //! \brief Run the dummy stream until the callback stops it.
+    void RunStream(CallbackRecord& record)
+    {
+        AudioBackendDummy backend;
+        ASSERT_EQ(backend.UpdateDeviceList(), audio::ResultCode::Success);
+
+        audio::StreamDesc outputDesc{};
+        outputDesc.DeviceID = backend.GetDefaultOutputDevice();
+        outputDesc.ChannelCount = 2;
+
+        audio::StreamOpenInfo openInfo{};
+        openInfo.pOutputDesc = &outputDesc;
+        openInfo.Format = audio::Format::Float32;
+        openInfo.SampleRate = audio::SampleRate::Value_48000;
+        openInfo.BufferFrameCount = kBufferSize;
+        openInfo.Callback = &RecordCallback;
+        openInfo.pUserData = &record;
+        ASSERT_EQ(backend.OpenStream(openInfo), audio::ResultCode::Success);
+        ASSERT_EQ(backend.GetAudioBufferSize(), kBufferSize);
+        ASSERT_EQ(backend.GetSampleRate(), 48000u);
+
+        ASSERT_EQ(backend.StartStream(), audio::ResultCode::Success);
+        while (backend.GetState() == audio::StreamState::Running)
+            std::this_thread::sleep_for(kPeriod);
+
+        backend.CloseStream();
+        ASSERT_EQ(record.CycleCount, kCycleCount);
+    }
+} // namespace
+
+
+TEST(AudioBackendDummy, CallbackPeriod)
+{
+    CallbackRecord record;
+    ASSERT_NO_FATAL_FAILURE(RunStream(record));
+
+    // The deadlines are spaced by exactly one period, a late wake up only delays the cycle it happened in.
+    for (uint32_t cycleIndex = 1; cycleIndex < kCycleCount; ++cycleIndex)
+    {
+        const auto interval = record.Times[cycleIndex] - record.Times[cycleIndex - 1];
+        EXPECT_GE(interval, kPeriod * 9 / 10) << cycleIndex;
+    }
+
+    const auto elapsed = record.Times[kCycleCount - 1] - record.Times[0];
+    EXPECT_GE(elapsed, kPeriod * (kCycleCount - 1) * 9 / 10);
+    EXPECT_LE(elapsed, kPeriod * (kCycleCount - 1) * 3 / 2);
+    EXPECT_EQ(record.Statuses[0], audio::StreamStatus::OK);
+}
+
+
+TEST(AudioBackendDummy, OverrunReportsUnderflow)
+{
+    CallbackRecord record;
+    record.SlowCycleDuration = 3 * kPeriod;
+    ASSERT_NO_FATAL_FAILURE(RunStream(record));
+
+    // Only the cycle after the slow one is told about the underflow, the stream doesn't try to catch up.
+    constexpr uint32_t kSlowCycleIndex = CallbackRecord::kSlowCycleIndex;
+    for (uint32_t cycleIndex = 0; cycleIndex <= kSlowCycleIndex; ++cycleIndex)
+        EXPECT_EQ(record.Statuses[cycleIndex], audio::StreamStatus::OK) << cycleIndex;
+
+    EXPECT_EQ(record.Statuses[kSlowCycleIndex + 1], audio::StreamStatus::OutputUnderflow);
+    EXPECT_EQ(record.Statuses[kSlowCycleIndex + 2], audio::StreamStatus::OK);
+    EXPECT_GE(record.Times[kSlowCycleIndex + 2] - record.Times[kSlowCycleIndex + 1], kPeriod * 9 / 10);
+}
@@ -0,0 +1,136 @@
+﻿#include <Audio/Dither.hpp>
+#include <Audio/Kernels/Kernels.hpp>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace quinte;
+
+namespace
+{
+    constexpr uint32_t kLength = 48000;
+
+
+    std::vector<float> Dither(audio::NoiseShaping noiseShaping, const std::vector<float>& source, uint32_t bitDepth = 16)
+    {
+        audio::Ditherer ditherer;
+        ditherer.Initialize(1, bitDepth, noiseShaping);
+
+        // Odd block sizes to check that the state is kept between the calls.
+        std::vector<float> result(source.size());
+        for (uint32_t offset = 0; offset < source.size();)
+        {
+            const uint32_t length = std::min<uint32_t>(333, static_cast<uint32_t>(source.size()) - offset);
+            ditherer.Process(0, result.data() + offset, source.data() + offset, length);
+            offset += length;
+        }
+
+        return result;
+    }
+
+
+    std::vector<int16_t> ConvertToInt16(const std::vector<float>& source)
+    {
+        std::vector<int16_t> result(source.size());
+        audio::GetKernels().FloatToInt16(result.data(), source.data(), source.size());
+        return result;
+    }
+
+
+    // The correlation of the quantization error with itself delayed by one sample.
+    double MeasureErrorCorrelation(const std::vector<float>& source, const std::vector<int16_t>& quantized)
+    {
+        double product = 0.0;
+        double energy = 0.0;
+        double previousError = 0.0;
+        for (size_t sampleIndex = 0; sampleIndex < source.size(); ++sampleIndex)
+        {
+            const double error = quantized[sampleIndex] - static_cast<double>(source[sampleIndex]) * 32768.0;
+            product += error * previousError;
+            energy += error * error;
+            previousError = error;
+        }
+
+        return product / energy;
+    }
+
+
+    std::vector<float> MakeSine(float amplitude)
+    {
+        std::vector<float> result(kLength);
+        for (uint32_t sampleIndex = 0; sampleIndex < kLength; ++sampleIndex)
+            result[sampleIndex] = amplitude * static_cast<float>(std::sin(0.05 * sampleIndex));
+
+        return result;
+    }
+} // namespace
+
+
+TEST(AudioDither, Triangular)
+{
+    // A signal below half of the LSB would be quantized to silence without dither.
+    const std::vector<float> source = MakeSine(0.4f / 32768.0f);
+    const std::vector<int16_t> quantized = ConvertToInt16(Dither(audio::NoiseShaping::None, source));
+
+    double sum = 0.0;
+    double correlation = 0.0;
+    for (uint32_t sampleIndex = 0; sampleIndex < kLength; ++sampleIndex)
+    {
+        EXPECT_LE(std::abs(quantized[sampleIndex]), 2);
+        sum += quantized[sampleIndex];
+        correlation += quantized[sampleIndex] * source[sampleIndex] * 32768.0;
+    }
+
+    // The dither is zero-mean and the signal survives the quantization on average.
+    EXPECT_NEAR(sum / kLength, 0.0, 0.05);
+    EXPECT_GT(correlation / kLength, 0.05);
+    EXPECT_NEAR(MeasureErrorCorrelation(source, quantized), 0.0, 0.05);
+}
+
+
+TEST(AudioDither, NoiseShaping)
+{
+    const std::vector<float> source = MakeSine(0.25f);
+
+    // The first-order filter multiplies the error by 1 - z^-1, the correlation of the result is -1/2.
+    const std::vector<int16_t> firstOrder = ConvertToInt16(Dither(audio::NoiseShaping::FirstOrder, source));
+    EXPECT_NEAR(MeasureErrorCorrelation(source, firstOrder), -0.5, 0.05);
+
+    const std::vector<int16_t> lipshitz = ConvertToInt16(Dither(audio::NoiseShaping::Lipshitz, source));
+    EXPECT_LT(MeasureErrorCorrelation(source, lipshitz), -0.5);
+
+    // The shaped output is already quantized, the conversion must not change it.
+    const std::vector<float> shaped = Dither(audio::NoiseShaping::Lipshitz, source, 24);
+    for (float sample : shaped)
+        ASSERT_EQ(sample * 8388608.0f, std::round(sample * 8388608.0f));
+}
+
+
+TEST(AudioDither, FullScale)
+{
+    const std::vector<float> source(kLength, 1.0f);
+    for (audio::NoiseShaping noiseShaping :
+         { audio::NoiseShaping::None, audio::NoiseShaping::FirstOrder, audio::NoiseShaping::Lipshitz })
+    {
+        const std::vector<int16_t> quantized = ConvertToInt16(Dither(noiseShaping, source));
+        for (int16_t sample : quantized)
+            ASSERT_GT(sample, 32700);
+    }
+}
+
+
+TEST(AudioDither, Deterministic)
+{
+    const std::vector<float> source = MakeSine(0.5f);
+    EXPECT_EQ(Dither(audio::NoiseShaping::Lipshitz, source), Dither(audio::NoiseShaping::Lipshitz, source));
+
+    audio::Ditherer ditherer;
+    ditherer.Initialize(2, 16, audio::NoiseShaping::None);
+
+    // The channels have independent generators.
+    std::vector<float> first(source.size());
+    std::vector<float> second(source.size());
+    ditherer.Process(0, first.data(), source.data(), kLength);
+    ditherer.Process(1, second.data(), source.data(), kLength);
+    EXPECT_NE(first, second);
+}
@@ -0,0 +1,202 @@
+﻿#include <Audio/Buffers/MultichannelAudioBuffer.hpp>
+#include <Audio/Engine.hpp>
+#include <Audio/Session.hpp>
+#include <Audio/Sinks/AudioSink.hpp>
+#include <Audio/Sources/BufferAudioSource.hpp>
+#include <Audio/Transport.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace quinte;
+
+namespace
+{
+    // Check that the segments cover the cycle and compute the timeline position of every sample.
+    std::vector<uint64_t> GetSamplePositions(const audio::CycleSegmentList& segments, uint32_t frameCount)
+    {
+        std::vector<uint64_t> result;
+        for (const audio::EngineProcessInfo& segment : segments)
+        {
+            EXPECT_EQ(segment.LocalRange.GetFirstSampleIndex(), result.size());
+            EXPECT_GT(segment.LocalRange.Length, 0u);
+            for (uint64_t sampleIndex = 0; sampleIndex < segment.LocalRange.Length; ++sampleIndex)
+                result.push_back((segment.LocalRange + segment.StartTime).GetFirstSampleIndex() + sampleIndex);
+        }
+
+        EXPECT_EQ(result.size(), frameCount);
+        return result;
+    }
+
+
+    class MemoryAudioSink final : public AudioSink
+    {
+    public:
+        std::vector<float> Channels[2];
+        bool Finalized = false;
+
+        audio::ResultCode Write(std::span<const float* const> channels, uint32_t frameCount) override
+        {
+            EXPECT_FALSE(Finalized);
+            for (uint32_t channelIndex = 0; channelIndex < 2; ++channelIndex)
+            {
+                const float* pChannel = channels[channelIndex];
+                Channels[channelIndex].insert(Channels[channelIndex].end(), pChannel, pChannel + frameCount);
+            }
+
+            return audio::ResultCode::Success;
+        }
+
+        audio::ResultCode Finalize() override
+        {
+            Finalized = true;
+            return audio::ResultCode::Success;
+        }
+    };
+} // namespace
+
+
+TEST(AudioEngine, SplitCycleAtLoopEnd)
+{
+    const audio::TimeRange64 loopRange{ 1000, 500 };
+
+    audio::CycleSegmentList segments;
+    const audio::TimePos64 playhead = audio::SplitCycle(audio::TimePos64{ 1400 }, 256, loopRange, true, segments);
+    ASSERT_EQ(segments.size(), 2u);
+    EXPECT_EQ(playhead.GetSampleIndex(), 1156u);
+
+    const std::vector<uint64_t> positions = GetSamplePositions(segments, 256);
+    for (uint32_t sampleIndex = 0; sampleIndex < 256; ++sampleIndex)
+        EXPECT_EQ(positions[sampleIndex], sampleIndex < 100 ? 1400 + sampleIndex : 900 + sampleIndex);
+}
+
+
+TEST(AudioEngine, SplitCycleNotRolling)
+{
+    const audio::TimeRange64 loopRange{ 1000, 500 };
+
+    audio::CycleSegmentList segments;
+    const audio::TimePos64 playhead = audio::SplitCycle(audio::TimePos64{ 1400 }, 256, loopRange, false, segments);
+    ASSERT_EQ(segments.size(), 1u);
+    EXPECT_EQ(playhead.GetSampleIndex(), 1400u);
+}
+
+
+TEST(AudioEngine, SplitCycleShortLoop)
+{
+    // The loop is so short that the cycle can't be split at every wrap, the playhead must still stay in the loop.
+    constexpr uint32_t kFrameCount = 256;
+    const audio::TimeRange64 loopRange{ 100, 3 };
+
+    audio::TimePos64 playhead{ 90 };
+    for (uint32_t cycleIndex = 0; cycleIndex < 100; ++cycleIndex)
+    {
+        audio::CycleSegmentList segments;
+        const audio::TimePos64 cycleStart = playhead;
+        playhead = audio::SplitCycle(playhead, kFrameCount, loopRange, true, segments);
+        ASSERT_EQ(segments.size(), audio::kMaxSegmentsPerCycle);
+        ASSERT_GE(playhead.GetSampleIndex(), 100u);
+        ASSERT_LT(playhead.GetSampleIndex(), 103u);
+
+        // The playhead moves as if every wrap was sample-accurate.
+        const uint64_t startIndex = cycleStart.GetSampleIndex();
+        const uint64_t loopOffset = startIndex < 100 ? kFrameCount - (100 - startIndex) : startIndex - 100 + kFrameCount;
+        ASSERT_EQ(playhead.GetSampleIndex(), 100 + loopOffset % 3);
+
+        const std::vector<uint64_t> positions = GetSamplePositions(segments, kFrameCount);
+        ASSERT_EQ(positions[0], startIndex);
+    }
+}
+
+
+TEST(AudioEngine, LatencyCompensation)
+{
+    // A node that delays the timeline by kLatency samples, rendered in cycles like the offline renderer does.
+    constexpr uint64_t kLatency = 1000;
+    constexpr uint64_t kRangeStart = 5000;
+    constexpr uint64_t kRangeLength = 3000;
+    constexpr uint32_t kBufferSize = 256;
+
+    const auto renderDelayedNode = [](uint64_t timelinePosition) {
+        return timelinePosition < kLatency ? 0.0f : static_cast<float>(timelinePosition - kLatency);
+    };
+
+    audio::LatencyCompensator compensator{ kRangeLength, kLatency };
+    EXPECT_EQ(compensator.GetPendingFrameCount(), kRangeLength + kLatency);
+
+    std::vector<float> result;
+    uint64_t playhead = kRangeStart;
+    std::vector<float> output(kBufferSize);
+    while (compensator.GetPendingFrameCount() > 0)
+    {
+        const uint32_t frameCount = static_cast<uint32_t>(Min<uint64_t>(compensator.GetPendingFrameCount(), kBufferSize));
+        for (uint32_t frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+            output[frameIndex] = renderDelayedNode(playhead + frameIndex);
+
+        playhead += frameCount;
+
+        const audio::TimeRange32 outputRange = compensator.Advance(frameCount);
+        ASSERT_LE(outputRange.GetLastSampleIndex(), frameCount);
+        result.insert(result.end(), output.begin() + outputRange.GetFirstSampleIndex(),
+                      output.begin() + outputRange.GetLastSampleIndex());
+    }
+
+    // The first sample written is the one at the start of the range, no matter how long the latency is.
+    ASSERT_EQ(result.size(), kRangeLength);
+    for (uint64_t sampleIndex = 0; sampleIndex < kRangeLength; ++sampleIndex)
+        ASSERT_EQ(result[sampleIndex], static_cast<float>(kRangeStart + sampleIndex));
+}
+
+
+TEST(AudioEngine, RenderOfflineLatency)
+{
+    constexpr uint32_t kBufferSize = 128;
+    constexpr uint32_t kLatency = 300;
+    constexpr uint64_t kClipPosition = 1024;
+    constexpr uint64_t kClipLength = 512;
+
+    AudioEngine engine;
+    Transport transport;
+    Session session;
+
+    ASSERT_EQ(engine.InitializeAPI(audio::APIKind::Offline), audio::ResultCode::Success);
+    IAudioAPI* pAPI = engine.GetAPI();
+    ASSERT_EQ(engine.Start({ pAPI->GetDefautInputDevice(), pAPI->GetDefaultOutputDevice(), kBufferSize }),
+              audio::ResultCode::Success);
+
+    // A ramp on a track without latency, the samples are numbered from one, so that a shift by any amount is detected.
+    MultichannelAudioBuffer* pRamp = Rc<MultichannelAudioBuffer>::DefaultNew(2u, kClipLength);
+    for (uint32_t channelIndex = 0; channelIndex < 2; ++channelIndex)
+    {
+        float* pData = pRamp->GetChannelData(channelIndex);
+        for (uint64_t sampleIndex = 0; sampleIndex < kClipLength; ++sampleIndex)
+            pData[sampleIndex] = static_cast<float>(sampleIndex + 1);
+    }
+
+    Track* pClipTrack = session.CreateTrack();
+    pClipTrack->InsertClip(AudioClip{ Rc<BufferAudioSource>::DefaultNew(pRamp), kClipPosition });
+
+    // Another track reports a latency, the master delays the ramp to match it.
+    Track* pLatentTrack = session.CreateBus();
+    pLatentTrack->SetLatency(kLatency);
+    ASSERT_EQ(engine.RebuildGraph(), audio::ResultCode::Success);
+
+    // The range ends in the middle of a cycle, the render is extended by the latency.
+    const audio::TimeRange64 range{ 512, 2000 };
+    MemoryAudioSink sink;
+    ASSERT_EQ(engine.RenderOffline(range, &sink), audio::ResultCode::Success);
+    EXPECT_TRUE(sink.Finalized);
+
+    ASSERT_EQ(sink.Channels[0].size(), range.GetLengthInSamples());
+    ASSERT_EQ(sink.Channels[1].size(), range.GetLengthInSamples());
+
+    for (uint64_t sampleIndex = 0; sampleIndex < range.GetLengthInSamples(); ++sampleIndex)
+    {
+        const uint64_t position = range.GetFirstSampleIndex() + sampleIndex;
+        const bool insideClip = position >= kClipPosition && position < kClipPosition + kClipLength;
+        const float expected = insideClip ? static_cast<float>(position - kClipPosition + 1) : 0.0f;
+        ASSERT_NEAR(sink.Channels[0][sampleIndex], expected, 1e-3f) << position;
+        ASSERT_NEAR(sink.Channels[1][sampleIndex], expected, 1e-3f) << position;
+    }
+
+    engine.Stop();
+}
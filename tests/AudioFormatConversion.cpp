@@ -0,0 +1,201 @@
+﻿#include <Audio/Backend/FormatConversion.hpp>
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace quinte;
+
+namespace
+{
+    constexpr uint32_t kFrameCount = 1000;
+
+
+    // The layout of the output streams: the planar user buffer is converted to the interleaved device buffer.
+    BackendConversionInfo MakeOutputInfo(audio::Format userFormat, audio::Format deviceFormat, uint32_t channelCount,
+                                         uint32_t deviceChannelCount, uint32_t firstChannelIndex)
+    {
+        BackendConversionInfo info{};
+        info.ChannelCount = channelCount;
+        info.IsNeeded = true;
+        info.In.Format = userFormat;
+        info.In.Jump = 1;
+        info.Out.Format = deviceFormat;
+        info.Out.Jump = deviceChannelCount;
+        for (uint32_t channelIndex = 0; channelIndex < channelCount; ++channelIndex)
+        {
+            info.In.Offset.push_back(channelIndex * kFrameCount);
+            info.Out.Offset.push_back(channelIndex + firstChannelIndex);
+        }
+
+        info.pConvert = SelectBackendConverter(info);
+        return info;
+    }
+
+
+    // The layout of the input streams: the interleaved device buffer is converted to the planar user buffer.
+    BackendConversionInfo MakeInputInfo(audio::Format deviceFormat, audio::Format userFormat, uint32_t channelCount,
+                                        uint32_t deviceChannelCount)
+    {
+        BackendConversionInfo info{};
+        info.ChannelCount = channelCount;
+        info.IsNeeded = true;
+        info.In.Format = deviceFormat;
+        info.In.Jump = deviceChannelCount;
+        info.Out.Format = userFormat;
+        info.Out.Jump = 1;
+        for (uint32_t channelIndex = 0; channelIndex < channelCount; ++channelIndex)
+        {
+            info.In.Offset.push_back(channelIndex);
+            info.Out.Offset.push_back(channelIndex * kFrameCount);
+        }
+
+        info.pConvert = SelectBackendConverter(info);
+        return info;
+    }
+
+
+    std::vector<float> MakePlanarSignal(uint32_t channelCount)
+    {
+        std::vector<float> result(channelCount * kFrameCount);
+        for (uint32_t sampleIndex = 0; sampleIndex < result.size(); ++sampleIndex)
+            result[sampleIndex] = static_cast<float>((sampleIndex * 7919) % 2001) / 1000.0f - 1.0f;
+
+        return result;
+    }
+
+
+    template<class T>
+    const uint8_t* AsBytes(const std::vector<T>& buffer)
+    {
+        return reinterpret_cast<const uint8_t*>(buffer.data());
+    }
+
+
+    template<class T>
+    uint8_t* AsBytes(std::vector<T>& buffer)
+    {
+        return reinterpret_cast<uint8_t*>(buffer.data());
+    }
+} // namespace
+
+
+TEST(AudioFormatConversion, InterleaveInt16)
+{
+    for (uint32_t channelCount : { 1u, 2u, 3u })
+    {
+        const std::vector<float> source = MakePlanarSignal(channelCount);
+        std::vector<int16_t> device(channelCount * kFrameCount);
+
+        const BackendConversionInfo info =
+            MakeOutputInfo(audio::Format::Float32, audio::Format::Int16, channelCount, channelCount, 0);
+        info.pConvert(AsBytes(device), AsBytes(source), kFrameCount, info);
+
+        for (uint32_t channelIndex = 0; channelIndex < channelCount; ++channelIndex)
+        {
+            for (uint32_t frameIndex = 0; frameIndex < kFrameCount; ++frameIndex)
+            {
+                const float value = source[channelIndex * kFrameCount + frameIndex];
+                const int32_t expected = std::clamp(static_cast<int32_t>(std::lrint(value * 32768.0f)), -32768, 32767);
+                ASSERT_EQ(device[frameIndex * channelCount + channelIndex], expected);
+            }
+        }
+    }
+}
+
+
+TEST(AudioFormatConversion, InterleaveInt24WithOffset)
+{
+    constexpr uint32_t kChannelCount = 2;
+    constexpr uint32_t kDeviceChannelCount = 4;
+
+    const std::vector<float> source = MakePlanarSignal(kChannelCount);
+    std::vector<Int24> device(kDeviceChannelCount * kFrameCount, Int24{ 0 });
+
+    const BackendConversionInfo info =
+        MakeOutputInfo(audio::Format::Float32, audio::Format::Int24, kChannelCount, kDeviceChannelCount, 1);
+    info.pConvert(AsBytes(device), AsBytes(source), kFrameCount, info);
+
+    for (uint32_t frameIndex = 0; frameIndex < kFrameCount; ++frameIndex)
+    {
+        const Int24* pFrame = device.data() + frameIndex * kDeviceChannelCount;
+        EXPECT_EQ(static_cast<int32_t>(pFrame[0]), 0);
+        EXPECT_EQ(static_cast<int32_t>(pFrame[3]), 0);
+        for (uint32_t channelIndex = 0; channelIndex < kChannelCount; ++channelIndex)
+        {
+            const float value = source[channelIndex * kFrameCount + frameIndex];
+            const int32_t expected = std::clamp(static_cast<int32_t>(std::lrint(value * 8388608.0f)), -8388608, 8388607);
+            ASSERT_EQ(static_cast<int32_t>(pFrame[channelIndex + 1]), expected);
+        }
+    }
+}
+
+
+TEST(AudioFormatConversion, RoundTrip)
+{
+    const audio::Format formats[] = { audio::Format::Int16, audio::Format::Int24, audio::Format::Float32, audio::Format::Float64 };
+    for (audio::Format format : formats)
+    {
+        for (uint32_t channelCount : { 1u, 2u, 5u })
+        {
+            const std::vector<float> source = MakePlanarSignal(channelCount);
+            std::vector<uint8_t> device(channelCount * kFrameCount * audio::GetFormatByteSize(format));
+            std::vector<float> result(channelCount * kFrameCount);
+
+            const BackendConversionInfo outputInfo = MakeOutputInfo(audio::Format::Float32, format, channelCount, channelCount, 0);
+            const BackendConversionInfo inputInfo = MakeInputInfo(format, audio::Format::Float32, channelCount, channelCount);
+            outputInfo.pConvert(device.data(), AsBytes(source), kFrameCount, outputInfo);
+            inputInfo.pConvert(AsBytes(result), device.data(), kFrameCount, inputInfo);
+
+            const float tolerance = format == audio::Format::Int16 ? 1.0f / 32768.0f : 1.0f / 8388608.0f;
+            for (uint32_t sampleIndex = 0; sampleIndex < source.size(); ++sampleIndex)
+                ASSERT_NEAR(result[sampleIndex], std::clamp(source[sampleIndex], -1.0f, 1.0f), tolerance);
+        }
+    }
+}
+
+
+TEST(AudioFormatConversion, SameFormatIsExact)
+{
+    constexpr uint32_t kChannelCount = 2;
+
+    std::vector<int32_t> device(kChannelCount * kFrameCount);
+    for (uint32_t sampleIndex = 0; sampleIndex < device.size(); ++sampleIndex)
+        device[sampleIndex] = static_cast<int32_t>(sampleIndex * 2654435761u);
+
+    std::vector<int32_t> user(kChannelCount * kFrameCount);
+    const BackendConversionInfo info = MakeInputInfo(audio::Format::Int32, audio::Format::Int32, kChannelCount, kChannelCount);
+    info.pConvert(AsBytes(user), AsBytes(device), kFrameCount, info);
+
+    for (uint32_t channelIndex = 0; channelIndex < kChannelCount; ++channelIndex)
+    {
+        for (uint32_t frameIndex = 0; frameIndex < kFrameCount; ++frameIndex)
+            ASSERT_EQ(user[channelIndex * kFrameCount + frameIndex], device[frameIndex * kChannelCount + channelIndex]);
+    }
+}
+
+
+TEST(AudioFormatConversion, DitheredInterleave)
+{
+    constexpr uint32_t kChannelCount = 2;
+
+    std::vector<float> source(kChannelCount * kFrameCount, 0.0f);
+    std::fill(source.begin() + kFrameCount, source.end(), 1.0f);
+    std::vector<int16_t> device(kChannelCount * kFrameCount);
+
+    BackendConversionInfo info = MakeOutputInfo(audio::Format::Float32, audio::Format::Int16, kChannelCount, kChannelCount, 0);
+    info.pDitherer = memory::make_unique<audio::Ditherer>();
+    info.pDitherer->Initialize(kChannelCount, 16, audio::NoiseShaping::None);
+    info.pConvert(AsBytes(device), AsBytes(source), kFrameCount, info);
+
+    // The silence is dithered by at most one LSB, the full scale is clamped instead of wrapping around.
+    bool isDithered = false;
+    for (uint32_t frameIndex = 0; frameIndex < kFrameCount; ++frameIndex)
+    {
+        ASSERT_LE(std::abs(device[frameIndex * kChannelCount]), 1);
+        ASSERT_GE(device[frameIndex * kChannelCount + 1], 32766);
+        isDithered |= device[frameIndex * kChannelCount] != 0;
+    }
+
+    EXPECT_TRUE(isDithered);
+}
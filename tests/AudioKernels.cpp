@@ -0,0 +1,395 @@
+﻿#include <Audio/Kernels/Kernels.hpp>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace quinte;
+
+namespace
+{
+    constexpr uint64_t kTestLengths[] = { 0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 100, 1023 };
+
+    // Misaligned by one sample to check the unaligned loads.
+    constexpr uint64_t kOffset = 1;
+
+
+    std::vector<float> MakeSignal(uint64_t length, uint32_t seed)
+    {
+        std::mt19937 generator{ seed };
+        std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+
+        std::vector<float> result(length + kOffset);
+        for (float& sample : result)
+            sample = distribution(generator);
+        return result;
+    }
+
+
+    std::vector<audio::KernelISA> GetSupportedISAs()
+    {
+        std::vector<audio::KernelISA> result;
+        const uint32_t maxISA = static_cast<uint32_t>(audio::DetectKernelISA());
+        for (uint32_t isa = static_cast<uint32_t>(audio::KernelISA::SSE2); isa <= maxISA; ++isa)
+            result.push_back(static_cast<audio::KernelISA>(isa));
+        return result;
+    }
+
+
+    void ExpectNear(const std::vector<float>& expected, const std::vector<float>& actual)
+    {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t sampleIndex = 0; sampleIndex < expected.size(); ++sampleIndex)
+            EXPECT_NEAR(expected[sampleIndex], actual[sampleIndex], 1e-5f) << "at " << sampleIndex;
+    }
+} // namespace
+
+
+TEST(AudioKernels, Mix)
+{
+    const audio::KernelTable& reference = audio::GetKernelTable(audio::KernelISA::Scalar);
+    for (audio::KernelISA isa : GetSupportedISAs())
+    {
+        const audio::KernelTable& kernels = audio::GetKernelTable(isa);
+        for (uint64_t length : kTestLengths)
+        {
+            const std::vector<float> source = MakeSignal(length, 1);
+            std::vector<float> expected = MakeSignal(length, 2);
+            std::vector<float> actual = expected;
+
+            reference.Mix(expected.data() + kOffset, source.data() + kOffset, length);
+            kernels.Mix(actual.data() + kOffset, source.data() + kOffset, length);
+            ExpectNear(expected, actual);
+
+            reference.MixWithGain(expected.data() + kOffset, source.data() + kOffset, 0.3f, length);
+            kernels.MixWithGain(actual.data() + kOffset, source.data() + kOffset, 0.3f, length);
+            ExpectNear(expected, actual);
+
+            reference.MixWithGainRamp(expected.data() + kOffset, source.data() + kOffset, 1.0f, -0.001f, length);
+            kernels.MixWithGainRamp(actual.data() + kOffset, source.data() + kOffset, 1.0f, -0.001f, length);
+            ExpectNear(expected, actual);
+        }
+    }
+}
+
+
+TEST(AudioKernels, Gain)
+{
+    const audio::KernelTable& reference = audio::GetKernelTable(audio::KernelISA::Scalar);
+    for (audio::KernelISA isa : GetSupportedISAs())
+    {
+        const audio::KernelTable& kernels = audio::GetKernelTable(isa);
+        for (uint64_t length : kTestLengths)
+        {
+            const std::vector<float> source = MakeSignal(length, 3);
+            std::vector<float> expected(source.size());
+            std::vector<float> actual(source.size());
+
+            reference.CopyWithGain(expected.data() + kOffset, source.data() + kOffset, 0.5f, length);
+            kernels.CopyWithGain(actual.data() + kOffset, source.data() + kOffset, 0.5f, length);
+            ExpectNear(expected, actual);
+
+            reference.ApplyGain(expected.data() + kOffset, 1.5f, length);
+            kernels.ApplyGain(actual.data() + kOffset, 1.5f, length);
+            ExpectNear(expected, actual);
+
+            reference.ApplyGainRamp(expected.data() + kOffset, 0.0f, 0.01f, length);
+            kernels.ApplyGainRamp(actual.data() + kOffset, 0.0f, 0.01f, length);
+            ExpectNear(expected, actual);
+        }
+    }
+}
+
+
+TEST(AudioKernels, PeakAndSumOfSquares)
+{
+    const audio::KernelTable& reference = audio::GetKernelTable(audio::KernelISA::Scalar);
+    for (audio::KernelISA isa : GetSupportedISAs())
+    {
+        const audio::KernelTable& kernels = audio::GetKernelTable(isa);
+        for (uint64_t length : kTestLengths)
+        {
+            std::vector<float> source = MakeSignal(length, 4);
+            if (length > 0)
+                source[kOffset + length - 1] = -2.0f;
+
+            const float expectedPeak = reference.Peak(source.data() + kOffset, length);
+            EXPECT_EQ(expectedPeak, length > 0 ? 2.0f : 0.0f);
+            EXPECT_EQ(kernels.Peak(source.data() + kOffset, length), expectedPeak);
+
+            const float expectedSum = reference.SumOfSquares(source.data() + kOffset, length);
+            EXPECT_NEAR(kernels.SumOfSquares(source.data() + kOffset, length), expectedSum, expectedSum * 1e-5f);
+        }
+    }
+}
+
+
+TEST(AudioKernels, MixAndMeasure)
+{
+    const audio::KernelTable& reference = audio::GetKernelTable(audio::KernelISA::Scalar);
+    for (audio::KernelISA isa : GetSupportedISAs())
+    {
+        const audio::KernelTable& kernels = audio::GetKernelTable(isa);
+        for (uint64_t length : kTestLengths)
+        {
+            const std::vector<float> source = MakeSignal(length, 8);
+            std::vector<float> expected = MakeSignal(length, 9);
+            std::vector<float> actual = expected;
+
+            reference.MixWithGainRamp(expected.data() + kOffset, source.data() + kOffset, 0.5f, 0.001f, length);
+            const audio::BlockLevels levels =
+                kernels.MixWithGainRampAndMeasure(actual.data() + kOffset, source.data() + kOffset, 0.5f, 0.001f, length);
+            ExpectNear(expected, actual);
+
+            const float expectedSum = reference.SumOfSquares(expected.data() + kOffset, length);
+            EXPECT_NEAR(levels.Peak, reference.Peak(expected.data() + kOffset, length), 1e-5f);
+            EXPECT_NEAR(levels.SumOfSquares, expectedSum, expectedSum * 1e-5f);
+        }
+    }
+}
+
+
+TEST(AudioKernels, MixMany)
+{
+    constexpr uint32_t kSourceCount = 5;
+    const float gains[kSourceCount] = { 1.0f, 0.5f, -0.25f, 0.0f, 2.0f };
+
+    const audio::KernelTable& reference = audio::GetKernelTable(audio::KernelISA::Scalar);
+    for (audio::KernelISA isa : GetSupportedISAs())
+    {
+        const audio::KernelTable& kernels = audio::GetKernelTable(isa);
+        for (uint64_t length : kTestLengths)
+        {
+            std::vector<float> sources[kSourceCount];
+            const float* pSources[kSourceCount];
+            for (uint32_t sourceIndex = 0; sourceIndex < kSourceCount; ++sourceIndex)
+            {
+                sources[sourceIndex] = MakeSignal(length, 10 + sourceIndex);
+                pSources[sourceIndex] = sources[sourceIndex].data() + kOffset;
+            }
+
+            std::vector<float> expected = MakeSignal(length, 5);
+            std::vector<float> actual = expected;
+
+            reference.MixMany(expected.data() + kOffset, pSources, gains, kSourceCount, length);
+            kernels.MixMany(actual.data() + kOffset, pSources, gains, kSourceCount, length);
+            ExpectNear(expected, actual);
+        }
+    }
+}
+
+
+TEST(AudioKernels, DoublePrecisionMix)
+{
+    constexpr uint32_t kSourceCount = 4;
+    const float gains[kSourceCount] = { 1.0f, 0.5f, -0.25f, 2.0f };
+
+    const audio::KernelTable& reference = audio::GetKernelTable(audio::KernelISA::Scalar);
+    for (audio::KernelISA isa : GetSupportedISAs())
+    {
+        const audio::KernelTable& kernels = audio::GetKernelTable(isa);
+        for (uint64_t length : kTestLengths)
+        {
+            std::vector<float> expected = MakeSignal(length, 20);
+            std::vector<float> actual = expected;
+            std::vector<double> expectedAccumulator(length);
+            std::vector<double> actualAccumulator(length);
+
+            reference.ConvertToDouble(expectedAccumulator.data(), expected.data() + kOffset, length);
+            kernels.ConvertToDouble(actualAccumulator.data(), actual.data() + kOffset, length);
+            for (uint32_t sourceIndex = 0; sourceIndex < kSourceCount; ++sourceIndex)
+            {
+                const std::vector<float> source = MakeSignal(length, 21 + sourceIndex);
+                reference.MixToDouble(expectedAccumulator.data(), source.data() + kOffset, gains[sourceIndex], length);
+                kernels.MixToDouble(actualAccumulator.data(), source.data() + kOffset, gains[sourceIndex], length);
+            }
+
+            reference.ConvertToFloat(expected.data() + kOffset, expectedAccumulator.data(), length);
+            kernels.ConvertToFloat(actual.data() + kOffset, actualAccumulator.data(), length);
+            ExpectNear(expected, actual);
+        }
+    }
+
+    // The small contributions that are lost when summing in single precision must survive in the accumulator.
+    constexpr uint32_t kSmallSourceCount = 64;
+    const float one = 1.0f;
+    const float small = 1e-8f;
+    for (audio::KernelISA isa : GetSupportedISAs())
+    {
+        const audio::KernelTable& kernels = audio::GetKernelTable(isa);
+
+        double accumulator;
+        float result;
+        kernels.ConvertToDouble(&accumulator, &one, 1);
+        for (uint32_t sourceIndex = 0; sourceIndex < kSmallSourceCount; ++sourceIndex)
+            kernels.MixToDouble(&accumulator, &small, 1.0f, 1);
+        kernels.ConvertToFloat(&result, &accumulator, 1);
+
+        EXPECT_GT(result, 1.0f);
+    }
+}
+
+
+TEST(AudioKernels, FormatConversion)
+{
+    const audio::KernelTable& reference = audio::GetKernelTable(audio::KernelISA::Scalar);
+
+    // Full scale is clamped, the ties are rounded to even.
+    const float edgeCases[] = { 1.0f, -1.0f, 1.5f, -1.5f, 0.5f / 32768.0f, 1.5f / 32768.0f, -2.5f / 32768.0f };
+    const int16_t expectedInt16[] = { 32767, -32768, 32767, -32768, 0, 2, -2 };
+    const int32_t expectedInt32[] = { 2147483520, -2147483647 - 1, 2147483520, -2147483647 - 1, 32768, 98304, -163840 };
+    for (audio::KernelISA isa : GetSupportedISAs())
+    {
+        const audio::KernelTable& kernels = audio::GetKernelTable(isa);
+
+        int16_t int16Result[std::size(edgeCases)];
+        int32_t int32Result[std::size(edgeCases)];
+        kernels.FloatToInt16(int16Result, edgeCases, std::size(edgeCases));
+        kernels.FloatToInt32(int32Result, edgeCases, 2147483648.0f, std::size(edgeCases));
+        for (uint32_t caseIndex = 0; caseIndex < std::size(edgeCases); ++caseIndex)
+        {
+            EXPECT_EQ(int16Result[caseIndex], expectedInt16[caseIndex]) << "case " << caseIndex;
+            EXPECT_EQ(int32Result[caseIndex], expectedInt32[caseIndex]) << "case " << caseIndex;
+        }
+
+        for (uint64_t length : kTestLengths)
+        {
+            std::vector<float> source = MakeSignal(length, 8);
+            for (float& sample : source)
+                sample *= 1.2f;
+
+            std::vector<int16_t> expected16(length), actual16(length);
+            reference.FloatToInt16(expected16.data(), source.data() + kOffset, length);
+            kernels.FloatToInt16(actual16.data(), source.data() + kOffset, length);
+            EXPECT_EQ(expected16, actual16);
+
+            std::vector<int32_t> expected24(length), actual24(length);
+            reference.FloatToInt32(expected24.data(), source.data() + kOffset, 8388608.0f, length);
+            kernels.FloatToInt32(actual24.data(), source.data() + kOffset, 8388608.0f, length);
+            EXPECT_EQ(expected24, actual24);
+
+            std::vector<float> expected(length), actual(length);
+            reference.Int16ToFloat(expected.data(), actual16.data(), length);
+            kernels.Int16ToFloat(actual.data(), actual16.data(), length);
+            ExpectNear(expected, actual);
+
+            reference.Int32ToFloat(expected.data(), actual24.data(), 8388608.0f, length);
+            kernels.Int32ToFloat(actual.data(), actual24.data(), 8388608.0f, length);
+            ExpectNear(expected, actual);
+            for (uint64_t sampleIndex = 0; sampleIndex < length; ++sampleIndex)
+            {
+                const float clamped = std::clamp(source[kOffset + sampleIndex], -1.0f, 1.0f);
+                EXPECT_NEAR(actual[sampleIndex], clamped, 1.0f / 8388608.0f);
+            }
+        }
+    }
+}
+
+
+TEST(AudioKernels, Interleave)
+{
+    for (audio::KernelISA isa : GetSupportedISAs())
+    {
+        const audio::KernelTable& kernels = audio::GetKernelTable(isa);
+        for (uint64_t length : kTestLengths)
+        {
+            const std::vector<float> first = MakeSignal(length, 9);
+            const std::vector<float> second = MakeSignal(length, 10);
+
+            std::vector<float> interleaved(2 * length);
+            kernels.Interleave2(interleaved.data(), first.data() + kOffset, second.data() + kOffset, length);
+            for (uint64_t frameIndex = 0; frameIndex < length; ++frameIndex)
+            {
+                EXPECT_EQ(interleaved[2 * frameIndex], first[kOffset + frameIndex]);
+                EXPECT_EQ(interleaved[2 * frameIndex + 1], second[kOffset + frameIndex]);
+            }
+
+            std::vector<float> firstResult(length + kOffset), secondResult(length + kOffset);
+            kernels.Deinterleave2(firstResult.data() + kOffset, secondResult.data() + kOffset, interleaved.data(), length);
+            for (uint64_t frameIndex = 0; frameIndex < length; ++frameIndex)
+            {
+                EXPECT_EQ(firstResult[kOffset + frameIndex], first[kOffset + frameIndex]);
+                EXPECT_EQ(secondResult[kOffset + frameIndex], second[kOffset + frameIndex]);
+            }
+        }
+    }
+}
+
+
+TEST(AudioKernels, TriangularNoise)
+{
+    constexpr uint64_t kLength = 4096;
+
+    const audio::KernelTable& reference = audio::GetKernelTable(audio::KernelISA::Scalar);
+    uint32_t referenceState[audio::kNoiseLaneCount];
+    for (uint32_t laneIndex = 0; laneIndex < audio::kNoiseLaneCount; ++laneIndex)
+        referenceState[laneIndex] = laneIndex * 7919 + 1;
+
+    std::vector<float> expected(kLength);
+    reference.TriangularNoise(expected.data(), referenceState, kLength);
+
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+    for (float sample : expected)
+    {
+        ASSERT_GT(sample, -1.0f);
+        ASSERT_LT(sample, 1.0f);
+        sum += sample;
+        sumOfSquares += sample * sample;
+    }
+
+    // The variance of the triangular distribution in (-1, 1) is 1/6.
+    EXPECT_NEAR(sum / kLength, 0.0, 0.02);
+    EXPECT_NEAR(sumOfSquares / kLength, 1.0 / 6.0, 0.01);
+
+    for (audio::KernelISA isa : GetSupportedISAs())
+    {
+        const audio::KernelTable& kernels = audio::GetKernelTable(isa);
+
+        uint32_t state[audio::kNoiseLaneCount];
+        for (uint32_t laneIndex = 0; laneIndex < audio::kNoiseLaneCount; ++laneIndex)
+            state[laneIndex] = laneIndex * 7919 + 1;
+
+        // The result must not depend on how the buffer is split.
+        std::vector<float> actual(kLength);
+        kernels.TriangularNoise(actual.data(), state, 256);
+        kernels.TriangularNoise(actual.data() + 256, state, kLength - 256);
+        EXPECT_EQ(expected, actual);
+        EXPECT_TRUE(std::equal(state, state + audio::kNoiseLaneCount, referenceState));
+    }
+}
+
+
+TEST(AudioKernels, FixedBlockLength)
+{
+    const audio::KernelTable& reference = audio::GetKernelTable(audio::KernelISA::Scalar);
+    for (audio::KernelISA isa : GetSupportedISAs())
+    {
+        EXPECT_EQ(audio::GetKernelTable(isa, 100).BlockLength, 0);
+
+        for (uint32_t blockLength : audio::kKernelBlockLengths)
+        {
+            const audio::KernelTable& kernels = audio::GetKernelTable(isa, blockLength);
+            EXPECT_EQ(kernels.BlockLength, blockLength);
+            EXPECT_EQ(kernels.ISA, isa);
+
+            // The specialized kernels must also handle the lengths they were not unrolled for.
+            for (uint64_t length : { uint64_t{ blockLength }, uint64_t{ blockLength - 1 }, uint64_t{ 17 } })
+            {
+                const std::vector<float> source = MakeSignal(length, 6);
+                std::vector<float> expected = MakeSignal(length, 7);
+                std::vector<float> actual = expected;
+
+                reference.MixWithGain(expected.data() + kOffset, source.data() + kOffset, 0.7f, length);
+                kernels.MixWithGain(actual.data() + kOffset, source.data() + kOffset, 0.7f, length);
+                ExpectNear(expected, actual);
+
+                reference.ApplyGainRamp(expected.data() + kOffset, 1.0f, -0.001f, length);
+                kernels.ApplyGainRamp(actual.data() + kOffset, 1.0f, -0.001f, length);
+                ExpectNear(expected, actual);
+
+                EXPECT_EQ(kernels.Peak(actual.data() + kOffset, length), reference.Peak(actual.data() + kOffset, length));
+            }
+        }
+    }
+}
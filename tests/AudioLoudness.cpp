@@ -0,0 +1,74 @@
+﻿#include <Audio/Loudness.hpp>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <numbers>
+#include <vector>
+
+using namespace quinte;
+
+namespace
+{
+    constexpr uint32_t kSampleRate = 48000;
+
+
+    // Feed a stereo 1 kHz sine to the meter in blocks of an odd size, so that the blocks don't line up with the sub-blocks.
+    void ProcessSine(audio::LoudnessMeter& meter, float amplitudeDBFS, double seconds)
+    {
+        constexpr uint64_t kBlockSize = 333;
+
+        const float amplitude = std::pow(10.0f, amplitudeDBFS / 20.0f);
+        const uint64_t sampleCount = static_cast<uint64_t>(seconds * kSampleRate);
+
+        std::vector<float> block(kBlockSize);
+        for (uint64_t offset = 0; offset < sampleCount; offset += kBlockSize)
+        {
+            const uint64_t length = Min(kBlockSize, sampleCount - offset);
+            for (uint64_t sampleIndex = 0; sampleIndex < length; ++sampleIndex)
+            {
+                const double time = static_cast<double>(offset + sampleIndex) / kSampleRate;
+                block[sampleIndex] = amplitude * static_cast<float>(std::sin(2.0 * std::numbers::pi * 1000.0 * time));
+            }
+
+            const float* channels[] = { block.data(), block.data() };
+            meter.Process(channels, length);
+        }
+    }
+} // namespace
+
+
+TEST(AudioLoudness, Sine)
+{
+    audio::LoudnessMeter meter;
+    meter.Initialize(kSampleRate);
+    EXPECT_EQ(meter.GetStats().Integrated, -std::numeric_limits<float>::infinity());
+
+    // EBU Tech 3341, test case 1: a stereo 1 kHz sine at -23 dBFS must measure -23 LUFS.
+    ProcessSine(meter, -23.0f, 20.0);
+
+    const audio::LoudnessStats stats = meter.GetStats();
+    EXPECT_NEAR(stats.Momentary, -23.0f, 0.1f);
+    EXPECT_NEAR(stats.ShortTerm, -23.0f, 0.1f);
+    EXPECT_NEAR(stats.Integrated, -23.0f, 0.1f);
+
+    meter.Reset();
+    EXPECT_EQ(meter.GetStats().Momentary, -std::numeric_limits<float>::infinity());
+}
+
+
+TEST(AudioLoudness, Gating)
+{
+    audio::LoudnessMeter meter;
+    meter.Initialize(kSampleRate);
+
+    // EBU Tech 3341, test case 3: the quiet parts are below the relative gate.
+    ProcessSine(meter, -36.0f, 10.0);
+    ProcessSine(meter, -23.0f, 60.0);
+    ProcessSine(meter, -36.0f, 10.0);
+    EXPECT_NEAR(meter.GetStats().Integrated, -23.0f, 0.1f);
+
+    // The silence is below the absolute gate and doesn't change the integrated loudness.
+    ProcessSine(meter, -100.0f, 20.0);
+    const audio::LoudnessStats stats = meter.GetStats();
+    EXPECT_NEAR(stats.Integrated, -23.0f, 0.1f);
+    EXPECT_LT(stats.ShortTerm, -70.0f);
+}
@@ -0,0 +1,69 @@
+﻿#include <Audio/Metering.hpp>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <numbers>
+#include <vector>
+
+using namespace quinte;
+
+namespace
+{
+    // A sine at a quarter of the sample rate, sampled 45 degrees off its peaks: every sample is at 0.707,
+    // while the actual peak of the signal is 1.
+    std::vector<float> MakeQuarterRateSine(uint64_t length)
+    {
+        std::vector<float> result(length);
+        for (uint64_t sampleIndex = 0; sampleIndex < length; ++sampleIndex)
+        {
+            const double phase = std::numbers::pi * (0.5 * static_cast<double>(sampleIndex) + 0.25);
+            result[sampleIndex] = static_cast<float>(std::sin(phase));
+        }
+
+        return result;
+    }
+} // namespace
+
+
+TEST(AudioMetering, TruePeak)
+{
+    const std::vector<float> signal = MakeQuarterRateSine(1000);
+
+    audio::TruePeakDetector detector;
+    const float firstPeak = detector.Process(signal.data(), 500);
+    const float secondPeak = detector.Process(signal.data() + 500, 500);
+
+    EXPECT_GT(Max(firstPeak, secondPeak), 0.95f);
+    EXPECT_NEAR(secondPeak, 1.0f, 0.05f);
+
+    // The blocks must be continued seamlessly, so splitting the signal doesn't change the result.
+    audio::TruePeakDetector splitDetector;
+    float splitPeak = 0.0f;
+    for (uint64_t offset = 0; offset < 1000; offset += 7)
+        splitPeak = Max(splitPeak, splitDetector.Process(signal.data() + offset, Min<uint64_t>(7, 1000 - offset)));
+
+    EXPECT_NEAR(splitPeak, Max(firstPeak, secondPeak), 1e-6f);
+}
+
+
+TEST(AudioMetering, Accumulator)
+{
+    audio::MeterAccumulator accumulator;
+    accumulator.Add(0, { .Peak = 0.5f, .SumOfSquares = 256.0f });
+    accumulator.Add(1, { .Peak = 0.25f, .SumOfSquares = 64.0f });
+    EXPECT_FALSE(accumulator.Advance(audio::kMeterWindowSampleCount / 2));
+
+    accumulator.Add(0, { .Peak = 0.75f, .SumOfSquares = 0.0f });
+    accumulator.Add(1, { .Peak = 0.0f, .SumOfSquares = 0.0f });
+    EXPECT_TRUE(accumulator.Advance(audio::kMeterWindowSampleCount / 2));
+
+    const audio::TrackMeter meter = accumulator.GetMeter();
+    ASSERT_EQ(meter.ChannelCount, 2u);
+    EXPECT_EQ(meter.Channels[0].Peak, 0.75f);
+    EXPECT_EQ(meter.Channels[1].Peak, 0.25f);
+    EXPECT_FLOAT_EQ(meter.Channels[0].RMS, 0.5f);
+    EXPECT_FLOAT_EQ(meter.Channels[1].RMS, 0.25f);
+    EXPECT_EQ(meter.GetPeak(), 0.75f);
+
+    accumulator.Reset();
+    EXPECT_EQ(accumulator.GetMeter().ChannelCount, 0u);
+}
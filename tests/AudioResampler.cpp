@@ -0,0 +1,165 @@
+﻿#include <Audio/Buffers/AudioBufferView.hpp>
+#include <Audio/Buffers/MultichannelAudioBuffer.hpp>
+#include <Audio/Resampler.hpp>
+#include <Audio/Sources/BufferAudioSource.hpp>
+#include <Audio/Sources/ResampledAudioSource.hpp>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <numbers>
+#include <vector>
+
+using namespace quinte;
+
+namespace
+{
+    float GenerateSine(double frequency, uint32_t sampleRate, uint64_t sampleIndex)
+    {
+        const double time = static_cast<double>(sampleIndex) / sampleRate;
+        return 0.5f * static_cast<float>(std::sin(2.0 * std::numbers::pi * frequency * time));
+    }
+
+
+    // Convert a 1 kHz sine in blocks of an odd size and compare it to the same sine generated at the output rate.
+    float MeasureSineError(uint32_t inSampleRate, uint32_t outSampleRate, audio::ResamplerQuality quality)
+    {
+        constexpr uint32_t kBlockSize = 333;
+        constexpr uint64_t kInputLength = 20000;
+
+        const Rc<audio::ResamplerFilter> pFilter = Rc<audio::ResamplerFilter>::DefaultNew(inSampleRate, outSampleRate, quality);
+        audio::Resampler resampler;
+        resampler.Initialize(pFilter.Get(), 1, kBlockSize);
+
+        std::vector<float> input(kBlockSize);
+        std::vector<float> output;
+        for (uint64_t offset = 0; offset < kInputLength; offset += kBlockSize)
+        {
+            for (uint32_t sampleIndex = 0; sampleIndex < kBlockSize; ++sampleIndex)
+                input[sampleIndex] = GenerateSine(1000.0, inSampleRate, offset + sampleIndex);
+
+            const size_t outputOffset = output.size();
+            output.resize(outputOffset + resampler.GetFilter()->GetInterpolationFactor() * kBlockSize);
+
+            const float* pInput = input.data();
+            float* pOutput = output.data() + outputOffset;
+            const uint32_t outputCount = resampler.Process(std::span{ &pInput, 1 }, kBlockSize, std::span{ &pOutput, 1 }, ~0u);
+            output.resize(outputOffset + outputCount);
+        }
+
+        // The first outputs are affected by the silence before the stream.
+        float maxError = 0.0f;
+        for (uint64_t sampleIndex = 200; sampleIndex < output.size(); ++sampleIndex)
+        {
+            const float error = std::abs(output[sampleIndex] - GenerateSine(1000.0, outSampleRate, sampleIndex));
+            maxError = Max(maxError, error);
+        }
+
+        return maxError;
+    }
+} // namespace
+
+
+TEST(AudioResampler, Sine)
+{
+    EXPECT_LT(MeasureSineError(44100, 48000, audio::ResamplerQuality::Draft), 1e-3f);
+    EXPECT_LT(MeasureSineError(44100, 48000, audio::ResamplerQuality::Best), 1e-5f);
+    EXPECT_LT(MeasureSineError(48000, 44100, audio::ResamplerQuality::Best), 1e-5f);
+
+    // 11025 to 96000 needs more phases than the table has, the outputs are interpolated between them.
+    EXPECT_LT(MeasureSineError(11025, 96000, audio::ResamplerQuality::Best), 1e-4f);
+}
+
+
+TEST(AudioResampler, SourceRandomAccess)
+{
+    constexpr uint64_t kSourceLength = 4410;
+    constexpr uint64_t kLength = 4800;
+
+    const Rc pBuffer = Rc<MultichannelAudioBuffer>::DefaultNew(2u, kSourceLength);
+    for (uint64_t sampleIndex = 0; sampleIndex < kSourceLength; ++sampleIndex)
+    {
+        pBuffer->GetChannelData(0)[sampleIndex] = GenerateSine(440.0, 44100, sampleIndex);
+        pBuffer->GetChannelData(1)[sampleIndex] = GenerateSine(880.0, 44100, sampleIndex);
+    }
+
+    const Rc<AudioSource> pSource = Rc<ResampledAudioSource>::DefaultNew(
+        Rc<BufferAudioSource>::DefaultNew(pBuffer.Get()), 44100u, 48000u, audio::ResamplerQuality::Best);
+    ASSERT_EQ(pSource->GetLength(), kLength);
+
+    std::vector<float> whole(kLength);
+    std::vector<float> chunked(kLength);
+    AudioBufferView wholeView{ whole.data(), kLength };
+    AudioBufferView chunkedView{ chunked.data(), kLength };
+
+    for (uint32_t channelIndex = 0; channelIndex < 2; ++channelIndex)
+    {
+        ASSERT_EQ(pSource->Read(&wholeView, 0, 0, kLength, channelIndex), kLength);
+
+        // Read the channel backwards in chunks of an odd size, every read has to seek.
+        constexpr uint64_t kChunkSize = 777;
+        for (uint64_t end = kLength; end > 0;)
+        {
+            const uint64_t begin = end > kChunkSize ? end - kChunkSize : 0;
+            ASSERT_EQ(pSource->Read(&chunkedView, begin, begin, end - begin, channelIndex), end - begin);
+            end = begin;
+        }
+
+        for (uint64_t sampleIndex = 0; sampleIndex < kLength; ++sampleIndex)
+            ASSERT_NEAR(whole[sampleIndex], chunked[sampleIndex], 1e-6f) << sampleIndex;
+    }
+}
+
+
+TEST(AudioResampler, DeviceCallbacks)
+{
+    // Mirrors the capture loop of the WASAPI backend: the device runs at 44.1 kHz and the engine at 48 kHz,
+    // 448 frames is not a multiple of the ratio, so the input needed by every callback varies.
+    constexpr uint32_t kChannelCount = 2;
+    constexpr uint32_t kInSampleRate = 44100;
+    constexpr uint32_t kOutSampleRate = 48000;
+    constexpr uint32_t kBufferFrameCount = 448;
+    constexpr uint32_t kCallbackCount = 2000;
+    constexpr uint32_t kMaxPullCount = (kBufferFrameCount * kInSampleRate + kOutSampleRate - 1) / kOutSampleRate;
+
+    const Rc<audio::ResamplerFilter> pFilter =
+        Rc<audio::ResamplerFilter>::DefaultNew(kInSampleRate, kOutSampleRate, audio::ResamplerQuality::Draft);
+    audio::Resampler resampler;
+    resampler.Initialize(pFilter.Get(), kChannelCount, kMaxPullCount);
+
+    std::vector<float> input(kMaxPullCount * kChannelCount);
+    std::vector<float> output(kBufferFrameCount * kChannelCount);
+    uint64_t pulledFrameCount = 0;
+    uint64_t producedFrameCount = 0;
+    for (uint32_t callbackIndex = 0; callbackIndex < kCallbackCount; ++callbackIndex)
+    {
+        uint32_t frameCount = 0;
+        while (frameCount < kBufferFrameCount)
+        {
+            const uint32_t remainingFrameCount = kBufferFrameCount - frameCount;
+            const uint32_t pullCount = Min(resampler.GetRequiredInputCount(remainingFrameCount), kMaxPullCount);
+            for (uint32_t sampleIndex = 0; sampleIndex < pullCount; ++sampleIndex)
+            {
+                const float value = GenerateSine(1000.0, kInSampleRate, pulledFrameCount + sampleIndex);
+                input[sampleIndex * kChannelCount] = value;
+                input[sampleIndex * kChannelCount + 1] = -value;
+            }
+
+            pulledFrameCount += pullCount;
+            frameCount += resampler.ProcessInterleaved(
+                input.data(), pullCount, output.data() + frameCount * kChannelCount, remainingFrameCount);
+        }
+
+        ASSERT_EQ(frameCount, kBufferFrameCount);
+        producedFrameCount += frameCount;
+
+        // The input is consumed at the rate ratio, only the filter history is kept between the callbacks.
+        const uint64_t expectedPulledFrameCount = producedFrameCount * kInSampleRate / kOutSampleRate;
+        ASSERT_LE(pulledFrameCount, expectedPulledFrameCount + pFilter->GetTapCount());
+
+        for (uint32_t frameIndex = 0; frameIndex < kBufferFrameCount && callbackIndex > 0; ++frameIndex)
+        {
+            const uint64_t outputIndex = producedFrameCount - kBufferFrameCount + frameIndex;
+            ASSERT_NEAR(output[frameIndex * kChannelCount], GenerateSine(1000.0, kOutSampleRate, outputIndex), 1e-3f);
+            ASSERT_EQ(output[frameIndex * kChannelCount + 1], -output[frameIndex * kChannelCount]);
+        }
+    }
+}
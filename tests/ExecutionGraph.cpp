@@ -0,0 +1,446 @@
+﻿#include <Audio/Backend/Offline.hpp>
+#include <Audio/Buffers/MultichannelAudioBuffer.hpp>
+#include <Audio/Engine.hpp>
+#include <Audio/Ports/PortManager.hpp>
+#include <Audio/Session.hpp>
+#include <Audio/Sources/BufferAudioSource.hpp>
+#include <Audio/Transport.hpp>
+#include <Graph/ExecutionGraph.hpp>
+#include <Graph/GraphWorkerPool.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace quinte;
+
+namespace
+{
+    class ExecutionGraphTest : public ::testing::Test
+    {
+    protected:
+        inline static constexpr uint32_t kBufferSize = 128;
+
+        AudioEngine m_Engine;
+        Transport m_Transport;
+        Session m_Session;
+        GraphWorkerPool m_WorkerPool{ 0 };
+        memory::unique_ptr<ExecutionGraph> m_pGraph;
+
+        void SetUp() override
+        {
+            ASSERT_EQ(m_Engine.InitializeAPI(audio::APIKind::Offline), audio::ResultCode::Success);
+            IAudioAPI* pAPI = m_Engine.GetAPI();
+            ASSERT_EQ(m_Engine.Start({ pAPI->GetDefautInputDevice(), pAPI->GetDefaultOutputDevice(), kBufferSize }),
+                      audio::ResultCode::Success);
+
+            m_pGraph = memory::make_unique<ExecutionGraph>();
+        }
+
+        void TearDown() override
+        {
+            // The nodes hold references to the tracks, they must be released before the session is cleared.
+            m_pGraph.reset();
+            m_Engine.Stop();
+        }
+
+        [[nodiscard]] const ExecutionGraphNode* FindMasterNode() const
+        {
+            for (const ExecutionGraphNode* pNode : m_pGraph->GetSortedNodes())
+            {
+                if (pNode->Track->IsMaster())
+                    return pNode;
+            }
+
+            return nullptr;
+        }
+
+        [[nodiscard]] std::vector<ExecutionGraphStepKind> GetStepKinds(const ExecutionGraphNode* pNode) const
+        {
+            std::vector<ExecutionGraphStepKind> result;
+            for (const ExecutionGraphStep& step : m_pGraph->GetNodeSteps(pNode))
+                result.push_back(step.Kind);
+
+            return result;
+        }
+
+        //! \brief The transport state is only changed by the audio callback, so a cycle of the engine is run to apply it.
+        void SetRolling(bool rolling)
+        {
+            if (rolling)
+                m_Transport.RequestRoll();
+            else
+                m_Transport.RequestPause();
+
+            static_cast<AudioBackendOffline*>(m_Engine.GetAPI())->ProcessCycle(kBufferSize);
+            ASSERT_EQ(m_Transport.IsActuallyRolling(), rolling);
+        }
+
+        void RunCycle(uint64_t position)
+        {
+            m_pGraph->Run({ audio::TimePos64{ position }, { 0, kBufferSize } }, &m_WorkerPool);
+        }
+    };
+
+
+    //! \brief Create a clip with a ramp in both channels, the samples are numbered from one.
+    AudioClip CreateRampClip(uint64_t position, uint64_t length)
+    {
+        MultichannelAudioBuffer* pRamp = Rc<MultichannelAudioBuffer>::DefaultNew(2u, length);
+        for (uint32_t channelIndex = 0; channelIndex < 2; ++channelIndex)
+        {
+            float* pData = pRamp->GetChannelData(channelIndex);
+            for (uint64_t sampleIndex = 0; sampleIndex < length; ++sampleIndex)
+                pData[sampleIndex] = static_cast<float>(sampleIndex + 1);
+        }
+
+        return AudioClip{ Rc<BufferAudioSource>::DefaultNew(pRamp), position };
+    }
+
+
+    AudioBufferView* GetBuffer(const Rc<Port>& pPort)
+    {
+        return static_cast<AudioPort*>(pPort.Get())->GetBufferView();
+    }
+
+
+    //! \brief Find the delay step that feeds the source to the node, null if the source is not delayed.
+    const ExecutionGraphStep* FindDelayStep(std::span<const ExecutionGraphStep> steps, const AudioBufferView* pSource)
+    {
+        for (const ExecutionGraphStep& step : steps)
+        {
+            if (step.Kind == ExecutionGraphStepKind::Delay && step.pSource == pSource)
+                return &step;
+        }
+
+        return nullptr;
+    }
+
+
+    bool IsNodeBuffer(const ExecutionGraphNode* pNode, const AudioBufferView* pBuffer)
+    {
+        for (const auto ports : { pNode->Track->GetInputPorts(), pNode->Track->GetOutputPorts() })
+        {
+            for (const Rc<Port>& pPort : ports)
+            {
+                if (GetBuffer(pPort) == pBuffer)
+                    return true;
+            }
+        }
+
+        return false;
+    }
+} // namespace
+
+
+TEST_F(ExecutionGraphTest, StepsAreContiguous)
+{
+    Track* pBus = m_Session.CreateBus();
+    ASSERT_EQ(m_Session.ConnectTracks(m_Session.CreateTrack(), pBus, true), audio::ResultCode::Success);
+    ASSERT_EQ(m_pGraph->Build(m_WorkerPool.GetWorkerCount()), audio::ResultCode::Success);
+
+    // Every node owns its own range of the flat step list, and only writes to its own ports.
+    const std::span<const ExecutionGraphNode* const> nodes = m_pGraph->GetSortedNodes();
+    ASSERT_EQ(nodes.size(), m_Session.GetTrackList().size() + 1);
+
+    std::vector<std::pair<uint32_t, uint32_t>> stepRanges;
+    for (const ExecutionGraphNode* pNode : nodes)
+    {
+        EXPECT_GT(pNode->StepCount, 0u);
+        stepRanges.emplace_back(pNode->FirstStepIndex, pNode->FirstStepIndex + pNode->StepCount);
+
+        for (const ExecutionGraphStep& step : m_pGraph->GetNodeSteps(pNode))
+            EXPECT_TRUE(IsNodeBuffer(pNode, step.pDestination));
+    }
+
+    std::sort(stepRanges.begin(), stepRanges.end());
+    for (size_t rangeIndex = 1; rangeIndex < stepRanges.size(); ++rangeIndex)
+        EXPECT_EQ(stepRanges[rangeIndex - 1].second, stepRanges[rangeIndex].first);
+}
+
+
+TEST_F(ExecutionGraphTest, SortedNodes)
+{
+    Track* pTrack = m_Session.CreateTrack();
+    Track* pBus = m_Session.CreateBus();
+    ASSERT_EQ(m_Session.ConnectTracks(pTrack, pBus, true), audio::ResultCode::Success);
+    ASSERT_EQ(m_pGraph->Build(m_WorkerPool.GetWorkerCount()), audio::ResultCode::Success);
+
+    // The sources are processed before the nodes that mix them.
+    const std::span<const ExecutionGraphNode* const> nodes = m_pGraph->GetSortedNodes();
+    const auto findIndex = [&](const Track* pTrack) {
+        return std::find(nodes.begin(), nodes.end(), m_pGraph->FindNode(pTrack)) - nodes.begin();
+    };
+
+    EXPECT_LT(findIndex(pTrack), findIndex(pBus));
+    EXPECT_LT(findIndex(pBus), findIndex(FindMasterNode()->Track.Get()));
+    EXPECT_EQ(nodes.back(), FindMasterNode());
+}
+
+
+TEST_F(ExecutionGraphTest, TrackSteps)
+{
+    Track* pTrack = m_Session.CreateTrack();
+    ASSERT_EQ(m_pGraph->Build(m_WorkerPool.GetWorkerCount()), audio::ResultCode::Success);
+
+    // Only the first input is connected to the hardware, it's only mixed when the track is record armed.
+    const ExecutionGraphNode* pNode = m_pGraph->FindNode(pTrack);
+    ASSERT_NE(pNode, nullptr);
+
+    const std::vector<ExecutionGraphStepKind> expectedKinds = {
+        ExecutionGraphStepKind::Clear,       ExecutionGraphStepKind::ReadClips, ExecutionGraphStepKind::Mix,
+        ExecutionGraphStepKind::Clear,       ExecutionGraphStepKind::ReadClips, ExecutionGraphStepKind::Clear,
+        ExecutionGraphStepKind::MixWithGain, ExecutionGraphStepKind::Clear,     ExecutionGraphStepKind::MixWithGain,
+    };
+    ASSERT_EQ(GetStepKinds(pNode), expectedKinds);
+
+    const std::span<const ExecutionGraphStep> steps = m_pGraph->GetNodeSteps(pNode);
+    const AudioBufferView* pLeftInput = GetBuffer(pTrack->GetInputPorts()[0]);
+    const AudioBufferView* pRightInput = GetBuffer(pTrack->GetInputPorts()[1]);
+    EXPECT_EQ(steps[0].pDestination, pLeftInput);
+    EXPECT_EQ(steps[1].pDestination, pLeftInput);
+    EXPECT_EQ(steps[2].pDestination, pLeftInput);
+    EXPECT_EQ(steps[2].Flags, ExecutionGraphStepFlags::RecordingOnly);
+    EXPECT_EQ(steps[3].pDestination, pRightInput);
+    EXPECT_EQ(steps[4].pDestination, pRightInput);
+
+    // The fader writes every output channel from the matching input channel.
+    for (uint32_t channelIndex = 0; channelIndex < 2; ++channelIndex)
+    {
+        const AudioBufferView* pOutput = GetBuffer(pTrack->GetOutputPorts()[channelIndex]);
+        EXPECT_EQ(steps[5 + channelIndex * 2].pDestination, pOutput);
+        EXPECT_EQ(steps[6 + channelIndex * 2].pDestination, pOutput);
+        EXPECT_EQ(steps[6 + channelIndex * 2].pSource, channelIndex == 0 ? pLeftInput : pRightInput);
+    }
+}
+
+
+TEST_F(ExecutionGraphTest, BusMixesInSinglePass)
+{
+    Track* pTrack1 = m_Session.CreateTrack();
+    Track* pTrack2 = m_Session.CreateTrack();
+    Track* pBus = m_Session.CreateBus();
+    ASSERT_EQ(m_Session.ConnectTracks(pTrack1, pBus, true), audio::ResultCode::Success);
+    ASSERT_EQ(m_Session.ConnectTracks(pTrack2, pBus, true), audio::ResultCode::Success);
+    ASSERT_EQ(m_pGraph->Build(m_WorkerPool.GetWorkerCount()), audio::ResultCode::Success);
+
+    const ExecutionGraphNode* pNode = m_pGraph->FindNode(pBus);
+    ASSERT_NE(pNode, nullptr);
+
+    const std::vector<ExecutionGraphStepKind> expectedKinds = {
+        ExecutionGraphStepKind::Clear,       ExecutionGraphStepKind::ReadClips, ExecutionGraphStepKind::MixMany,
+        ExecutionGraphStepKind::Clear,       ExecutionGraphStepKind::ReadClips, ExecutionGraphStepKind::MixMany,
+        ExecutionGraphStepKind::Clear,       ExecutionGraphStepKind::MixWithGain, ExecutionGraphStepKind::Clear,
+        ExecutionGraphStepKind::MixWithGain,
+    };
+    ASSERT_EQ(GetStepKinds(pNode), expectedKinds);
+
+    // Each channel of the bus sums the same channel of both tracks.
+    const std::span<const ExecutionGraphStep> steps = m_pGraph->GetNodeSteps(pNode);
+    for (uint32_t channelIndex = 0; channelIndex < 2; ++channelIndex)
+    {
+        const ExecutionGraphStep& mixStep = steps[channelIndex * 3 + 2];
+        EXPECT_EQ(mixStep.pDestination, GetBuffer(pBus->GetInputPorts()[channelIndex]));
+
+        const std::span<const AudioBufferView* const> sources = m_pGraph->GetMixSources(mixStep);
+        ASSERT_EQ(sources.size(), 2u);
+        EXPECT_NE(std::find(sources.begin(), sources.end(), GetBuffer(pTrack1->GetOutputPorts()[channelIndex])), sources.end());
+        EXPECT_NE(std::find(sources.begin(), sources.end(), GetBuffer(pTrack2->GetOutputPorts()[channelIndex])), sources.end());
+    }
+}
+
+
+TEST_F(ExecutionGraphTest, SilentNodesAreSkipped)
+{
+    Track* pTrack = m_Session.CreateTrack();
+    pTrack->InsertClip(CreateRampClip(0, 4 * kBufferSize));
+    ASSERT_EQ(m_pGraph->Build(m_WorkerPool.GetWorkerCount()), audio::ResultCode::Success);
+
+    // The clips are only read while rolling, so every node is silent and skipped from the first cycle.
+    RunCycle(0);
+    for (const ExecutionGraphNode* pNode : m_pGraph->GetSortedNodes())
+    {
+        EXPECT_EQ(pNode->SilentSampleCount, 0u);
+        for (const auto ports : { pNode->Track->GetInputPorts(), pNode->Track->GetOutputPorts() })
+        {
+            for (const Rc<Port>& pPort : ports)
+                EXPECT_TRUE(GetBuffer(pPort)->IsSilent());
+        }
+    }
+
+    // Once rolling the track reads its clip and the master mixes it.
+    SetRolling(true);
+    RunCycle(0);
+    for (const Rc<Port>& pPort : pTrack->GetOutputPorts())
+        EXPECT_FALSE(GetBuffer(pPort)->IsSilent());
+    for (const Rc<Port>& pPort : FindMasterNode()->Track->GetOutputPorts())
+        EXPECT_FALSE(GetBuffer(pPort)->IsSilent());
+
+    // Past the end of the clip the outputs become silent again.
+    RunCycle(8 * kBufferSize);
+    for (const Rc<Port>& pPort : pTrack->GetOutputPorts())
+        EXPECT_TRUE(GetBuffer(pPort)->IsSilent());
+    for (const Rc<Port>& pPort : FindMasterNode()->Track->GetOutputPorts())
+        EXPECT_TRUE(GetBuffer(pPort)->IsSilent());
+}
+
+
+TEST_F(ExecutionGraphTest, SilentNodeTail)
+{
+    constexpr uint32_t kLatency = 200;
+
+    Track* pTrack = m_Session.CreateTrack();
+    pTrack->InsertClip(CreateRampClip(0, kBufferSize));
+    pTrack->SetLatency(kLatency);
+    ASSERT_EQ(m_pGraph->Build(m_WorkerPool.GetWorkerCount()), audio::ResultCode::Success);
+
+    const ExecutionGraphNode* pNode = m_pGraph->FindNode(pTrack);
+    ASSERT_NE(pNode, nullptr);
+    EXPECT_EQ(pNode->TailSampleCount, kLatency);
+
+    SetRolling(true);
+    RunCycle(0);
+    EXPECT_EQ(pNode->SilentSampleCount, 0u);
+
+    // The node keeps running until its inputs have been silent for longer than its tail, then it's skipped.
+    RunCycle(kBufferSize);
+    EXPECT_EQ(pNode->SilentSampleCount, kBufferSize);
+    RunCycle(2 * kBufferSize);
+    EXPECT_EQ(pNode->SilentSampleCount, 2 * kBufferSize);
+    RunCycle(3 * kBufferSize);
+    EXPECT_EQ(pNode->SilentSampleCount, 2 * kBufferSize);
+
+    // Any audible input restarts the count.
+    RunCycle(0);
+    EXPECT_EQ(pNode->SilentSampleCount, 0u);
+}
+
+
+TEST_F(ExecutionGraphTest, PartiallySilentBus)
+{
+    Track* pAudibleTrack = m_Session.CreateTrack();
+    Track* pSilentTrack = m_Session.CreateTrack();
+    Track* pBus = m_Session.CreateBus();
+    pAudibleTrack->InsertClip(CreateRampClip(0, 4 * kBufferSize));
+    ASSERT_EQ(m_Session.ConnectTracks(pAudibleTrack, pBus, true), audio::ResultCode::Success);
+    ASSERT_EQ(m_Session.ConnectTracks(pSilentTrack, pBus, true), audio::ResultCode::Success);
+
+    // Only the left channel of the audible track reaches the bus.
+    Interface<PortManager>::Get()->DisconnectPorts(pAudibleTrack->GetOutputPorts()[1].Get(), pBus->GetInputPorts()[1].Get());
+    ASSERT_EQ(m_pGraph->Build(m_WorkerPool.GetWorkerCount()), audio::ResultCode::Success);
+
+    SetRolling(true);
+    RunCycle(0);
+
+    for (const Rc<Port>& pPort : pAudibleTrack->GetOutputPorts())
+        EXPECT_FALSE(GetBuffer(pPort)->IsSilent());
+    for (const Rc<Port>& pPort : pSilentTrack->GetOutputPorts())
+        EXPECT_TRUE(GetBuffer(pPort)->IsSilent());
+
+    // The bus runs since one of its inputs is audible, but the silence of the other channel is kept down to the master.
+    EXPECT_FALSE(GetBuffer(pBus->GetInputPorts()[0])->IsSilent());
+    EXPECT_FALSE(GetBuffer(pBus->GetOutputPorts()[0])->IsSilent());
+    EXPECT_TRUE(GetBuffer(pBus->GetInputPorts()[1])->IsSilent());
+    EXPECT_TRUE(GetBuffer(pBus->GetOutputPorts()[1])->IsSilent());
+
+    const Track* pMaster = FindMasterNode()->Track.Get();
+    EXPECT_FALSE(GetBuffer(pMaster->GetOutputPorts()[0])->IsSilent());
+    EXPECT_TRUE(GetBuffer(pMaster->GetOutputPorts()[1])->IsSilent());
+}
+
+
+TEST_F(ExecutionGraphTest, LatencyIsMaxAcrossBranches)
+{
+    Track* pTrack = m_Session.CreateTrack();
+    Track* pLatentTrack = m_Session.CreateTrack();
+    Track* pMoreLatentTrack = m_Session.CreateTrack();
+    Track* pBus = m_Session.CreateBus();
+    pLatentTrack->SetLatency(100);
+    pMoreLatentTrack->SetLatency(256);
+    pBus->SetLatency(50);
+    ASSERT_EQ(m_Session.ConnectTracks(pTrack, pBus, true), audio::ResultCode::Success);
+    ASSERT_EQ(m_Session.ConnectTracks(pLatentTrack, pBus, true), audio::ResultCode::Success);
+    ASSERT_EQ(m_pGraph->Build(m_WorkerPool.GetWorkerCount()), audio::ResultCode::Success);
+
+    // The bus waits for the latent track, then the master waits for the track with the most latency.
+    const ExecutionGraphNode* pBusNode = m_pGraph->FindNode(pBus);
+    const ExecutionGraphNode* pMasterNode = FindMasterNode();
+    EXPECT_EQ(pBusNode->InputLatencySampleCount, 100u);
+    EXPECT_EQ(pBusNode->GetOutputLatency(), 150u);
+    EXPECT_EQ(pMasterNode->InputLatencySampleCount, 256u);
+    EXPECT_EQ(m_pGraph->GetTrackOutputLatency(pMoreLatentTrack), 256u);
+    EXPECT_EQ(m_pGraph->GetOutputLatency(), 256u);
+
+    // Only the inputs that arrive early are delayed, by the difference with the longest path.
+    const std::span<const ExecutionGraphStep> busSteps = m_pGraph->GetNodeSteps(pBusNode);
+    const std::span<const ExecutionGraphStep> masterSteps = m_pGraph->GetNodeSteps(pMasterNode);
+    for (uint32_t channelIndex = 0; channelIndex < 2; ++channelIndex)
+    {
+        const ExecutionGraphStep* pTrackDelay = FindDelayStep(busSteps, GetBuffer(pTrack->GetOutputPorts()[channelIndex]));
+        ASSERT_NE(pTrackDelay, nullptr);
+        EXPECT_EQ(pTrackDelay->pDelayLine->GetDelaySampleCount(), 100u);
+        EXPECT_EQ(FindDelayStep(busSteps, GetBuffer(pLatentTrack->GetOutputPorts()[channelIndex])), nullptr);
+
+        const ExecutionGraphStep* pBusDelay = FindDelayStep(masterSteps, GetBuffer(pBus->GetOutputPorts()[channelIndex]));
+        ASSERT_NE(pBusDelay, nullptr);
+        EXPECT_EQ(pBusDelay->pDelayLine->GetDelaySampleCount(), 106u);
+        EXPECT_EQ(FindDelayStep(masterSteps, GetBuffer(pMoreLatentTrack->GetOutputPorts()[channelIndex])), nullptr);
+    }
+}
+
+
+TEST_F(ExecutionGraphTest, DelayedBranchSampleOffsets)
+{
+    constexpr uint32_t kLatency = 256;
+    constexpr uint64_t kClipLength = 4 * kBufferSize;
+
+    Track* pTrack = m_Session.CreateTrack();
+    pTrack->InsertClip(CreateRampClip(0, kClipLength));
+    Track* pLatentTrack = m_Session.CreateTrack();
+    pLatentTrack->SetLatency(kLatency);
+    ASSERT_EQ(m_pGraph->Build(m_WorkerPool.GetWorkerCount()), audio::ResultCode::Success);
+
+    SetRolling(true);
+
+    // The latent track is silent, the master output is the ramp delayed by the latency of the longest path.
+    const Track* pMaster = FindMasterNode()->Track.Get();
+    for (uint64_t position = 0; position < kClipLength + 2 * kLatency; position += kBufferSize)
+    {
+        RunCycle(position);
+        for (uint32_t channelIndex = 0; channelIndex < 2; ++channelIndex)
+        {
+            const AudioBufferView* pOutput = GetBuffer(pMaster->GetOutputPorts()[channelIndex]);
+            for (uint32_t sampleIndex = 0; sampleIndex < kBufferSize; ++sampleIndex)
+            {
+                const uint64_t timelinePosition = position + sampleIndex;
+                const bool insideClip = timelinePosition >= kLatency && timelinePosition < kLatency + kClipLength;
+                const float expected = insideClip ? static_cast<float>(timelinePosition - kLatency + 1) : 0.0f;
+                ASSERT_NEAR(pOutput->Data()[sampleIndex], expected, 1e-3f) << timelinePosition;
+            }
+        }
+    }
+}
+
+
+TEST_F(ExecutionGraphTest, DelayLinesResetOnRebuild)
+{
+    Track* pTrack = m_Session.CreateTrack();
+    pTrack->InsertClip(CreateRampClip(0, 4 * kBufferSize));
+    Track* pLatentTrack = m_Session.CreateTrack();
+    pLatentTrack->SetLatency(2 * kBufferSize);
+    ASSERT_EQ(m_pGraph->Build(m_WorkerPool.GetWorkerCount()), audio::ResultCode::Success);
+
+    SetRolling(true);
+    RunCycle(0);
+    RunCycle(kBufferSize);
+
+    // The delay lines still hold the samples read before the transport stopped.
+    const Track* pMaster = FindMasterNode()->Track.Get();
+    SetRolling(false);
+    RunCycle(2 * kBufferSize);
+    EXPECT_FALSE(GetBuffer(pMaster->GetOutputPorts()[0])->IsSilent());
+
+    // A rebuild must not replay the old samples through the new delay lines.
+    ASSERT_EQ(m_pGraph->Build(m_WorkerPool.GetWorkerCount()), audio::ResultCode::Success);
+    RunCycle(2 * kBufferSize);
+    for (const Rc<Port>& pPort : pMaster->GetOutputPorts())
+        EXPECT_TRUE(GetBuffer(pPort)->IsSilent());
+}
@@ -0,0 +1,66 @@
+﻿#include <Audio/Buffers/AudioBufferView.hpp>
+#include <Audio/Buffers/MultichannelAudioBuffer.hpp>
+#include <gtest/gtest.h>
+
+using namespace quinte;
+
+TEST(MultichannelAudioBuffer, Layout)
+{
+    const Rc<MultichannelAudioBuffer> pBuffer = Rc<MultichannelAudioBuffer>::DefaultNew(3u, uint64_t{ 100 });
+    EXPECT_EQ(pBuffer->GetChannelCount(), 3);
+    EXPECT_EQ(pBuffer->GetCapacity(), 100);
+    EXPECT_EQ(pBuffer->GetStride() % (MultichannelAudioBuffer::kDataAlignment / sizeof(float)), 0);
+    EXPECT_GE(pBuffer->GetStride(), 100);
+    EXPECT_TRUE(pBuffer->IsSilent());
+
+    const MultichannelAudioBuffer* pConstBuffer = pBuffer.Get();
+    for (uint32_t channelIndex = 0; channelIndex < 3; ++channelIndex)
+    {
+        const float* pChannel = pConstBuffer->GetChannelData(channelIndex);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(pChannel) % MultichannelAudioBuffer::kDataAlignment, 0);
+        EXPECT_EQ(pChannel, pConstBuffer->GetChannelData(0) + channelIndex * pBuffer->GetStride());
+    }
+}
+
+TEST(MultichannelAudioBuffer, SilentMask)
+{
+    const Rc<MultichannelAudioBuffer> pBuffer = Rc<MultichannelAudioBuffer>::DefaultNew(2u, uint64_t{ 64 });
+    EXPECT_EQ(pBuffer->GetSilentMask(), 0b11);
+
+    pBuffer->GetChannelData(1)[10] = 1.0f;
+    EXPECT_FALSE(pBuffer->IsSilent());
+    EXPECT_TRUE(pBuffer->IsChannelSilent(0));
+    EXPECT_FALSE(pBuffer->IsChannelSilent(1));
+
+    pBuffer->ClearChannel(1, 0, 32);
+    EXPECT_FALSE(pBuffer->IsChannelSilent(1));
+
+    pBuffer->Clear();
+    EXPECT_TRUE(pBuffer->IsSilent());
+    EXPECT_EQ(pBuffer->GetChannelData(1)[10], 0.0f);
+}
+
+TEST(MultichannelAudioBuffer, MixAndRead)
+{
+    const Rc<MultichannelAudioBuffer> pSource = Rc<MultichannelAudioBuffer>::DefaultNew(2u, uint64_t{ 16 });
+    const Rc<MultichannelAudioBuffer> pDestination = Rc<MultichannelAudioBuffer>::DefaultNew(2u, uint64_t{ 16 });
+
+    float* pLeft = pSource->GetChannelData(0);
+    for (uint32_t sampleIndex = 0; sampleIndex < 16; ++sampleIndex)
+        pLeft[sampleIndex] = static_cast<float>(sampleIndex);
+
+    const float gains[] = { 0.5f, 2.0f };
+    pDestination->Mix(pSource.Get(), 0, 0, 16);
+    pDestination->MixWithGain(pSource.Get(), gains, 0, 0, 16);
+    EXPECT_FALSE(pDestination->IsChannelSilent(0));
+    EXPECT_TRUE(pDestination->IsChannelSilent(1));
+
+    float data[16];
+    AudioBufferView view{ data, 16 };
+    pDestination->ReadChannel(0, &view, 4, 0, 8);
+    for (uint32_t sampleIndex = 0; sampleIndex < 8; ++sampleIndex)
+        EXPECT_EQ(data[sampleIndex], static_cast<float>(sampleIndex + 4) * 1.5f);
+
+    pDestination->ReadChannel(1, &view, 0, 0, 16);
+    EXPECT_TRUE(view.IsSilent());
+}
@@ -0,0 +1,264 @@
+﻿#include <Audio/Buffers/AudioBufferView.hpp>
+#include <Audio/Buffers/MultichannelAudioBuffer.hpp>
+#include <Audio/Sources/BufferAudioSource.hpp>
+#include <Audio/Tracks/Playlist.hpp>
+#include <Audio/Tracks/PrerenderBuffer.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace quinte;
+
+namespace
+{
+    constexpr uint64_t kSourceLength = 1 << 16;
+    constexpr uint64_t kBlockSize = 16;
+    constexpr uint32_t kBlockCount = 4;
+
+
+    // The sample at timeline position P is (P + 1) * scale in the left channel and the negated value in the right one,
+    // so any sample read from a wrong position of the ring is detected.
+    Playlist CreateRampPlaylist(float scale)
+    {
+        MultichannelAudioBuffer* pBuffer = Rc<MultichannelAudioBuffer>::DefaultNew(2u, kSourceLength);
+        float* pLeft = pBuffer->GetChannelData(0);
+        float* pRight = pBuffer->GetChannelData(1);
+        for (uint64_t sampleIndex = 0; sampleIndex < kSourceLength; ++sampleIndex)
+        {
+            pLeft[sampleIndex] = static_cast<float>(sampleIndex + 1) * scale;
+            pRight[sampleIndex] = -pLeft[sampleIndex];
+        }
+
+        Playlist playlist;
+        playlist.InsertClip(AudioClip{ Rc<BufferAudioSource>::DefaultNew(pBuffer), 0 });
+        return playlist;
+    }
+
+
+    uint32_t RenderAll(PrerenderBuffer& buffer, const Playlist& playlist)
+    {
+        uint32_t blockCount = 0;
+        while (buffer.BeginRender())
+        {
+            buffer.Render(playlist);
+            ++blockCount;
+        }
+
+        return blockCount;
+    }
+
+
+    ::testing::AssertionResult CheckRange(const PrerenderBuffer& buffer, audio::TimeRange64 range, float scale)
+    {
+        std::vector<float> data(range.GetLengthInSamples());
+        AudioBufferView view{ data.data(), data.size() };
+        for (uint32_t channelIndex = 0; channelIndex < 2; ++channelIndex)
+        {
+            if (!buffer.Read(channelIndex, &view, 0, range))
+                return ::testing::AssertionFailure() << "channel " << channelIndex << " is not rendered";
+
+            const float sign = channelIndex == 0 ? 1.0f : -1.0f;
+            for (uint64_t sampleIndex = 0; sampleIndex < data.size(); ++sampleIndex)
+            {
+                const uint64_t position = range.GetFirstSampleIndex() + sampleIndex;
+                const float expected = sign * static_cast<float>(position + 1) * scale;
+                if (data[sampleIndex] != expected)
+                {
+                    return ::testing::AssertionFailure()
+                        << "channel " << channelIndex << ", position " << position << ": " << data[sampleIndex]
+                        << " != " << expected;
+                }
+            }
+        }
+
+        return ::testing::AssertionSuccess();
+    }
+} // namespace
+
+
+TEST(PrerenderBuffer, WrapAround)
+{
+    const Playlist playlist = CreateRampPlaylist(1.0f);
+    PrerenderSignal signal;
+    PrerenderBuffer buffer{ 2, kBlockSize, kBlockCount, &signal };
+
+    EXPECT_EQ(RenderAll(buffer, playlist), kBlockCount);
+
+    // Odd-sized reads make the ranges cross the end of the ring at different offsets.
+    constexpr uint32_t kReadSize = 11;
+    uint64_t readPos = 0;
+    while (readPos < 20 * kBlockSize * kBlockCount)
+    {
+        const audio::TimeRange64 range{ readPos, kReadSize };
+        if (!buffer.Acquire(range))
+        {
+            buffer.Release({ readPos, 0 });
+            ASSERT_GT(RenderAll(buffer, playlist), 0u);
+            continue;
+        }
+
+        ASSERT_TRUE(CheckRange(buffer, range, 1.0f));
+        buffer.Release(range);
+        readPos += kReadSize;
+    }
+}
+
+
+TEST(PrerenderBuffer, ProducerStaysBehindReader)
+{
+    const Playlist playlist = CreateRampPlaylist(1.0f);
+    PrerenderSignal signal;
+    PrerenderBuffer buffer{ 2, kBlockSize, kBlockCount, &signal };
+
+    EXPECT_EQ(RenderAll(buffer, playlist), kBlockCount);
+    EXPECT_FALSE(buffer.BeginRender());
+
+    // Only the space in front of the released range is freed.
+    const audio::TimeRange64 range{ 0, kBlockSize + 1 };
+    ASSERT_TRUE(buffer.Acquire(range));
+    buffer.Release(range);
+    EXPECT_EQ(RenderAll(buffer, playlist), 1u);
+}
+
+
+TEST(PrerenderBuffer, InvalidateWhileReading)
+{
+    const Playlist oldPlaylist = CreateRampPlaylist(1.0f);
+    const Playlist newPlaylist = CreateRampPlaylist(2.0f);
+    PrerenderSignal signal;
+    PrerenderBuffer buffer{ 2, kBlockSize, kBlockCount, &signal };
+
+    RenderAll(buffer, oldPlaylist);
+
+    const audio::TimeRange64 heldRange{ 0, kBlockSize };
+    ASSERT_TRUE(buffer.Acquire(heldRange));
+
+    // The playlist is edited while the consumer holds the block: the producer must not restart
+    // and overwrite it until the consumer has released it.
+    buffer.Invalidate({ 0, kSourceLength });
+    EXPECT_EQ(RenderAll(buffer, newPlaylist), 0u);
+    EXPECT_TRUE(CheckRange(buffer, heldRange, 1.0f));
+    buffer.Release(heldRange);
+
+    // The next Acquire() requests the restart, the producer starts over from the consumer position.
+    const audio::TimeRange64 nextRange{ kBlockSize, kBlockSize };
+    EXPECT_FALSE(buffer.Acquire(nextRange));
+    buffer.Release({ kBlockSize, 0 });
+    EXPECT_EQ(RenderAll(buffer, newPlaylist), kBlockCount);
+
+    ASSERT_TRUE(buffer.Acquire(nextRange));
+    EXPECT_TRUE(CheckRange(buffer, nextRange, 2.0f));
+    buffer.Release(nextRange);
+}
+
+
+TEST(PrerenderBuffer, InvalidateBehindReader)
+{
+    const Playlist playlist = CreateRampPlaylist(1.0f);
+    PrerenderSignal signal;
+    PrerenderBuffer buffer{ 2, kBlockSize, kBlockCount, &signal };
+
+    RenderAll(buffer, playlist);
+    const audio::TimeRange64 range{ 0, 2 * kBlockSize };
+    ASSERT_TRUE(buffer.Acquire(range));
+    buffer.Release(range);
+
+    // An edit before the consumer position doesn't affect the samples it's going to read.
+    buffer.Invalidate({ 0, kBlockSize });
+    const audio::TimeRange64 nextRange{ 2 * kBlockSize, kBlockSize };
+    ASSERT_TRUE(buffer.Acquire(nextRange));
+    EXPECT_TRUE(CheckRange(buffer, nextRange, 1.0f));
+    buffer.Release(nextRange);
+}
+
+
+TEST(PrerenderBuffer, RestartAtNewPosition)
+{
+    const Playlist playlist = CreateRampPlaylist(1.0f);
+    PrerenderSignal signal;
+    PrerenderBuffer buffer{ 2, kBlockSize, kBlockCount, &signal };
+
+    RenderAll(buffer, playlist);
+
+    // A jump forward past the rendered range: the producer restarts from the released position.
+    const audio::TimeRange64 forwardRange{ 1000, kBlockSize };
+    EXPECT_FALSE(buffer.Acquire(forwardRange));
+    buffer.Release(forwardRange);
+    EXPECT_EQ(RenderAll(buffer, playlist), kBlockCount);
+
+    const audio::TimeRange64 forwardNextRange{ forwardRange.GetLastSampleIndex(), kBlockSize };
+    ASSERT_TRUE(buffer.Acquire(forwardNextRange));
+    EXPECT_TRUE(CheckRange(buffer, forwardNextRange, 1.0f));
+    buffer.Release(forwardNextRange);
+
+    // A jump backwards, e.g. a loop wrap: the samples before the consumer position may already be overwritten.
+    const audio::TimeRange64 backwardRange{ 100, kBlockSize };
+    EXPECT_FALSE(buffer.Acquire(backwardRange));
+    buffer.Release(backwardRange);
+    EXPECT_EQ(RenderAll(buffer, playlist), kBlockCount);
+
+    const audio::TimeRange64 backwardNextRange{ backwardRange.GetLastSampleIndex(), 3 * kBlockSize };
+    ASSERT_TRUE(buffer.Acquire(backwardNextRange));
+    EXPECT_TRUE(CheckRange(buffer, backwardNextRange, 1.0f));
+    buffer.Release(backwardNextRange);
+}
+
+
+TEST(PrerenderBuffer, Concurrent)
+{
+    constexpr uint64_t kReadLength = kSourceLength - 2 * kBlockSize;
+    constexpr uint32_t kReadSize = 7;
+
+    const Playlist playlist = CreateRampPlaylist(1.0f);
+    PrerenderSignal signal;
+    PrerenderBuffer buffer{ 2, kBlockSize, kBlockCount, &signal };
+
+    std::atomic<bool> done = false;
+    std::thread producer([&] {
+        while (!done.load(std::memory_order_acquire))
+        {
+            if (buffer.BeginRender())
+            {
+                buffer.Render(playlist);
+                continue;
+            }
+
+            signal.PrepareWait();
+            if (done.load(std::memory_order_acquire))
+            {
+                signal.CancelWait();
+                continue;
+            }
+
+            if (buffer.BeginRender())
+            {
+                signal.CancelWait();
+                buffer.Render(playlist);
+                continue;
+            }
+
+            signal.Wait();
+        }
+    });
+
+    uint64_t readPos = 0;
+    while (readPos + kReadSize < kReadLength)
+    {
+        const audio::TimeRange64 range{ readPos, kReadSize };
+        if (buffer.Acquire(range))
+        {
+            ASSERT_TRUE(CheckRange(buffer, range, 1.0f));
+            buffer.Release(range);
+            readPos += kReadSize;
+        }
+        else
+        {
+            buffer.Release({ readPos, 0 });
+            std::this_thread::yield();
+        }
+    }
+
+    done.store(true, std::memory_order_release);
+    signal.Wake();
+    producer.join();
+}
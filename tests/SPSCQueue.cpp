@@ -0,0 +1,75 @@
+﻿#include <Core/SPSCQueue.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace quinte;
+
+TEST(SPSCQueue, PushPop)
+{
+    SPSCQueue<uint32_t> queue{ 4 };
+    EXPECT_TRUE(queue.Empty());
+    EXPECT_EQ(queue.GetCapacity(), 4);
+
+    for (uint32_t i = 0; i < 4; ++i)
+        EXPECT_TRUE(queue.Push(i));
+    EXPECT_FALSE(queue.Push(4));
+
+    uint32_t value;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(queue.TryPop(value));
+        EXPECT_EQ(value, i);
+    }
+
+    EXPECT_FALSE(queue.TryPop(value));
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(SPSCQueue, WrapAround)
+{
+    SPSCQueue<uint32_t> queue{ 4 };
+
+    uint32_t value;
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        EXPECT_TRUE(queue.Push(i));
+        EXPECT_TRUE(queue.Push(i + 100));
+        EXPECT_TRUE(queue.TryPop(value));
+        EXPECT_EQ(value, i);
+        EXPECT_TRUE(queue.TryPop(value));
+        EXPECT_EQ(value, i + 100);
+    }
+
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(SPSCQueue, Concurrent)
+{
+    constexpr uint32_t kItemCount = 200000;
+
+    SPSCQueue<uint32_t> queue{ 64 };
+    std::thread consumer([&] {
+        uint32_t expected = 0;
+        uint32_t value;
+        while (expected < kItemCount)
+        {
+            if (!queue.TryPop(value))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            ASSERT_EQ(value, expected);
+            ++expected;
+        }
+    });
+
+    for (uint32_t i = 0; i < kItemCount; ++i)
+    {
+        while (!queue.Push(i))
+            std::this_thread::yield();
+    }
+
+    consumer.join();
+    EXPECT_TRUE(queue.Empty());
+}
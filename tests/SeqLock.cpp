@@ -0,0 +1,59 @@
+﻿#include <Core/SeqLock.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace quinte;
+
+namespace
+{
+    struct TestData final
+    {
+        uint64_t Values[8];
+    };
+} // namespace
+
+TEST(SeqLock, StoreLoad)
+{
+    SeqLock<TestData> lock;
+    EXPECT_EQ(lock.Load().Values[0], 0);
+
+    TestData data{};
+    data.Values[3] = 123;
+    lock.Store(data);
+    EXPECT_EQ(lock.Load().Values[3], 123);
+
+    TestData result{};
+    EXPECT_TRUE(lock.TryLoad(result));
+    EXPECT_EQ(result.Values[3], 123);
+}
+
+TEST(SeqLock, ConcurrentReadersSeeConsistentValues)
+{
+    constexpr uint64_t kIterationCount = 100000;
+
+    SeqLock<TestData> lock;
+    std::atomic<bool> done = false;
+
+    std::thread reader([&] {
+        while (!done.load())
+        {
+            const TestData data = lock.Load();
+            for (const uint64_t value : data.Values)
+                ASSERT_EQ(value, data.Values[0]);
+        }
+    });
+
+    for (uint64_t iteration = 1; iteration <= kIterationCount; ++iteration)
+    {
+        TestData data;
+        for (uint64_t& value : data.Values)
+            value = iteration;
+
+        lock.Store(data);
+    }
+
+    done.store(true);
+    reader.join();
+
+    EXPECT_EQ(lock.Load().Values[7], kIterationCount);
+}
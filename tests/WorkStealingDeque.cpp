@@ -0,0 +1,82 @@
+﻿#include <Core/WorkStealingDeque.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace quinte;
+
+TEST(WorkStealingDeque, PushPop)
+{
+    WorkStealingDeque<uint32_t> deque{ 4 };
+    EXPECT_TRUE(deque.Empty());
+    EXPECT_EQ(deque.GetCapacity(), 4);
+
+    for (uint32_t i = 0; i < 4; ++i)
+        EXPECT_TRUE(deque.Push(i));
+    EXPECT_FALSE(deque.Push(4));
+
+    uint32_t value;
+    EXPECT_TRUE(deque.TryPop(value));
+    EXPECT_EQ(value, 3);
+    EXPECT_TRUE(deque.TrySteal(value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(deque.TryPop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_TRUE(deque.TryPop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_FALSE(deque.TryPop(value));
+    EXPECT_FALSE(deque.TrySteal(value));
+    EXPECT_TRUE(deque.Empty());
+}
+
+TEST(WorkStealingDeque, ConcurrentSteal)
+{
+    constexpr uint32_t kItemCount = 100000;
+    constexpr uint32_t kThiefCount = 3;
+
+    WorkStealingDeque<uint32_t> deque{ 1024 };
+    std::vector<std::atomic<uint32_t>> visited(kItemCount);
+    std::atomic<uint32_t> processedCount = 0;
+
+    std::vector<std::thread> thieves;
+    for (uint32_t i = 0; i < kThiefCount; ++i)
+    {
+        thieves.emplace_back([&] {
+            uint32_t value;
+            while (processedCount.load() < kItemCount)
+            {
+                if (deque.TrySteal(value))
+                {
+                    visited[value].fetch_add(1);
+                    processedCount.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    uint32_t value;
+    for (uint32_t i = 0; i < kItemCount; ++i)
+    {
+        while (!deque.Push(i))
+        {
+            if (deque.TryPop(value))
+            {
+                visited[value].fetch_add(1);
+                processedCount.fetch_add(1);
+            }
+        }
+    }
+
+    while (deque.TryPop(value))
+    {
+        visited[value].fetch_add(1);
+        processedCount.fetch_add(1);
+    }
+
+    for (std::thread& thief : thieves)
+        thief.join();
+
+    EXPECT_EQ(processedCount.load(), kItemCount);
+    for (uint32_t i = 0; i < kItemCount; ++i)
+        EXPECT_EQ(visited[i].load(), 1);
+}